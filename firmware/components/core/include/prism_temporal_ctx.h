@@ -9,6 +9,9 @@
 extern "C" {
 #endif
 
+// LEDs covered by the temporal model (one LGP edge)
+#define PRISM_TEMPORAL_MAX_LEDS 160
+
 // Sync parameters structure (12 bytes)
 typedef struct {
     uint16_t delay_ms;              // Base delay for OFFSET mode
@@ -19,16 +22,35 @@ typedef struct {
     uint16_t wave_phase_deg;        // WAVE mode phase offset (0-360)
 } prism_sync_params_t;
 
+// Per-LED delay map compiled from a context's mode, motion and params.
+// The inputs it was built from are kept so a stale map can be detected.
+typedef struct {
+    uint16_t delay_ms[PRISM_TEMPORAL_MAX_LEDS];  // CH2 delay per output LED, motion applied
+    uint16_t min_ms;                        // Smallest delay in the map
+    uint16_t max_ms;                        // Largest delay in the map
+                                            // (animated WAVE: over the whole cycle)
+    uint8_t wave_phase[PRISM_TEMPORAL_MAX_LEDS];  // WAVE: spatial phase per LED, motion applied
+    uint32_t wave_acc;                      // WAVE: temporal phase, 8.16 fixed point (256 = cycle)
+    uint32_t wave_step;                     // WAVE: wave_acc advance per frame (0 = static)
+    uint32_t wave_frame;                    // WAVE: frame_index wave_acc corresponds to
+    uint16_t led_count;                     // LEDs compiled (0 = not compiled)
+    prism_sync_mode_t sync_mode;            // Inputs of the compile
+    prism_motion_t motion_direction;
+    prism_sync_params_t params;
+    const uint16_t *delay_table;
+} prism_delay_map_t;
+
 // Temporal context for frame calculation
 // NOTE: delay_table pointer is owned by pattern cache (Task 7)
 // Do NOT free this pointer - it points into cached pattern data
 typedef struct {
     uint32_t frame_index;                   // Current frame number
-    const uint16_t *delay_table;            // Pointer to 160-entry delay map (PROGRESSIVE/CUSTOM)
+    const uint16_t *delay_table;            // Pointer to 160-entry delay map (CUSTOM)
     uint32_t frame_time_ms;                 // Milliseconds since pattern start
     prism_sync_mode_t sync_mode;            // Active sync mode
     prism_motion_t motion_direction;        // Active motion direction
     prism_sync_params_t params;             // Mode-specific parameters
+    prism_delay_map_t map;                  // Compiled by prism_temporal_compile()
 } prism_temporal_ctx_t;
 
 #ifdef __cplusplus
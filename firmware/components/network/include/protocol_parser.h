@@ -14,6 +14,8 @@
  * - 0x10: PUT_BEGIN {filename, size, crc}
  * - 0x11: PUT_DATA {offset, data}
  * - 0x12: PUT_END {success}
+ * - 0x13: PUT_ACK {token, next_offset, window} (extension, device -> client)
+ * - 0x14: PUT_RESUME {token} (extension)
  * - 0x20: CONTROL {command, params}
  * - 0x30: STATUS {heap, patterns, uptime}
  * - 0xFF: ERROR {error_code, message} (extension)
@@ -45,9 +47,20 @@ extern "C" {
 
 /** Upload message types (PRD lines 152-154) */
 #define MSG_TYPE_PUT_BEGIN      0x10  /**< Initiate pattern upload: {filename, size, crc} */
-#define MSG_TYPE_PUT_DATA       0x11  /**< Stream pattern data: {offset, data} */
+#define MSG_TYPE_PUT_DATA       0x11  /**< Stream pattern data: {offset, data}, within the window */
 #define MSG_TYPE_PUT_END        0x12  /**< Finalize upload: {success} */
 
+/**
+ * Windowed upload extension (not in PRD). The device answers PUT_BEGIN and
+ * PUT_RESUME, and acknowledges PUT_DATA cumulatively, with
+ * PUT_ACK [token:4][next_offset:4][window:4]: every byte below next_offset is
+ * stored, and the client may send anything below next_offset + window
+ * without waiting. After a disconnect, PUT_RESUME [token:4] re-attaches the
+ * session to the new connection and the client continues from next_offset.
+ */
+#define MSG_TYPE_PUT_ACK        0x13  /**< Cumulative upload ack: {token, next_offset, window} */
+#define MSG_TYPE_PUT_RESUME     0x14  /**< Re-attach an upload session: {token} */
+
 /** Control message types (PRD line 155) */
 #define MSG_TYPE_CONTROL        0x20  /**< Playback control: {command, params} */
 
@@ -56,7 +69,7 @@ extern "C" {
 
 /** Extension message types (not in PRD) */
 #define MSG_TYPE_DELETE         0x21  /**< Delete pattern: {filename} */
-#define MSG_TYPE_LIST           0x22  /**< List patterns: {} */
+#define MSG_TYPE_LIST           0x22  /**< List patterns: {} or {start}; paged */
 #define MSG_TYPE_ERROR          0xFF  /**< Error response: {error_code, message} */
 
 /* ============================================================================
@@ -84,7 +97,14 @@ extern "C" {
 #define PATTERN_MAX_FILENAME    64            /**< Maximum filename length */
 
 /** Session timeouts */
-#define UPLOAD_TIMEOUT_MS       5000  /**< Upload session idle timeout */
+#define UPLOAD_TIMEOUT_MS       5000  /**< Idle time before a session is detached from its client */
+#define UPLOAD_RESUME_TIMEOUT_MS 30000 /**< Idle time before a detached session is dropped */
+
+/** Upload flow control */
+#define UPLOAD_WINDOW_BYTES     32768 /**< Bytes the client may send past next_offset (8 frames) */
+#define UPLOAD_ACK_INTERVAL     (UPLOAD_WINDOW_BYTES / 2)  /**< Ack at least this often */
+#define UPLOAD_BLOCK_SIZE       1024  /**< Granularity of out-of-order tracking */
+#define UPLOAD_BITMAP_BYTES     (PATTERN_MAX_SIZE / UPLOAD_BLOCK_SIZE / 8)
 
 /* ============================================================================
  * Data Structures
@@ -125,13 +145,33 @@ typedef struct {
     char filename[PATTERN_MAX_FILENAME];/**< Pattern filename from PUT_BEGIN */
     uint32_t expected_size;             /**< Total size from PUT_BEGIN */
     uint32_t expected_crc;              /**< Expected CRC from PUT_BEGIN */
-    uint32_t bytes_received;            /**< Bytes accumulated from PUT_DATA */
-    uint32_t crc_accumulator;           /**< Running CRC32 of pattern data */
-    uint8_t* upload_buffer;             /**< Heap-allocated pattern buffer */
+    uint32_t bytes_received;            /**< Contiguous bytes stored (next_offset) */
+    uint32_t crc_accumulator;           /**< Running CRC32 of bytes_received bytes */
     uint32_t last_activity_ms;          /**< Timestamp for timeout detection */
-    int client_fd;                      /**< WebSocket client owning session */
+    int client_fd;                      /**< WebSocket client owning session (-1: detached) */
+    uint32_t token;                     /**< Resume token handed out in PUT_ACK */
+    uint32_t last_ack_offset;           /**< next_offset in the last PUT_ACK sent */
+    uint8_t received_blocks[UPLOAD_BITMAP_BYTES]; /**< Blocks stored ahead of bytes_received */
+    uint32_t start_ms;                  /**< PUT_BEGIN timestamp (throughput) */
+    uint32_t heap_free_start;           /**< Free heap at PUT_BEGIN */
+    uint32_t heap_free_min;             /**< Lowest free heap seen during the upload */
 } upload_session_t;
 
+/**
+ * @brief Outcome of the most recent upload
+ *
+ * Heap use is sampled at PUT_BEGIN and after every chunk, so it is the peak
+ * seen by the upload path rather than a system-wide watermark.
+ */
+typedef struct {
+    char filename[PATTERN_MAX_FILENAME];/**< Pattern ID */
+    esp_err_t result;                   /**< ESP_OK if the pattern was stored */
+    uint32_t bytes;                     /**< Bytes received */
+    uint32_t duration_ms;               /**< PUT_BEGIN to completion */
+    uint32_t throughput_bps;            /**< Bytes per second (0 if under 1 ms) */
+    uint32_t heap_peak_bytes;           /**< Free heap at start minus lowest free heap */
+} upload_stats_t;
+
 /* ============================================================================
  * Public API Functions
  * ============================================================================ */
@@ -189,12 +229,31 @@ esp_err_t protocol_dispatch_command(
  * @brief Check for upload session timeout
  *
  * Should be called from network_task() every 1 second.
- * Aborts upload if no PUT_DATA received for UPLOAD_TIMEOUT_MS (5s).
+ * Detaches the session from its client after UPLOAD_TIMEOUT_MS (5s) without
+ * PUT_DATA, and aborts it after UPLOAD_RESUME_TIMEOUT_MS (30s).
  *
  * Thread-safe: Uses internal mutex.
  */
 void protocol_check_upload_timeout(void);
 
+/**
+ * @brief protocol_check_upload_timeout() against a caller-supplied clock
+ *
+ * @param now_ms Milliseconds on the xTaskGetTickCount() timebase; tests pass
+ *               a time past the timeouts instead of waiting them out
+ */
+void protocol_check_upload_timeout_at(uint32_t now_ms);
+
+/**
+ * @brief Detach any upload owned by a closed connection
+ *
+ * The session and its temp file are kept for UPLOAD_RESUME_TIMEOUT_MS so the
+ * client can PUT_RESUME from a new connection.
+ *
+ * @param client_fd Socket of the connection that closed
+ */
+void protocol_client_disconnected(int client_fd);
+
 /**
  * @brief Get current upload session status
  *
@@ -211,6 +270,26 @@ bool protocol_get_upload_status(
     uint32_t* out_total_size
 );
 
+/**
+ * @brief Get the resume token of the upload in progress
+ *
+ * The same value the client received in PUT_ACK; for diagnostics and tests.
+ *
+ * @param out_token Receives the token
+ * @return true if an upload is receiving data
+ */
+bool protocol_get_upload_token(uint32_t* out_token);
+
+/**
+ * @brief Get throughput and heap use of the last finished upload
+ *
+ * Covers uploads that were stored, rejected at PUT_END, or aborted.
+ *
+ * @param out_stats Receives the stats
+ * @return true if an upload has finished since init
+ */
+bool protocol_get_last_upload_stats(upload_stats_t* out_stats);
+
 #ifdef __cplusplus
 }
 #endif
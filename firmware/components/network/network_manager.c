@@ -1226,6 +1226,9 @@ void cleanup_ws_client(int client_idx) {
         return;  // Already cleaned up
     }
 
+    // An upload in progress stays resumable from another connection
+    protocol_client_disconnected(g_net_state.ws_clients[client_idx].socket_fd);
+
     // Free RX buffer
     if (g_net_state.ws_clients[client_idx].rx_buffer != NULL) {
         prism_pool_free(g_net_state.ws_clients[client_idx].rx_buffer);
@@ -1686,6 +1689,9 @@ void network_task(void *pvParameters) {
             xSemaphoreGive(g_net_state.ws_mutex);
         }
 
+        // Upload idle timeouts: detach stalled uploads, expire detached ones
+        protocol_check_upload_timeout();
+
         // TODO: Task 4 - TLV protocol handling and status broadcasts
 
         vTaskDelay(pdMS_TO_TICKS(1000));  // Check timeouts every 1 second
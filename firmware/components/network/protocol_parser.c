@@ -23,11 +23,11 @@
 #include "template_patterns.h" // template_catalog_get
 #include "esp_log.h"
 #include "esp_rom_crc.h"
+#include "esp_heap_caps.h"
+#include "esp_random.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "network_manager.h"
-#include <dirent.h>
-#include <sys/stat.h>
 #include "esp_app_desc.h"
 #include <string.h>
 #include <stdlib.h>
@@ -55,6 +55,16 @@ static bool validate_sync_tlv(uint8_t sync_value)
 /** Global upload session (single session, mutual exclusion) */
 static upload_session_t g_upload_session = {0};
 
+/** Temp-file writer for the active upload (protected by g_upload_mutex) */
+static storage_pattern_writer_t g_upload_writer;
+
+/** stdio buffer for the upload file: chunks reach LittleFS in 4KB blocks */
+static uint8_t g_upload_stage[STORAGE_WRITE_STAGE_SIZE];
+
+/** Stats of the last finished upload (protected by g_upload_mutex) */
+static upload_stats_t g_last_upload_stats;
+static bool g_have_upload_stats = false;
+
 /** Upload session mutex (protects g_upload_session) */
 static SemaphoreHandle_t g_upload_mutex = NULL;
 
@@ -82,6 +92,8 @@ esp_err_t protocol_parser_init(void)
     // Initialize upload session to IDLE
     memset(&g_upload_session, 0, sizeof(upload_session_t));
     g_upload_session.state = UPLOAD_STATE_IDLE;
+    memset(&g_upload_writer, 0, sizeof(g_upload_writer));
+    g_have_upload_stats = false;
 
     g_initialized = true;
     ESP_LOGI(TAG, "Protocol parser initialized");
@@ -101,9 +113,7 @@ void protocol_parser_deinit(void)
 
         if (g_upload_session.state != UPLOAD_STATE_IDLE) {
             ESP_LOGW(TAG, "Cleaning up active upload session during deinit");
-            if (g_upload_session.upload_buffer != NULL) {
-                free(g_upload_session.upload_buffer);
-            }
+            storage_pattern_write_abort(&g_upload_writer);
             memset(&g_upload_session, 0, sizeof(upload_session_t));
         }
 
@@ -284,22 +294,138 @@ static esp_err_t send_error_response(int client_fd, uint8_t error_code, const ch
  * Phase 2: Upload Session Management (Subtask 4.2)
  * ============================================================================ */
 
+/**
+ * @brief Track the lowest free heap seen during the upload
+ */
+static void sample_upload_heap(void)
+{
+    uint32_t free_now = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    if (free_now < g_upload_session.heap_free_min) {
+        g_upload_session.heap_free_min = free_now;
+    }
+}
+
+/**
+ * @brief Record throughput and heap use of the session that is ending
+ *
+ * Logged as one JSON line so upload runs can be collected from UART.
+ */
+static void record_upload_stats(esp_err_t result)
+{
+    sample_upload_heap();
+
+    upload_stats_t* st = &g_last_upload_stats;
+    memset(st, 0, sizeof(*st));
+    strlcpy(st->filename, g_upload_session.filename, sizeof(st->filename));
+    st->result = result;
+    st->bytes = g_upload_session.bytes_received;
+    st->duration_ms = get_time_ms() - g_upload_session.start_ms;
+    st->throughput_bps = st->duration_ms ? (uint32_t)((uint64_t)st->bytes * 1000u / st->duration_ms) : 0;
+    st->heap_peak_bytes = g_upload_session.heap_free_start - g_upload_session.heap_free_min;
+    g_have_upload_stats = true;
+
+    ESP_LOGI(TAG,
+             "{\"upload\":\"%s\",\"result\":\"%s\",\"bytes\":%lu,\"ms\":%lu,"
+             "\"bytes_per_s\":%lu,\"heap_peak_bytes\":%lu}",
+             st->filename, esp_err_to_name(result), (unsigned long)st->bytes,
+             (unsigned long)st->duration_ms, (unsigned long)st->throughput_bps,
+             (unsigned long)st->heap_peak_bytes);
+}
+
 /**
  * @brief Abort active upload session and cleanup resources
  */
-static void abort_upload_session(const char* reason)
+static void abort_upload_session(const char* reason, esp_err_t result)
 {
     ESP_LOGW(TAG, "Aborting upload session: %s", reason);
 
-    if (g_upload_session.upload_buffer != NULL) {
-        free(g_upload_session.upload_buffer);
-        g_upload_session.upload_buffer = NULL;
-    }
+    storage_pattern_write_abort(&g_upload_writer);
+    record_upload_stats(result);
 
     memset(&g_upload_session, 0, sizeof(upload_session_t));
     g_upload_session.state = UPLOAD_STATE_IDLE;
 }
 
+/**
+ * @brief Build a PUT_ACK payload from the session (caller holds the mutex)
+ *
+ * Format: [token:4][next_offset:4][window:4], big-endian
+ */
+static size_t build_put_ack(uint8_t* out)
+{
+    const uint32_t fields[3] = {
+        g_upload_session.token,
+        g_upload_session.bytes_received,
+        UPLOAD_WINDOW_BYTES,
+    };
+    for (int i = 0; i < 3; ++i) {
+        out[i * 4 + 0] = (fields[i] >> 24) & 0xFF;
+        out[i * 4 + 1] = (fields[i] >> 16) & 0xFF;
+        out[i * 4 + 2] = (fields[i] >> 8) & 0xFF;
+        out[i * 4 + 3] = (fields[i]) & 0xFF;
+    }
+    g_upload_session.last_ack_offset = g_upload_session.bytes_received;
+    return 12;
+}
+
+static bool block_received(uint32_t block)
+{
+    return (g_upload_session.received_blocks[block >> 3] >> (block & 7)) & 1;
+}
+
+/**
+ * @brief Record blocks wholly covered by an out-of-order chunk
+ *
+ * Partial blocks at either edge are not recorded; the client resends them
+ * from next_offset like any other unacked data.
+ */
+static void mark_blocks(uint32_t offset, uint32_t len)
+{
+    uint32_t end = offset + len;
+    uint32_t first = (offset + UPLOAD_BLOCK_SIZE - 1) / UPLOAD_BLOCK_SIZE;
+    uint32_t last = (end == g_upload_session.expected_size)
+        ? (end + UPLOAD_BLOCK_SIZE - 1) / UPLOAD_BLOCK_SIZE    // Short final block counts
+        : end / UPLOAD_BLOCK_SIZE;
+    for (uint32_t b = first; b < last; ++b) {
+        g_upload_session.received_blocks[b >> 3] |= (uint8_t)(1u << (b & 7));
+    }
+}
+
+/**
+ * @brief Move bytes_received across blocks that arrived early
+ *
+ * Their bytes are read back from the temp file to extend the CRC, which
+ * must be computed in order.
+ */
+static esp_err_t advance_over_received_blocks(void)
+{
+    uint8_t buf[256];
+    while (g_upload_session.bytes_received < g_upload_session.expected_size) {
+        uint32_t pos = g_upload_session.bytes_received;
+        uint32_t block = pos / UPLOAD_BLOCK_SIZE;
+        if (!block_received(block)) {
+            break;
+        }
+        uint32_t end = (block + 1) * UPLOAD_BLOCK_SIZE;
+        if (end > g_upload_session.expected_size) {
+            end = g_upload_session.expected_size;
+        }
+        while (pos < end) {
+            size_t n = end - pos;
+            if (n > sizeof(buf)) n = sizeof(buf);
+            esp_err_t ret = storage_pattern_write_read_back(&g_upload_writer, pos, buf, n);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+            g_upload_session.crc_accumulator = esp_rom_crc32_le(
+                g_upload_session.crc_accumulator, buf, n);
+            pos += n;
+        }
+        g_upload_session.bytes_received = end;
+    }
+    return ESP_OK;
+}
+
 /**
  * @brief Parse PUT_BEGIN payload: {filename, size, crc}
  *
@@ -401,6 +527,11 @@ static esp_err_t handle_put_begin(const tlv_frame_t* frame, int client_fd)
     // Acquire mutex for session state
     xSemaphoreTake(g_upload_mutex, portMAX_DELAY);
 
+    // A session nobody is attached to gives way; an attached one does not
+    if (g_upload_session.state == UPLOAD_STATE_RECEIVING && g_upload_session.client_fd < 0) {
+        abort_upload_session("Replaced by new upload", ESP_ERR_INVALID_STATE);
+    }
+
     // Check for existing active session
     if (g_upload_session.state != UPLOAD_STATE_IDLE) {
         xSemaphoreGive(g_upload_mutex);
@@ -409,13 +540,16 @@ static esp_err_t handle_put_begin(const tlv_frame_t* frame, int client_fd)
         return ESP_ERR_INVALID_STATE;
     }
 
-    // Allocate upload buffer (will be freed in PUT_END or on error/timeout)
-    uint8_t* buffer = (uint8_t*)malloc(expected_size);
-    if (buffer == NULL) {
+    uint32_t heap_free = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+    // Chunks stream to a temp file; nothing the size of the pattern is allocated
+    ret = storage_pattern_write_begin(&g_upload_writer, filename, expected_size,
+                                      g_upload_stage, sizeof(g_upload_stage));
+    if (ret != ESP_OK) {
         xSemaphoreGive(g_upload_mutex);
-        ESP_LOGE(TAG, "PUT_BEGIN: Failed to allocate %lu bytes",
-                 (unsigned long)expected_size);
-        return ESP_ERR_NO_MEM;
+        ESP_LOGE(TAG, "PUT_BEGIN: Cannot store '%s' (%lu bytes): %s",
+                 filename, (unsigned long)expected_size, esp_err_to_name(ret));
+        return ret;
     }
 
     // Initialize upload session
@@ -425,16 +559,29 @@ static esp_err_t handle_put_begin(const tlv_frame_t* frame, int client_fd)
     g_upload_session.expected_size = expected_size;
     g_upload_session.expected_crc = expected_crc;
     g_upload_session.bytes_received = 0;
-    g_upload_session.crc_accumulator = 0; // Will start accumulation on first PUT_DATA
-    g_upload_session.upload_buffer = buffer;
+    g_upload_session.crc_accumulator = 0;
     g_upload_session.last_activity_ms = get_time_ms();
     g_upload_session.client_fd = client_fd;
+    g_upload_session.start_ms = g_upload_session.last_activity_ms;
+    g_upload_session.heap_free_start = heap_free;
+    g_upload_session.heap_free_min = heap_free;
+    memset(g_upload_session.received_blocks, 0, sizeof(g_upload_session.received_blocks));
+    do {
+        g_upload_session.token = esp_random();
+    } while (g_upload_session.token == 0);
+    sample_upload_heap();
+
+    uint8_t ack[12];
+    size_t ack_len = build_put_ack(ack);
 
     xSemaphoreGive(g_upload_mutex);
 
     ESP_LOGI(TAG, "PUT_BEGIN: filename='%s' size=%lu crc=0x%08lX",
              filename, (unsigned long)expected_size, (unsigned long)expected_crc);
 
+    // Hands the client its resume token and window. Best-effort: the session
+    // is set up either way, and a lost ack is repaired by the next one.
+    (void)send_tlv_response(client_fd, MSG_TYPE_PUT_ACK, ack, ack_len);
     return ESP_OK;
 }
 
@@ -442,6 +589,14 @@ static esp_err_t handle_put_begin(const tlv_frame_t* frame, int client_fd)
  * @brief Handle PUT_DATA: Stream pattern data chunk
  *
  * PRD: 0x11 - PUT_DATA {offset, data}
+ *
+ * Up to UPLOAD_WINDOW_BYTES may be in flight past bytes_received. In-order
+ * chunks are appended to the temp file and CRC'd as they arrive; a chunk
+ * ahead of a gap is written at its offset and its whole blocks recorded, to
+ * be CRC'd once the gap fills. Bytes already stored (a retransmit) are
+ * trimmed, and a chunk past the window is dropped. Every UPLOAD_ACK_INTERVAL
+ * bytes, on completion, and whenever a chunk was not the next one expected,
+ * a cumulative PUT_ACK tells the client where to continue.
  */
 static esp_err_t handle_put_data(const tlv_frame_t* frame, int client_fd)
 {
@@ -487,35 +642,51 @@ static esp_err_t handle_put_data(const tlv_frame_t* frame, int client_fd)
     if (offset + data_len > g_upload_session.expected_size) {
         ESP_LOGE(TAG, "PUT_DATA: Data exceeds expected size (offset=%lu + len=%zu > total=%lu)",
                  (unsigned long)offset, data_len, (unsigned long)g_upload_session.expected_size);
-        abort_upload_session("Size overflow");
+        abort_upload_session("Size overflow", ESP_ERR_INVALID_SIZE);
         xSemaphoreGive(g_upload_mutex);
         return ESP_ERR_INVALID_SIZE;
     }
 
-    // Copy data to upload buffer
-    memcpy(&g_upload_session.upload_buffer[offset], data, data_len);
-
-    // Update bytes received counter
-    if (offset + data_len > g_upload_session.bytes_received) {
-        g_upload_session.bytes_received = offset + data_len;
-    }
-
-    // Accumulate CRC32 over received data
-    // Note: This assumes sequential uploads. For out-of-order uploads, CRC accumulation
-    // would need to be done in PUT_END over the complete buffer.
-    if (g_upload_session.crc_accumulator == 0 && offset == 0) {
-        // First chunk - initialize CRC
-        g_upload_session.crc_accumulator = esp_rom_crc32_le(0, data, data_len);
+    uint32_t next = g_upload_session.bytes_received;
+    bool in_order = (offset <= next);
+    esp_err_t ret = ESP_OK;
+
+    if (offset >= next + UPLOAD_WINDOW_BYTES) {
+        ESP_LOGW(TAG, "PUT_DATA: offset %lu past window (next=%lu), dropped",
+                 (unsigned long)offset, (unsigned long)next);
+    } else if (in_order) {
+        // Trim what is already stored, append the rest
+        size_t skip = next - offset;
+        if (skip > data_len) {
+            skip = data_len;
+        }
+        data += skip;
+        data_len -= skip;
+        if (data_len > 0) {
+            ret = storage_pattern_write_at(&g_upload_writer, next, data, data_len);
+            if (ret == ESP_OK) {
+                g_upload_session.crc_accumulator = esp_rom_crc32_le(
+                    g_upload_session.crc_accumulator, data, data_len);
+                g_upload_session.bytes_received = next + data_len;
+                ret = advance_over_received_blocks();
+            }
+        }
     } else {
-        // Subsequent chunks - accumulate (only works for sequential uploads)
-        // For robustness, we'll recalculate CRC over entire buffer in PUT_END
-        g_upload_session.crc_accumulator = esp_rom_crc32_le(
-            g_upload_session.crc_accumulator,
-            data,
-            data_len
-        );
+        // Ahead of a gap: store now, CRC when the gap fills
+        ret = storage_pattern_write_at(&g_upload_writer, offset, data, data_len);
+        if (ret == ESP_OK) {
+            mark_blocks(offset, data_len);
+        }
     }
 
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "PUT_DATA: Write failed at %lu (%s)",
+                 (unsigned long)offset, esp_err_to_name(ret));
+        abort_upload_session("Storage write failed", ret);
+        xSemaphoreGive(g_upload_mutex);
+        return ret;
+    }
+    sample_upload_heap();
     // Update activity timestamp
     g_upload_session.last_activity_ms = get_time_ms();
 
@@ -525,7 +696,62 @@ static esp_err_t handle_put_data(const tlv_frame_t* frame, int client_fd)
              (unsigned long)g_upload_session.bytes_received,
              (unsigned long)g_upload_session.expected_size);
 
+    uint8_t ack[12];
+    size_t ack_len = 0;
+    uint32_t now_next = g_upload_session.bytes_received;
+    if (offset != next ||
+        now_next - g_upload_session.last_ack_offset >= UPLOAD_ACK_INTERVAL ||
+        now_next == g_upload_session.expected_size) {
+        ack_len = build_put_ack(ack);
+    }
+
+    xSemaphoreGive(g_upload_mutex);
+
+    if (ack_len > 0) {
+        (void)send_tlv_response(client_fd, MSG_TYPE_PUT_ACK, ack, ack_len);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Handle PUT_RESUME: re-attach an upload after a reconnect
+ *
+ * Payload: [token:4]. Answers with PUT_ACK so the client knows where to
+ * continue; an unknown or expired token gets ERR_NOT_FOUND and the client
+ * starts over with PUT_BEGIN.
+ */
+static esp_err_t handle_put_resume(const tlv_frame_t* frame, int client_fd)
+{
+    if (frame->payload == NULL || frame->length != 4) {
+        ESP_LOGE(TAG, "PUT_RESUME: Payload must be a 4-byte token (got %u)", frame->length);
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t token = ((uint32_t)frame->payload[0] << 24) |
+                     ((uint32_t)frame->payload[1] << 16) |
+                     ((uint32_t)frame->payload[2] << 8) |
+                     ((uint32_t)frame->payload[3]);
+
+    xSemaphoreTake(g_upload_mutex, portMAX_DELAY);
+
+    if (g_upload_session.state != UPLOAD_STATE_RECEIVING || token == 0 ||
+        token != g_upload_session.token) {
+        xSemaphoreGive(g_upload_mutex);
+        ESP_LOGW(TAG, "PUT_RESUME: No session for token 0x%08lX", (unsigned long)token);
+        return send_error_response(client_fd, ERR_NOT_FOUND, "No upload to resume");
+    }
+
+    g_upload_session.client_fd = client_fd;
+    g_upload_session.last_activity_ms = get_time_ms();
+    uint8_t ack[12];
+    size_t ack_len = build_put_ack(ack);
+
+    ESP_LOGI(TAG, "PUT_RESUME: '%s' continues at %lu/%lu bytes (client_fd=%d)",
+             g_upload_session.filename, (unsigned long)g_upload_session.bytes_received,
+             (unsigned long)g_upload_session.expected_size, client_fd);
+
     xSemaphoreGive(g_upload_mutex);
+
+    (void)send_tlv_response(client_fd, MSG_TYPE_PUT_ACK, ack, ack_len);
     return ESP_OK;
 }
 
@@ -559,7 +785,7 @@ static esp_err_t handle_put_end(const tlv_frame_t* frame, int client_fd)
         ESP_LOGE(TAG, "PUT_END: Incomplete upload (received=%lu expected=%lu)",
                  (unsigned long)g_upload_session.bytes_received,
                  (unsigned long)g_upload_session.expected_size);
-        abort_upload_session("Incomplete upload");
+        abort_upload_session("Incomplete upload", ESP_ERR_INVALID_SIZE);
         xSemaphoreGive(g_upload_mutex);
         return ESP_ERR_INVALID_SIZE;
     }
@@ -567,12 +793,8 @@ static esp_err_t handle_put_end(const tlv_frame_t* frame, int client_fd)
     // Transition to VALIDATING state
     g_upload_session.state = UPLOAD_STATE_VALIDATING;
 
-    // Recalculate CRC32 over entire buffer (handles out-of-order uploads)
-    uint32_t calculated_crc = esp_rom_crc32_le(
-        0,
-        g_upload_session.upload_buffer,
-        g_upload_session.expected_size
-    );
+    // CRC32 was accumulated chunk by chunk as the bytes were written
+    uint32_t calculated_crc = g_upload_session.crc_accumulator;
 
     ESP_LOGI(TAG, "PUT_END: CRC32 validation - expected=0x%08lX calculated=0x%08lX",
              (unsigned long)g_upload_session.expected_crc,
@@ -581,7 +803,7 @@ static esp_err_t handle_put_end(const tlv_frame_t* frame, int client_fd)
     // Validate CRC32
     if (calculated_crc != g_upload_session.expected_crc) {
         ESP_LOGE(TAG, "PUT_END: CRC32 mismatch!");
-        abort_upload_session("CRC mismatch");
+        abort_upload_session("CRC mismatch", ESP_ERR_INVALID_CRC);
         xSemaphoreGive(g_upload_mutex);
         return ESP_ERR_INVALID_CRC;
     }
@@ -592,23 +814,11 @@ static esp_err_t handle_put_end(const tlv_frame_t* frame, int client_fd)
     char stored_id[PATTERN_MAX_FILENAME];
     strlcpy(stored_id, g_upload_session.filename, sizeof(stored_id));
 
-    // Remove any existing pattern with the same id (best-effort)
-    esp_err_t ret = storage_pattern_delete(stored_id);
-    if (ret != ESP_OK && ret != ESP_ERR_NOT_FOUND) {
-        ESP_LOGW(TAG, "PUT_END: could not remove existing pattern '%s' (%s)",
-                 stored_id, esp_err_to_name(ret));
-    }
-
-    // Write pattern to persistent storage
-    ret = storage_pattern_create(
-        stored_id,
-        g_upload_session.upload_buffer,
-        g_upload_session.expected_size
-    );
-
+    // Rename over any existing pattern with the same id
+    esp_err_t ret = storage_pattern_write_commit(&g_upload_writer);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "PUT_END: storage_pattern_create failed (%s)", esp_err_to_name(ret));
-        abort_upload_session("Storage write failed");
+        ESP_LOGE(TAG, "PUT_END: storage commit failed (%s)", esp_err_to_name(ret));
+        abort_upload_session("Storage write failed", ret);
         xSemaphoreGive(g_upload_mutex);
         return ret;
     }
@@ -617,8 +827,9 @@ static esp_err_t handle_put_end(const tlv_frame_t* frame, int client_fd)
              stored_id,
              (unsigned long)g_upload_session.expected_size);
 
+    record_upload_stats(ESP_OK);
+
     // Cleanup and transition to IDLE
-    free(g_upload_session.upload_buffer);
     memset(&g_upload_session, 0, sizeof(upload_session_t));
     g_upload_session.state = UPLOAD_STATE_IDLE;
 
@@ -646,6 +857,34 @@ static esp_err_t handle_put_end(const tlv_frame_t* frame, int client_fd)
 #define CONTROL_CMD_DEPLOY_TPL  0x12  /**< Deploy built-in template: {command(1), len(1), id(N)} */
 #define CONTROL_CMD_BRIGHTNESS  0x10  /**< Set global brightness: {command(1), target(1), duration_ms(2)} */
 
+/**
+ * @brief Reply to CONTROL PLAY once the pattern loader finishes
+ *
+ * Runs on the loader task; ctx carries the requesting client fd.
+ */
+static void control_play_done(esp_err_t result, const char* pattern_name, void* ctx)
+{
+    int client_fd = (int)(intptr_t)ctx;
+    if (result != ESP_OK) {
+        uint8_t code = ERR_STORAGE_FULL;
+        if (result == ESP_ERR_NOT_FOUND) {
+            code = ERR_NOT_FOUND;
+        } else if (result == ESP_ERR_INVALID_ARG) {
+            code = ERR_INVALID_FRAME;
+        }
+        (void)send_error_response(client_fd, code, "play failed");
+        return;
+    }
+
+    uint8_t payload[PATTERN_MAX_FILENAME + 2];
+    size_t off = 0;
+    payload[off++] = 0x00;
+    size_t nl = strnlen(pattern_name, PATTERN_MAX_FILENAME - 1);
+    memcpy(&payload[off], pattern_name, nl);
+    off += nl;
+    (void)send_tlv_response(client_fd, MSG_TYPE_STATUS, payload, off);
+}
+
 /**
  * @brief Handle CONTROL command: Playback control
  *
@@ -695,25 +934,15 @@ static esp_err_t handle_control(const tlv_frame_t* frame, int client_fd)
             char pattern_name[PATTERN_MAX_FILENAME];
             playback_normalize_pattern_id(raw_name, pattern_name, sizeof(pattern_name));
 
-            esp_err_t ret = playback_play_pattern_from_storage(pattern_name);
+            // Storage read and decode prep run on the loader task; the
+            // STATUS/ERROR reply is sent from control_play_done().
+            esp_err_t ret = playback_load_pattern_async(pattern_name, control_play_done,
+                                                        (void*)(intptr_t)client_fd);
             if (ret != ESP_OK) {
-                uint8_t code = ERR_STORAGE_FULL;
-                if (ret == ESP_ERR_NOT_FOUND) {
-                    code = ERR_NOT_FOUND;
-                } else if (ret == ESP_ERR_INVALID_ARG) {
-                    code = ERR_INVALID_FRAME;
-                }
-                (void)send_error_response(client_fd, code, "play failed");
+                control_play_done(ret, pattern_name, (void*)(intptr_t)client_fd);
                 return ret;
             }
-
-            uint8_t payload[PATTERN_MAX_FILENAME + 2];
-            size_t off = 0;
-            payload[off++] = 0x00;
-            size_t nl = strnlen(pattern_name, sizeof(pattern_name) - 1);
-            memcpy(&payload[off], pattern_name, nl);
-            off += nl;
-            return send_tlv_response(client_fd, MSG_TYPE_STATUS, payload, off);
+            return ESP_OK;
         }
         case CONTROL_CMD_STOP: {
             esp_err_t ret = playback_stop();
@@ -846,73 +1075,78 @@ static esp_err_t handle_delete(const tlv_frame_t* frame, int client_fd)
     return send_error_response(client_fd, ERR_STORAGE_FULL, "Delete failed");
 }
 
+/**
+ * @brief LIST handler: one page of the pattern index
+ * Request payload: empty (first page) or start index (uint16, big-endian)
+ * Response payload:
+ *  [0-1]  entries in this page (uint16, big-endian)
+ *  per entry: name length (uint16, big-endian), name, size (uint32), mtime (uint32)
+ *  then   total patterns (uint16, big-endian)
+ *  then   start of the next page (uint16, big-endian; equals total when done)
+ */
 static esp_err_t handle_list(const tlv_frame_t* frame, int client_fd)
 {
-    (void)frame; // no payload expected
-
-    DIR* dir = opendir("/littlefs/patterns");
-    if (!dir) {
-        return send_error_response(client_fd, ERR_STORAGE_FULL, "Cannot open patterns dir");
+    size_t start = 0;
+    if (frame->length >= 2) {
+        start = ((size_t)frame->payload[0] << 8) | frame->payload[1];
     }
 
     uint8_t resp[TLV_MAX_PAYLOAD_SIZE];
+    const size_t trailer = 4; // total(2) + next(2)
     size_t off = 2; // reserve for count
     uint16_t count = 0;
-
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != NULL) {
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
-
-        // consider only .bin files
-        const char* ext = strrchr(entry->d_name, '.');
-        if (!ext || strcmp(ext, ".bin") != 0) continue;
-
-        // get file stats (build path without format truncation warnings)
-        char path[256];
-        size_t base_len = strlcpy(path, "/littlefs/patterns/", sizeof(path));
-        if (base_len < sizeof(path)) {
-            strlcpy(path + base_len, entry->d_name, sizeof(path) - base_len);
-        }
-        struct stat st;
-        if (stat(path, &st) != 0) continue;
-
-        // prepare name without extension
-        char id[PATTERN_MAX_FILENAME];
-        size_t name_len = (size_t)(ext - entry->d_name);
-        if (name_len == 0 || name_len >= sizeof(id)) continue;
-        memcpy(id, entry->d_name, name_len);
-        id[name_len] = '\0';
-
-        // space check: name_len(2) + name + size(4) + mtime(4)
-        size_t need = 2 + name_len + 4 + 4;
-        if (off + need > sizeof(resp)) {
-            ESP_LOGW(TAG, "LIST truncated due to buffer");
+    size_t total = 0;
+    bool full = false;
+
+    // Served from the RAM index; entries come in ID order so pages are stable
+    pattern_index_entry_t page[8];
+    while (!full) {
+        size_t got = 0;
+        storage_pattern_list_entries(start + count, page, sizeof(page) / sizeof(page[0]), &got, &total);
+        if (got == 0) {
             break;
         }
+        for (size_t i = 0; i < got; ++i) {
+            const pattern_index_entry_t* e = &page[i];
+            size_t name_len = strnlen(e->id, sizeof(e->id));
+
+            // space check: name_len(2) + name + size(4) + mtime(4)
+            size_t need = 2 + name_len + 4 + 4;
+            if (off + need + trailer > sizeof(resp)) {
+                full = true;    // The rest goes in the next page
+                break;
+            }
 
-        // write name length (uint16)
-        resp[off++] = (name_len >> 8) & 0xFF;
-        resp[off++] = (name_len) & 0xFF;
-        // write name
-        memcpy(&resp[off], id, name_len);
-        off += name_len;
-        // write size (uint32)
-        uint32_t fsz = (uint32_t)st.st_size;
-        memcpy(&resp[off], &fsz, 4);
-        off += 4;
-        // write timestamp (uint32)
-        uint32_t mtime = (uint32_t)st.st_mtime;
-        memcpy(&resp[off], &mtime, 4);
-        off += 4;
-
-        count++;
-    }
-    closedir(dir);
+            // write name length (uint16)
+            resp[off++] = (name_len >> 8) & 0xFF;
+            resp[off++] = (name_len) & 0xFF;
+            // write name
+            memcpy(&resp[off], e->id, name_len);
+            off += name_len;
+            // write size (uint32)
+            memcpy(&resp[off], &e->size, 4);
+            off += 4;
+            // write timestamp (uint32)
+            memcpy(&resp[off], &e->mtime, 4);
+            off += 4;
+
+            count++;
+        }
+    }
 
     // write count at start (uint16)
     resp[0] = (count >> 8) & 0xFF;
     resp[1] = (count) & 0xFF;
 
+    size_t next = start + count;
+    if (next > total) {
+        next = total;
+    }
+    resp[off++] = (total >> 8) & 0xFF;
+    resp[off++] = (total) & 0xFF;
+    resp[off++] = (next >> 8) & 0xFF;
+    resp[off++] = (next) & 0xFF;
+
     return send_tlv_response(client_fd, MSG_TYPE_STATUS, resp, off);
 }
 
@@ -924,6 +1158,8 @@ static esp_err_t handle_list(const tlv_frame_t* frame, int client_fd)
  *  [..]   LED count (uint16)
  *  [..]   storage available bytes (uint32)
  *  [..]   max chunk size (uint16)
+ *  [..]   template count (uint8)
+ *  [..]   stored pattern count (uint16)
  */
 static esp_err_t handle_status(const tlv_frame_t* frame, int client_fd)
 {
@@ -940,7 +1176,7 @@ static esp_err_t handle_status(const tlv_frame_t* frame, int client_fd)
     memcpy(&resp[off], ver, vlen); off += vlen;
 
     // LED count
-    uint16_t led_count = 320;
+    uint16_t led_count = (uint16_t)(led_driver_get_channel_count() * led_driver_get_leds_per_channel());
     memcpy(&resp[off], &led_count, 2); off += 2;
 
     // LittleFS free space
@@ -960,6 +1196,12 @@ static esp_err_t handle_status(const tlv_frame_t* frame, int client_fd)
     uint8_t tplc = (uint8_t)(tpl_count & 0xFF);
     memcpy(&resp[off], &tplc, 1); off += 1;
 
+    // Stored patterns (RAM index, no directory scan)
+    size_t pattern_count = 0;
+    (void)storage_pattern_count(&pattern_count);
+    uint16_t patc = (uint16_t)pattern_count;
+    memcpy(&resp[off], &patc, 2); off += 2;
+
     return send_tlv_response(client_fd, MSG_TYPE_STATUS, resp, off);
 }
 
@@ -995,7 +1237,7 @@ esp_err_t protocol_dispatch_command(
 
     // Dispatch based on message type
     switch (frame.type) {
-        // Upload commands (PRD 0x10-0x12)
+        // Upload commands (PRD 0x10-0x12, resume extension 0x14)
         case MSG_TYPE_PUT_BEGIN:
             ret = handle_put_begin(&frame, client_fd);
             break;
@@ -1008,6 +1250,10 @@ esp_err_t protocol_dispatch_command(
             ret = handle_put_end(&frame, client_fd);
             break;
 
+        case MSG_TYPE_PUT_RESUME:
+            ret = handle_put_resume(&frame, client_fd);
+            break;
+
         // Control commands (PRD 0x20)
         case MSG_TYPE_CONTROL:
             ret = handle_control(&frame, client_fd);
@@ -1045,6 +1291,28 @@ esp_err_t protocol_dispatch_command(
  * Timeout Handling
  * ============================================================================ */
 
+// Detach or expire the session against now_ms (caller holds the mutex)
+static void check_upload_timeout_locked(uint32_t now_ms)
+{
+    if (g_upload_session.state != UPLOAD_STATE_RECEIVING) {
+        return;
+    }
+
+    uint32_t idle_ms = now_ms - g_upload_session.last_activity_ms;
+
+    if (idle_ms > UPLOAD_RESUME_TIMEOUT_MS) {
+        ESP_LOGW(TAG, "Upload timeout: %lu ms idle (max %d ms)",
+                 (unsigned long)idle_ms, UPLOAD_RESUME_TIMEOUT_MS);
+        abort_upload_session("Idle timeout", ESP_ERR_TIMEOUT);
+    } else if (idle_ms > UPLOAD_TIMEOUT_MS && g_upload_session.client_fd >= 0) {
+        // Keep what was received; the client may PUT_RESUME
+        ESP_LOGW(TAG, "Upload idle %lu ms: detaching '%s' at %lu bytes",
+                 (unsigned long)idle_ms, g_upload_session.filename,
+                 (unsigned long)g_upload_session.bytes_received);
+        g_upload_session.client_fd = -1;
+    }
+}
+
 void protocol_check_upload_timeout(void)
 {
     if (!g_initialized || g_upload_mutex == NULL) {
@@ -1052,24 +1320,18 @@ void protocol_check_upload_timeout(void)
     }
 
     xSemaphoreTake(g_upload_mutex, portMAX_DELAY);
+    check_upload_timeout_locked(get_time_ms());
+    xSemaphoreGive(g_upload_mutex);
+}
 
-    if (g_upload_session.state == UPLOAD_STATE_RECEIVING) {
-        uint32_t now_ms = get_time_ms();
-        uint32_t idle_ms = now_ms - g_upload_session.last_activity_ms;
-
-        if (idle_ms > UPLOAD_TIMEOUT_MS) {
-            ESP_LOGW(TAG, "Upload timeout: %lu ms idle (max %d ms)",
-                     (unsigned long)idle_ms, UPLOAD_TIMEOUT_MS);
-
-            // Abort session (Phase 2 will implement cleanup)
-            if (g_upload_session.upload_buffer != NULL) {
-                free(g_upload_session.upload_buffer);
-            }
-            memset(&g_upload_session, 0, sizeof(upload_session_t));
-            g_upload_session.state = UPLOAD_STATE_IDLE;
-        }
+void protocol_check_upload_timeout_at(uint32_t now_ms)
+{
+    if (!g_initialized || g_upload_mutex == NULL) {
+        return;
     }
 
+    xSemaphoreTake(g_upload_mutex, portMAX_DELAY);
+    check_upload_timeout_locked(now_ms);
     xSemaphoreGive(g_upload_mutex);
 }
 
@@ -1077,6 +1339,23 @@ void protocol_check_upload_timeout(void)
  * Status Query
  * ============================================================================ */
 
+void protocol_client_disconnected(int client_fd)
+{
+    if (!g_initialized || g_upload_mutex == NULL || client_fd < 0) {
+        return;
+    }
+
+    xSemaphoreTake(g_upload_mutex, portMAX_DELAY);
+    if (g_upload_session.state == UPLOAD_STATE_RECEIVING &&
+        g_upload_session.client_fd == client_fd) {
+        ESP_LOGI(TAG, "Upload '%s' detached at %lu bytes; resumable for %d ms",
+                 g_upload_session.filename, (unsigned long)g_upload_session.bytes_received,
+                 UPLOAD_RESUME_TIMEOUT_MS);
+        g_upload_session.client_fd = -1;
+    }
+    xSemaphoreGive(g_upload_mutex);
+}
+
 bool protocol_get_upload_status(
     char* out_filename,
     uint32_t* out_bytes_received,
@@ -1111,3 +1390,33 @@ bool protocol_get_upload_status(
 
     return active;
 }
+
+bool protocol_get_last_upload_stats(upload_stats_t* out_stats)
+{
+    if (!g_initialized || g_upload_mutex == NULL || out_stats == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(g_upload_mutex, portMAX_DELAY);
+    bool have = g_have_upload_stats;
+    if (have) {
+        *out_stats = g_last_upload_stats;
+    }
+    xSemaphoreGive(g_upload_mutex);
+    return have;
+}
+
+bool protocol_get_upload_token(uint32_t* out_token)
+{
+    if (!g_initialized || g_upload_mutex == NULL || out_token == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(g_upload_mutex, portMAX_DELAY);
+    bool active = (g_upload_session.state == UPLOAD_STATE_RECEIVING);
+    if (active) {
+        *out_token = g_upload_session.token;
+    }
+    xSemaphoreGive(g_upload_mutex);
+    return active;
+}
@@ -15,8 +15,14 @@
 
 #include "unity.h"
 #include "protocol_parser.h"
+#include "pattern_storage.h"
+#include "pattern_index.h"
 #include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
 
 /* ========================================================================
  * TEST HELPER FUNCTIONS
@@ -142,6 +148,10 @@ static size_t build_control_play_payload(const char* pattern_name, uint8_t* out_
  * ======================================================================== */
 
 void setUp(void) {
+    // Uploads stream into LittleFS, so PUT_BEGIN needs the filesystem mounted
+    // (a second storage_init() just warns)
+    storage_init();
+
     // Initialize protocol parser before each test
     esp_err_t ret = protocol_parser_init();
     TEST_ASSERT_EQUAL(ESP_OK, ret);
@@ -306,7 +316,7 @@ TEST_CASE("Upload state machine - PUT_BEGIN initializes session", "[protocol_par
     size_t payload_len = build_put_begin_payload("test.bin", 1024, 0x12345678, payload);
     size_t frame_len = build_test_frame(MSG_TYPE_PUT_BEGIN, payload, payload_len, frame);
 
-    // Should succeed (note: will allocate 1024 bytes internally)
+    // Should succeed (note: opens the temp file, allocates no pattern buffer)
     esp_err_t ret = protocol_dispatch_command(frame, frame_len, 1);
     TEST_ASSERT_EQUAL(ESP_OK, ret);
 
@@ -404,8 +414,8 @@ TEST_CASE("Upload state machine - PUT_END validates CRC", "[protocol_parser]") {
  * Test: PUT_END should reject incomplete upload
  */
 TEST_CASE("Upload state machine - PUT_END rejects incomplete upload", "[protocol_parser]") {
-    uint8_t frame[256];
-    uint8_t payload[256];
+    uint8_t frame[640];
+    uint8_t payload[640];
 
     // Step 1: PUT_BEGIN (expect 1024 bytes)
     size_t payload_len = build_put_begin_payload("test.bin", 1024, 0x12345678, payload);
@@ -426,6 +436,227 @@ TEST_CASE("Upload state machine - PUT_END rejects incomplete upload", "[protocol
     TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, ret);
 }
 
+/**
+ * Test: retransmits are trimmed, chunks ahead of a gap wait for it
+ */
+TEST_CASE("Upload state machine - PUT_DATA accepts chunks within the window", "[protocol_parser]") {
+    static uint8_t frame[2 * UPLOAD_BLOCK_SIZE + 16];
+    static uint8_t payload[2 * UPLOAD_BLOCK_SIZE + 8];
+    static uint8_t test_data[4 * UPLOAD_BLOCK_SIZE + 100];   // Short final block
+    const uint32_t total = sizeof(test_data);
+    const uint32_t blk = UPLOAD_BLOCK_SIZE;
+    for (uint32_t i = 0; i < total; i++) {
+        test_data[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    uint32_t expected_crc = esp_rom_crc32_le(0, test_data, total);
+
+    size_t payload_len = build_put_begin_payload("order.bin", total, expected_crc, payload);
+    size_t frame_len = build_test_frame(MSG_TYPE_PUT_BEGIN, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+
+    // Tail first (blocks 3..4), then block 1
+    payload_len = build_put_data_payload(3 * blk, &test_data[3 * blk], total - 3 * blk, payload);
+    frame_len = build_test_frame(MSG_TYPE_PUT_DATA, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+    payload_len = build_put_data_payload(blk, &test_data[blk], blk, payload);
+    frame_len = build_test_frame(MSG_TYPE_PUT_DATA, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+
+    uint32_t bytes_received = 1;
+    TEST_ASSERT_TRUE(protocol_get_upload_status(NULL, &bytes_received, NULL));
+    TEST_ASSERT_EQUAL_UINT32(0, bytes_received);    // Nothing contiguous yet
+
+    // First half-block, then a retransmit overlapping it: frontier moves to
+    // the end of block 0 and straight across block 1
+    payload_len = build_put_data_payload(0, test_data, blk / 2, payload);
+    frame_len = build_test_frame(MSG_TYPE_PUT_DATA, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+    payload_len = build_put_data_payload(0, test_data, blk, payload);
+    frame_len = build_test_frame(MSG_TYPE_PUT_DATA, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+    TEST_ASSERT_TRUE(protocol_get_upload_status(NULL, &bytes_received, NULL));
+    TEST_ASSERT_EQUAL_UINT32(2 * blk, bytes_received);
+
+    // Fill the gap: everything stored, CRC matches
+    payload_len = build_put_data_payload(2 * blk, &test_data[2 * blk], blk, payload);
+    frame_len = build_test_frame(MSG_TYPE_PUT_DATA, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+    TEST_ASSERT_TRUE(protocol_get_upload_status(NULL, &bytes_received, NULL));
+    TEST_ASSERT_EQUAL_UINT32(total, bytes_received);
+
+    frame_len = build_test_frame(MSG_TYPE_PUT_END, NULL, 0, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+
+    // Past the window: dropped, session kept
+    payload_len = build_put_begin_payload("wide.bin", 2 * UPLOAD_WINDOW_BYTES, 0, payload);
+    frame_len = build_test_frame(MSG_TYPE_PUT_BEGIN, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+    payload_len = build_put_data_payload(UPLOAD_WINDOW_BYTES, test_data, blk, payload);
+    frame_len = build_test_frame(MSG_TYPE_PUT_DATA, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+    TEST_ASSERT_TRUE(protocol_get_upload_status(NULL, &bytes_received, NULL));
+    TEST_ASSERT_EQUAL_UINT32(0, bytes_received);
+}
+
+/**
+ * Test: a dropped connection can pick the upload up again with its token
+ */
+TEST_CASE("Upload state machine - PUT_RESUME continues after disconnect", "[protocol_parser]") {
+    uint8_t frame[256];
+    uint8_t payload[256];
+    uint8_t test_data[192];
+    for (int i = 0; i < 192; i++) {
+        test_data[i] = (uint8_t)(i ^ 0x3C);
+    }
+    uint32_t expected_crc = esp_rom_crc32_le(0, test_data, 192);
+
+    size_t payload_len = build_put_begin_payload("resume.bin", 192, expected_crc, payload);
+    size_t frame_len = build_test_frame(MSG_TYPE_PUT_BEGIN, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+    uint32_t token = 0;
+    TEST_ASSERT_TRUE(protocol_get_upload_token(&token));
+    TEST_ASSERT_NOT_EQUAL(0, token);
+
+    payload_len = build_put_data_payload(0, test_data, 128, payload);
+    frame_len = build_test_frame(MSG_TYPE_PUT_DATA, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+
+    protocol_client_disconnected(1);
+
+    // New connection: data is refused until it resumes, wrong token too
+    payload_len = build_put_data_payload(128, &test_data[128], 64, payload);
+    frame_len = build_test_frame(MSG_TYPE_PUT_DATA, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, protocol_dispatch_command(frame, frame_len, 2));
+
+    uint8_t tok[4] = {0};
+    uint32_t wrong = token + 1;
+    tok[0] = wrong >> 24; tok[1] = wrong >> 16; tok[2] = wrong >> 8; tok[3] = wrong;
+    frame_len = build_test_frame(MSG_TYPE_PUT_RESUME, tok, 4, frame);
+    protocol_dispatch_command(frame, frame_len, 2);     // ERR_NOT_FOUND reply
+    frame_len = build_test_frame(MSG_TYPE_PUT_DATA, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, protocol_dispatch_command(frame, frame_len, 2));
+
+    tok[0] = token >> 24; tok[1] = token >> 16; tok[2] = token >> 8; tok[3] = token;
+    frame_len = build_test_frame(MSG_TYPE_PUT_RESUME, tok, 4, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 2));
+
+    uint32_t bytes_received = 0;
+    TEST_ASSERT_TRUE(protocol_get_upload_status(NULL, &bytes_received, NULL));
+    TEST_ASSERT_EQUAL_UINT32(128, bytes_received);
+
+    payload_len = build_put_data_payload(128, &test_data[128], 64, payload);
+    frame_len = build_test_frame(MSG_TYPE_PUT_DATA, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 2));
+    frame_len = build_test_frame(MSG_TYPE_PUT_END, NULL, 0, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 2));
+}
+
+/**
+ * Test: a detached session past UPLOAD_RESUME_TIMEOUT_MS is dropped with its temp file
+ */
+TEST_CASE("Upload state machine - expired detached session removes temp file", "[protocol_parser]") {
+    uint8_t frame[256];
+    uint8_t payload[256];
+    uint8_t test_data[128];
+    memset(test_data, 0xE7, sizeof(test_data));
+
+    size_t payload_len = build_put_begin_payload("expire", 256, 0, payload);
+    size_t frame_len = build_test_frame(MSG_TYPE_PUT_BEGIN, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+    char session_id[PATTERN_MAX_FILENAME];
+    TEST_ASSERT_TRUE(protocol_get_upload_status(session_id, NULL, NULL));
+    payload_len = build_put_data_payload(0, test_data, 128, payload);
+    frame_len = build_test_frame(MSG_TYPE_PUT_DATA, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+
+    char tmp_path[96];
+    snprintf(tmp_path, sizeof(tmp_path), "%s/%s.tmp", STORAGE_PATTERN_DIR, session_id);
+    struct stat st;
+    TEST_ASSERT_EQUAL(0, stat(tmp_path, &st));
+
+    protocol_client_disconnected(1);
+    uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+    // Still resumable short of the resume timeout
+    protocol_check_upload_timeout_at(now_ms + UPLOAD_TIMEOUT_MS + 1000);
+    TEST_ASSERT_TRUE(protocol_get_upload_status(NULL, NULL, NULL));
+    TEST_ASSERT_EQUAL(0, stat(tmp_path, &st));
+
+    protocol_check_upload_timeout_at(now_ms + UPLOAD_RESUME_TIMEOUT_MS + 1000);
+    TEST_ASSERT_FALSE(protocol_get_upload_status(NULL, NULL, NULL));
+    TEST_ASSERT_NOT_EQUAL(0, stat(tmp_path, &st));
+}
+
+/**
+ * Test: the longest pattern ID streams to its own temp file, not over the live .bin
+ */
+TEST_CASE("Upload state machine - longest ID keeps the live pattern until commit", "[protocol_parser]") {
+    char id[PATTERN_INDEX_ID_MAX];
+    memset(id, 'L', sizeof(id) - 1);
+    id[sizeof(id) - 1] = '\0';
+    uint8_t v1[64], v2[64];
+    memset(v1, 0x01, sizeof(v1));
+    memset(v2, 0x02, sizeof(v2));
+
+    storage_pattern_writer_t w;
+    TEST_ASSERT_EQUAL(ESP_OK, storage_pattern_write_begin(&w, id, sizeof(v1), NULL, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, storage_pattern_write_append(&w, v1, sizeof(v1)));
+    TEST_ASSERT_EQUAL(ESP_OK, storage_pattern_write_commit(&w));
+
+    // Mid-upload, the old bytes are still readable under the full name
+    TEST_ASSERT_EQUAL(ESP_OK, storage_pattern_write_begin(&w, id, sizeof(v2), NULL, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, storage_pattern_write_append(&w, v2, 16));
+    char bin_path[96];
+    snprintf(bin_path, sizeof(bin_path), "%s/%s.bin", STORAGE_PATTERN_DIR, id);
+    struct stat st;
+    TEST_ASSERT_EQUAL(0, stat(bin_path, &st));
+    TEST_ASSERT_EQUAL(sizeof(v1), st.st_size);
+    storage_pattern_write_abort(&w);
+    TEST_ASSERT_EQUAL(0, stat(bin_path, &st));
+    TEST_ASSERT_EQUAL(sizeof(v1), st.st_size);
+
+    // One past the limit is refused rather than truncated
+    char too_long[PATTERN_INDEX_ID_MAX + 1];
+    memset(too_long, 'L', sizeof(too_long) - 1);
+    too_long[sizeof(too_long) - 1] = '\0';
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, storage_pattern_write_begin(&w, too_long, sizeof(v2), NULL, 0));
+
+    TEST_ASSERT_EQUAL(ESP_OK, storage_pattern_delete(id));
+}
+
+/**
+ * Test: a finished upload leaves its throughput and heap stats behind
+ */
+TEST_CASE("Upload state machine - stats recorded for last upload", "[protocol_parser]") {
+    uint8_t frame[256];
+    uint8_t payload[256];
+    uint8_t test_data[128];
+    memset(test_data, 0x5A, sizeof(test_data));
+    uint32_t expected_crc = esp_rom_crc32_le(0, test_data, 128);
+
+    upload_stats_t stats;
+    TEST_ASSERT_FALSE(protocol_get_last_upload_stats(&stats));
+
+    size_t payload_len = build_put_begin_payload("stats.bin", 128, expected_crc ^ 1, payload);
+    size_t frame_len = build_test_frame(MSG_TYPE_PUT_BEGIN, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+    char session_id[PATTERN_MAX_FILENAME];
+    TEST_ASSERT_TRUE(protocol_get_upload_status(session_id, NULL, NULL));
+    payload_len = build_put_data_payload(0, test_data, 128, payload);
+    frame_len = build_test_frame(MSG_TYPE_PUT_DATA, payload, payload_len, frame);
+    TEST_ASSERT_EQUAL(ESP_OK, protocol_dispatch_command(frame, frame_len, 1));
+    frame_len = build_test_frame(MSG_TYPE_PUT_END, NULL, 0, frame);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC, protocol_dispatch_command(frame, frame_len, 1));
+
+    // Rejected uploads are reported too
+    TEST_ASSERT_TRUE(protocol_get_last_upload_stats(&stats));
+    TEST_ASSERT_EQUAL_STRING(session_id, stats.filename);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC, stats.result);
+    TEST_ASSERT_EQUAL_UINT32(128, stats.bytes);
+    // Well under the pattern size: nothing is buffered whole
+    TEST_ASSERT_TRUE(stats.heap_peak_bytes < STORAGE_WRITE_STAGE_SIZE + 1024);
+}
+
 /* ========================================================================
  * CONTROL COMMAND TESTS
  * ======================================================================== */
@@ -642,6 +873,11 @@ void app_main(void) {
     RUN_TEST(test_Upload_state_machine___PUT_DATA_requires_active_session);
     RUN_TEST(test_Upload_state_machine___PUT_END_validates_CRC);
     RUN_TEST(test_Upload_state_machine___PUT_END_rejects_incomplete_upload);
+    RUN_TEST(test_Upload_state_machine___PUT_DATA_accepts_chunks_within_the_window);
+    RUN_TEST(test_Upload_state_machine___PUT_RESUME_continues_after_disconnect);
+    RUN_TEST(test_Upload_state_machine___expired_detached_session_removes_temp_file);
+    RUN_TEST(test_Upload_state_machine___longest_ID_keeps_the_live_pattern_until_commit);
+    RUN_TEST(test_Upload_state_machine___stats_recorded_for_last_upload);
 
     // CONTROL command tests
     RUN_TEST(test_CONTROL_command___PLAY_parses_pattern_name);
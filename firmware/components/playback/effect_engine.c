@@ -1,11 +1,17 @@
 /**
  * @file effect_engine.c
  * @brief Lightweight effect engine: interpolation + chaining (MVP)
+ *
+ * The chain is compiled rather than interpreted: whenever a parameter
+ * changes, every stage is folded in order into three 256-entry tables (one
+ * per byte position of a GRB triplet), and effect_chain_apply() does a
+ * single table lookup per byte. Adding a stage means adding a compose
+ * function to k_fx_stages, not another pass over the pixels.
  */
 
 #include "effect_engine.h"
+#include "prism_gamma_tables.h"
 #include <string.h>
-#include <math.h>
 
 typedef struct {
     uint8_t current;
@@ -25,6 +31,12 @@ typedef struct {
     bool active;
 } param16_t;
 
+// Byte positions within a triplet; buffers are in WS2812 wire order (GRB)
+#define FX_CH_G 0
+#define FX_CH_R 1
+#define FX_CH_B 2
+#define FX_CHANNELS 3
+
 typedef struct {
     // brightness effect (0..255)
     param8_t brightness;
@@ -32,18 +44,134 @@ typedef struct {
     param16_t gamma_x100;
     uint8_t gamma_lut[256];
     bool gamma_lut_dirty;
+    // white balance: per-channel gain (255 = unity)
+    bool white_balance_active;
+    uint8_t wb_gain[FX_CHANNELS];
+    // compiled pipeline
+    uint8_t lut[FX_CHANNELS][256];
+    bool lut_dirty;
+    bool lut_identity;          // every stage is a no-op; apply can skip
 } fx_state_t;
 
 static fx_state_t s_fx;
 
+// x * scale / 255 with rounding, so scale 255 is exact identity
+static inline uint8_t fx_scale8(uint8_t x, uint8_t scale)
+{
+    return (uint8_t)(((uint32_t)x * scale + 127u) / 255u);
+}
+
+void effect_gamma_build_lut(uint16_t gamma_x100, uint8_t lut[256])
+{
+    if (gamma_x100 == 0) {
+        gamma_x100 = 100;
+    }
+    // 255 * 2^(-t), t = gamma * -log2(i/255) in Q11: integer part is a shift,
+    // the fraction indexes exp2 (Q8 step, interpolated over the low 3 bits).
+    lut[0] = 0;
+    for (int i = 1; i < 256; ++i) {
+        uint32_t t = ((uint32_t)prism_gamma_log2_q11[i] * gamma_x100) / 100u;
+        uint32_t t_int = t >> PRISM_GAMMA_LOG2_FRAC_BITS;
+        if (t_int >= 16) {
+            lut[i] = 0;
+            continue;
+        }
+        uint32_t t_frac = t & ((1u << PRISM_GAMMA_LOG2_FRAC_BITS) - 1u);
+        uint32_t j = t_frac >> 3;
+        uint32_t r = t_frac & 7u;
+        uint32_t e0 = prism_gamma_exp2_q15[j];
+        uint32_t e = e0 - (((e0 - prism_gamma_exp2_q15[j + 1]) * r) >> 3);
+        uint32_t y = (255u * e) >> t_int;
+        lut[i] = (uint8_t)((y + (1u << 14)) >> 15);
+    }
+}
+
+static void fx_stage_gamma(uint8_t lut[FX_CHANNELS][256])
+{
+    if (!s_fx.gamma_x100.active) {
+        return;
+    }
+    if (s_fx.gamma_lut_dirty) {
+        effect_gamma_build_lut(s_fx.gamma_x100.current, s_fx.gamma_lut);
+        s_fx.gamma_lut_dirty = false;
+    }
+    for (int c = 0; c < FX_CHANNELS; ++c) {
+        for (int i = 0; i < 256; ++i) {
+            lut[c][i] = s_fx.gamma_lut[lut[c][i]];
+        }
+    }
+}
+
+static void fx_stage_brightness(uint8_t lut[FX_CHANNELS][256])
+{
+    if (!s_fx.brightness.active || s_fx.brightness.current == 255) {
+        return;
+    }
+    uint8_t scale = s_fx.brightness.current;
+    for (int c = 0; c < FX_CHANNELS; ++c) {
+        for (int i = 0; i < 256; ++i) {
+            lut[c][i] = fx_scale8(lut[c][i], scale);
+        }
+    }
+}
+
+static void fx_stage_white_balance(uint8_t lut[FX_CHANNELS][256])
+{
+    if (!s_fx.white_balance_active) {
+        return;
+    }
+    for (int c = 0; c < FX_CHANNELS; ++c) {
+        uint8_t gain = s_fx.wb_gain[c];
+        if (gain == 255) {
+            continue;
+        }
+        for (int i = 0; i < 256; ++i) {
+            lut[c][i] = fx_scale8(lut[c][i], gain);
+        }
+    }
+}
+
+// Pipeline order: gamma, then brightness, then white balance
+typedef void (*fx_stage_fn)(uint8_t lut[FX_CHANNELS][256]);
+static const fx_stage_fn k_fx_stages[] = {
+    fx_stage_gamma,
+    fx_stage_brightness,
+    fx_stage_white_balance,
+};
+
+static void fx_compile(void)
+{
+    for (int c = 0; c < FX_CHANNELS; ++c) {
+        for (int i = 0; i < 256; ++i) {
+            s_fx.lut[c][i] = (uint8_t)i;
+        }
+    }
+    for (size_t k = 0; k < sizeof(k_fx_stages) / sizeof(k_fx_stages[0]); ++k) {
+        k_fx_stages[k](s_fx.lut);
+    }
+
+    s_fx.lut_identity = true;
+    for (int c = 0; c < FX_CHANNELS && s_fx.lut_identity; ++c) {
+        for (int i = 0; i < 256; ++i) {
+            if (s_fx.lut[c][i] != (uint8_t)i) {
+                s_fx.lut_identity = false;
+                break;
+            }
+        }
+    }
+    s_fx.lut_dirty = false;
+}
+
 void effect_engine_init(void)
 {
     memset(&s_fx, 0, sizeof(s_fx));
+    s_fx.lut_dirty = true;
 }
 
 void effect_chain_clear(void)
 {
     memset(&s_fx, 0, sizeof(s_fx));
+    s_fx.lut_dirty = true;
 }
 
 void effect_add_brightness(uint8_t start_value)
@@ -54,6 +182,7 @@ void effect_add_brightness(uint8_t start_value)
     s_fx.brightness.target = start_value;
     s_fx.brightness.elapsed_ms = 0;
     s_fx.brightness.duration_ms = 0;
+    s_fx.lut_dirty = true;
 }
 
 void effect_brightness_set_target(uint8_t target_value, uint32_t duration_ms)
@@ -71,6 +200,7 @@ void effect_brightness_set_target(uint8_t target_value, uint32_t duration_ms)
 void effect_engine_tick(uint32_t elapsed_ms)
 {
     // brightness tick
+    uint8_t prev_brightness = s_fx.brightness.current;
     if (s_fx.brightness.active) {
         if (s_fx.brightness.duration_ms == 0) {
             s_fx.brightness.current = s_fx.brightness.target;
@@ -93,6 +223,10 @@ void effect_engine_tick(uint32_t elapsed_ms)
         }
     }
 
+    if (s_fx.brightness.current != prev_brightness) {
+        s_fx.lut_dirty = true;
+    }
+
     // gamma tick
     if (s_fx.gamma_x100.active) {
         if (s_fx.gamma_x100.duration_ms == 0) {
@@ -122,49 +256,41 @@ void effect_engine_tick(uint32_t elapsed_ms)
             }
         }
     }
+    if (s_fx.gamma_lut_dirty) {
+        s_fx.lut_dirty = true;
+    }
 }
 
 void effect_chain_apply(uint8_t* rgb_buffer, size_t led_count)
 {
     if (!rgb_buffer || led_count == 0) return;
 
-    // Refresh gamma LUT if needed
-    if (s_fx.gamma_lut_dirty) {
-        // Compute gamma factor as float (x100)
-        float g = (s_fx.gamma_x100.current > 0) ? (s_fx.gamma_x100.current / 100.0f) : 1.0f;
-        for (int i = 0; i < 256; ++i) {
-            float x = (float)i / 255.0f;
-            float y = (float) (255.0f * powf(x, g) + 0.5f);
-            if (y < 0.0f) {
-                y = 0.0f;
-            }
-            if (y > 255.0f) {
-                y = 255.0f;
-            }
-            s_fx.gamma_lut[i] = (uint8_t)y;
-        }
-        s_fx.gamma_lut_dirty = false;
+    if (s_fx.lut_dirty) {
+        fx_compile();
+    }
+    if (s_fx.lut_identity) {
+        return;
     }
 
-    // Apply gamma first, then brightness scale
-    if (s_fx.gamma_x100.active) {
-        for (size_t i = 0; i < led_count; ++i) {
-            size_t idx = i * 3;
-            rgb_buffer[idx + 0] = s_fx.gamma_lut[rgb_buffer[idx + 0]];
-            rgb_buffer[idx + 1] = s_fx.gamma_lut[rgb_buffer[idx + 1]];
-            rgb_buffer[idx + 2] = s_fx.gamma_lut[rgb_buffer[idx + 2]];
-        }
+    // One lookup per byte through the compiled per-channel tables
+    const uint8_t *lut0 = s_fx.lut[0];
+    const uint8_t *lut1 = s_fx.lut[1];
+    const uint8_t *lut2 = s_fx.lut[2];
+    for (size_t i = 0; i < led_count; ++i) {
+        size_t idx = i * 3;
+        rgb_buffer[idx + 0] = lut0[rgb_buffer[idx + 0]];
+        rgb_buffer[idx + 1] = lut1[rgb_buffer[idx + 1]];
+        rgb_buffer[idx + 2] = lut2[rgb_buffer[idx + 2]];
     }
+}
 
-    if (s_fx.brightness.active) {
-        uint8_t scale = s_fx.brightness.current; // 0..255
-        for (size_t i = 0; i < led_count; ++i) {
-            size_t idx = i * 3;
-            rgb_buffer[idx + 0] = (uint8_t)((rgb_buffer[idx + 0] * scale) >> 8);
-            rgb_buffer[idx + 1] = (uint8_t)((rgb_buffer[idx + 1] * scale) >> 8);
-            rgb_buffer[idx + 2] = (uint8_t)((rgb_buffer[idx + 2] * scale) >> 8);
-        }
+bool effect_chain_get_lut(uint8_t lut[FX_CHANNELS][256])
+{
+    if (s_fx.lut_dirty) {
+        fx_compile();
     }
+    memcpy(lut, s_fx.lut, sizeof(s_fx.lut));
+    return !s_fx.lut_identity;
 }
 
 void effect_add_gamma(uint16_t gamma_x100)
@@ -177,6 +303,7 @@ void effect_add_gamma(uint16_t gamma_x100)
     s_fx.gamma_x100.elapsed_ms = 0;
     s_fx.gamma_x100.duration_ms = 0;
     s_fx.gamma_lut_dirty = true;
+    s_fx.lut_dirty = true;
 }
 
 void effect_gamma_set_target(uint16_t gamma_x100, uint32_t duration_ms)
@@ -190,3 +317,12 @@ void effect_gamma_set_target(uint16_t gamma_x100, uint32_t duration_ms)
     s_fx.gamma_x100.elapsed_ms = 0;
     s_fx.gamma_x100.duration_ms = duration_ms;
 }
+
+void effect_set_white_balance(uint8_t r_gain, uint8_t g_gain, uint8_t b_gain)
+{
+    s_fx.wb_gain[FX_CH_G] = g_gain;
+    s_fx.wb_gain[FX_CH_R] = r_gain;
+    s_fx.wb_gain[FX_CH_B] = b_gain;
+    s_fx.white_balance_active = (r_gain != 255 || g_gain != 255 || b_gain != 255);
+    s_fx.lut_dirty = true;
+}
@@ -33,17 +33,39 @@ void effect_brightness_set_target(uint8_t target_value, uint32_t duration_ms);
 void effect_engine_tick(uint32_t elapsed_ms);
 
 /**
- * Apply the active chain to an in-place RGB buffer (8-bit RGBRGB...).
- * led_count = number of RGB triplets in buffer.
+ * Apply the active chain to an in-place buffer of 8-bit triplets in wire
+ * order (GRBGRB...). The chain is compiled into per-channel LUTs when a
+ * parameter changes, so this is one table lookup per byte.
+ * led_count = number of triplets in buffer.
  */
 void effect_chain_apply(uint8_t* rgb_buffer, size_t led_count);
 
+/**
+ * Copy the compiled per-channel tables (lut[0..2] for the G, R, B byte
+ * positions) so the chain can be applied elsewhere, e.g. by the LED
+ * encoder at transmit time. Same result as effect_chain_apply().
+ * Returns false if the chain is currently the identity.
+ */
+bool effect_chain_get_lut(uint8_t lut[3][256]);
+
 /** Add a gamma correction effect to the chain (gamma x100, e.g. 100 = 1.0). */
 void effect_add_gamma(uint16_t gamma_x100);
 
 /** Smoothly change gamma (x100) to target over duration. */
 void effect_gamma_set_target(uint16_t gamma_x100, uint32_t duration_ms);
 
+/**
+ * Fill lut with 255 * (i / 255)^(gamma_x100 / 100) using integer math only
+ * (within +/-1 of powf). Cheap enough to rerun every frame of a gamma ramp.
+ */
+void effect_gamma_build_lut(uint16_t gamma_x100, uint8_t lut[256]);
+
+/**
+ * Per-channel white balance gains (255 = unity), applied after brightness.
+ * Colour temperature presets map onto these gains.
+ */
+void effect_set_white_balance(uint8_t r_gain, uint8_t g_gain, uint8_t b_gain);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,30 +1,47 @@
 /**
  * @file led_driver.h
- * @brief Dual-channel RMT LED driver for PRISM K1
+ * @brief N-channel RMT LED driver for PRISM K1
  *
- * Task 8: RMT LED driver for 2×160 WS2812B LEDs at 120 FPS
+ * Task 8: RMT LED driver for WS2812B strips at 120 FPS
  * Based on proven Emotiscope ESP32-S3 reference implementation
  *
- * Hardware Configuration:
+ * Default Hardware Configuration (LED_DRIVER_CONFIG_DEFAULT):
  * - Channel 1: GPIO 9  → 160 WS2812B LEDs (independent strip)
  * - Channel 2: GPIO 10 → 160 WS2812B LEDs (independent strip)
  * - Total: 320 LEDs across 2 physically separate strips
  *
+ * Other layouts (1..LED_MAX_CHANNELS channels of up to LED_MAX_LEDS_PER_CH
+ * LEDs each, any GPIOs) are selected at runtime with
+ * led_driver_init_with_config().
+ *
  * Architecture:
- * - Dual independent RMT TX channels with separate encoders
- * - Asynchronous parallel transmission for performance
- * - Double-buffered per channel (front/back buffers)
- * - Hardware timer-driven 120 FPS frame submission
+ * - Independent output channels behind a backend seam (led_hal.h); the
+ *   default backend uses one RMT TX channel and encoder per channel
+ * - Asynchronous parallel transmission: every channel is started before
+ *   any is waited on
+ * - Lock-free render-ahead queue shared by all channels (2-4 frames)
+ * - Zero-copy acquire/commit: renderers write straight into the back slot
+ * - Frames carry a presentation slot; frames whose slot has passed are dropped
+ * - Hardware timer-driven 120 FPS frame clock that also paces the renderer
  * - GRB color order (not RGB!)
  *
- * Memory footprint: ~6.5KB (4×480 byte buffers + overhead)
+ * Frame submission (acquire/commit/submit) is wait-free and must come from a
+ * single renderer task; the refresh task never blocks on it.
+ *
+ * Memory footprint: (LED_RENDER_AHEAD_FRAMES + 2) slots of channel_count ×
+ * leds_per_channel × 3 bytes, allocated at init (~3.8KB for the default
+ * 2×160 layout at the default depth of 2)
  */
 
 #ifndef PRISM_LED_DRIVER_H
 #define PRISM_LED_DRIVER_H
 
+#include "sdkconfig.h"
 #include "esp_err.h"
 #include "prism_config.h"
+#include "led_hal.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -33,30 +50,55 @@ extern "C" {
 #endif
 
 /**
- * Hardware Configuration (Dual Independent Channels)
+ * Default Hardware Configuration (Dual Independent Channels)
  */
 #define LED_GPIO_CH1        9       ///< GPIO pin for Channel 1 data output
 #define LED_GPIO_CH2        10      ///< GPIO pin for Channel 2 data output
 #define LED_COUNT_PER_CH    160     ///< LEDs per channel
 #define LED_TOTAL_COUNT     320     ///< Total LEDs (2 channels)
 
+/**
+ * Layout limits for led_driver_init_with_config()
+ */
+#define LED_MAX_CHANNELS        4       ///< ESP32-S3 has 4 RMT TX channels
+#define LED_MAX_LEDS_PER_CH     300     ///< Longest supported strip per channel
+
 /**
  * Color Format (GRB order for WS2812B)
  */
 #define LED_BYTES_PER_LED   3       ///< GRB bytes per LED
 #define LED_FRAME_SIZE_CH   (LED_COUNT_PER_CH * LED_BYTES_PER_LED)  ///< 480 bytes per channel
+#define LED_MAX_FRAME_SIZE_CH   (LED_MAX_LEDS_PER_CH * LED_BYTES_PER_LED)  ///< 900 bytes
+
+/**
+ * Wire time of one channel: 24 bits of at most 1.3us per LED plus the 50us
+ * latch. Channels shift out in parallel, so this must fit in a frame period
+ * (about 265 LEDs at 120 FPS) or every frame overruns.
+ */
+#define LED_WIRE_TIME_US(leds)  ((uint32_t)(leds) * 24u * 13u / 10u + 50u)
 
 /**
  * Timing Configuration
  */
 // Use global LED_FPS_TARGET from prism_config.h (generated from CANON)
-#define LED_FRAME_TIME_MS   (1000 / LED_FPS_TARGET)
+#define LED_FRAME_TIME_MS   (1000 / LED_FPS_TARGET)     ///< Truncated; coarse timeouts only
+#define LED_FRAME_PERIOD_US (1000000 / LED_FPS_TARGET)  ///< Frame clock period (8333 us @ 120 FPS)
+
+/**
+ * Render-ahead depth: frames the renderer may queue ahead of the transmit slot
+ */
+#ifdef CONFIG_PRISM_RENDER_AHEAD_FRAMES
+#define LED_RENDER_AHEAD_FRAMES CONFIG_PRISM_RENDER_AHEAD_FRAMES
+#else
+#define LED_RENDER_AHEAD_FRAMES 2
+#endif
 
 /**
  * RMT Configuration (proven values from Emotiscope)
  */
 #define LED_RMT_RESOLUTION_HZ   10000000    ///< 10MHz tick resolution (0.1us per tick)
 #define LED_RMT_MEM_BLOCKS      128         ///< RMT memory blocks per channel
+#define LED_RMT_MEM_BLOCKS_MIN  48          ///< Per channel when more than 2 share RMT memory
 
 /**
  * Channel identifier
@@ -64,9 +106,51 @@ extern "C" {
 typedef enum {
     LED_CHANNEL_1 = 0,  ///< First independent channel (GPIO 9)
     LED_CHANNEL_2 = 1,  ///< Second independent channel (GPIO 10)
-    LED_CHANNEL_COUNT = 2
+    LED_CHANNEL_3 = 2,
+    LED_CHANNEL_4 = 3,
 } led_channel_t;
 
+/**
+ * Runtime channel layout and output backend
+ */
+typedef struct {
+    uint8_t channel_count;              ///< 1..LED_MAX_CHANNELS
+    uint16_t leds_per_channel;          ///< 1..LED_MAX_LEDS_PER_CH, same on every channel
+    int gpio[LED_MAX_CHANNELS];         ///< Data pin per channel
+    const led_hal_ops_t *hal;           ///< Output backend; NULL selects led_hal_rmt_ops
+    void *hal_ctx;                      ///< Passed through to every backend op
+    bool output_lut;                    ///< Frames carry an output LUT applied while encoding
+                                        ///< (backend must have LED_HAL_CAP_OUTPUT_LUT)
+} led_driver_config_t;
+
+#if CONFIG_PRISM_LED_LUT_ENCODER
+#define LED_OUTPUT_LUT_DEFAULT  true    ///< The RMT backend applies output LUTs
+#else
+#define LED_OUTPUT_LUT_DEFAULT  false
+#endif
+
+#define LED_DRIVER_CONFIG_DEFAULT() {                           \
+    .channel_count = 2,                                         \
+    .leds_per_channel = LED_COUNT_PER_CH,                       \
+    .gpio = {LED_GPIO_CH1, LED_GPIO_CH2, -1, -1},               \
+    .hal = NULL,                                                \
+    .hal_ctx = NULL,                                            \
+    .output_lut = LED_OUTPUT_LUT_DEFAULT,                       \
+}
+
+/**
+ * Back buffers of one acquired frame
+ */
+typedef struct {
+    uint8_t *ch[LED_MAX_CHANNELS];      ///< GRB buffers; channel_count entries are valid
+    uint8_t channel_count;
+    uint16_t leds_per_channel;          ///< Each buffer is leds_per_channel * 3 bytes
+    int64_t present_us;                 ///< Presentation time (esp_timer clock)
+    ws2812_output_lut_t *output_lut;    ///< Colour transform for every channel, applied while
+                                        ///< encoding; NULL unless config.output_lut. Holds a
+                                        ///< stale frame's LUT, so fill it every frame.
+} led_frame_t;
+
 /**
  * Driver statistics per channel
  */
@@ -81,26 +165,55 @@ typedef struct {
  * Global driver statistics
  */
 typedef struct {
-    led_channel_stats_t ch1;        ///< Channel 1 statistics
-    led_channel_stats_t ch2;        ///< Channel 2 statistics
-    uint32_t total_buffer_swaps;    ///< Total buffer swaps across both channels
+    led_channel_stats_t channels[LED_MAX_CHANNELS]; ///< Per-channel statistics
+    uint8_t channel_count;          ///< Valid entries in channels[]
+    uint32_t total_buffer_swaps;    ///< Committed frames taken by the refresh task
+    uint32_t frames_dropped;        ///< Queued frames dropped because their slot had passed
+    uint32_t frames_duplicated;     ///< Transmit slots that repeated the previous frame
+    uint32_t queue_underruns;       ///< Times the render-ahead queue ran dry while frames were flowing
+    uint32_t queue_depth;           ///< Frames queued ahead at the time of the snapshot
+    uint32_t queue_capacity;        ///< LED_RENDER_AHEAD_FRAMES
+    uint32_t frames_skipped;        ///< Transmit slots missed because the refresh task woke late
+    uint32_t jitter_max_us;         ///< Worst refresh wake-up offset from its clock slot
+    uint32_t jitter_avg_us;         ///< Average refresh wake-up offset from its clock slot
     bool is_running;                 ///< Driver active status
 } led_driver_stats_t;
 
 /**
- * @brief Initialize the dual-channel LED driver
+ * @brief Initialize the LED driver with the default 2×160 layout
+ *
+ * Same as led_driver_init_with_config() with LED_DRIVER_CONFIG_DEFAULT().
+ */
+esp_err_t led_driver_init(void);
+
+/**
+ * @brief Initialize the LED driver with a runtime channel layout
  *
- * Configures both RMT channels, allocates buffers, prepares for 120 FPS operation.
+ * Brings up every configured channel on the backend, allocates the
+ * render-ahead buffers, prepares for 120 FPS operation.
  * Based on proven Emotiscope initialization pattern.
  *
+ * @param config Channel layout and backend (copied)
  * @return ESP_OK on success
+ *         ESP_ERR_INVALID_ARG if config is NULL or out of range
+ *         ESP_ERR_NOT_SUPPORTED if output_lut is set and the backend cannot apply it
  *         ESP_ERR_NO_MEM if buffer allocation fails
  *         ESP_ERR_INVALID_STATE if already initialized
  */
-esp_err_t led_driver_init(void);
+esp_err_t led_driver_init_with_config(const led_driver_config_t *config);
 
 /**
- * @brief Start LED output transmission on both channels
+ * @brief Configured channel count (default layout before init)
+ */
+uint8_t led_driver_get_channel_count(void);
+
+/**
+ * @brief Configured LEDs per channel (default layout before init)
+ */
+uint16_t led_driver_get_leds_per_channel(void);
+
+/**
+ * @brief Start LED output transmission on all channels
  *
  * Begins 120 FPS refresh task with asynchronous parallel transmission.
  * Must be called after led_driver_init().
@@ -110,31 +223,118 @@ esp_err_t led_driver_init(void);
  */
 esp_err_t led_driver_start(void);
 
+/**
+ * @brief Pace a renderer task from the driver's frame clock
+ *
+ * The task receives a task notification (take with ulTaskNotifyTake())
+ * lead_us before each transmit slot, so exactly one frame is rendered per
+ * frame sent. May be called before led_driver_start().
+ *
+ * @param task Renderer task, or NULL to stop notifications
+ * @param lead_us Render lead ahead of the slot, clamped to LED_FRAME_PERIOD_US
+ *                (a full period wakes the renderer on the previous slot)
+ * @return ESP_OK on success
+ *         ESP_ERR_INVALID_ARG if task is set and lead_us is 0
+ */
+esp_err_t led_driver_set_render_task(TaskHandle_t task, uint32_t lead_us);
+
+/**
+ * @brief Acquire a channel's back buffer for in-place rendering
+ *
+ * Returns a pointer into the next free render-ahead slot (leds_per_channel * 3
+ * bytes, internal RAM). The refresh task never reads it until
+ * led_driver_commit_frame() queues it. The contents are stale (an older
+ * frame) and must be fully overwritten. Wait-free; renderer task only.
+ *
+ * @param channel Channel to acquire (< led_driver_get_channel_count())
+ * @param out_buffer Receives the back buffer pointer
+ * @return ESP_OK on success
+ *         ESP_ERR_INVALID_ARG if out_buffer is NULL or channel invalid
+ *         ESP_ERR_INVALID_STATE if driver not initialized or already acquired
+ *         ESP_ERR_NO_MEM if LED_RENDER_AHEAD_FRAMES frames are already queued
+ */
+esp_err_t led_driver_acquire_frame(led_channel_t channel, uint8_t **out_buffer);
+
+/**
+ * @brief Commit an acquired back buffer for transmission
+ *
+ * Queues the back slot behind any frames already rendered ahead; the other
+ * channels and the output LUT repeat the last committed frame. The buffer
+ * must not be written
+ * after this call. Wait-free.
+ *
+ * @param channel Channel to commit
+ * @return ESP_OK on success
+ *         ESP_ERR_INVALID_ARG if channel invalid
+ *         ESP_ERR_INVALID_STATE if driver not initialized or not acquired
+ */
+esp_err_t led_driver_commit_frame(led_channel_t channel);
+
+/**
+ * @brief Acquire every channel's back buffer
+ *
+ * Also reports when the frame will be shown: the frame clock slot after
+ * everything already queued. Time-dependent effects should be rendered
+ * against this presentation time rather than the current time.
+ * Before led_driver_start() the presentation time is the current time.
+ *
+ * @param out_frame Receives the back buffers, layout and presentation time
+ * @return ESP_OK on success
+ *         ESP_ERR_INVALID_ARG if out_frame is NULL
+ *         ESP_ERR_INVALID_STATE if driver not initialized or a frame is already acquired
+ *         ESP_ERR_NO_MEM if LED_RENDER_AHEAD_FRAMES frames are already queued
+ */
+esp_err_t led_driver_acquire_frames(led_frame_t *out_frame);
+
+/**
+ * @brief Commit all channels so they are swapped on the same refresh
+ *
+ * Single atomic publish that queues every channel together.
+ *
+ * @return ESP_OK on success
+ *         ESP_ERR_INVALID_STATE if driver not initialized or the frame was not acquired
+ */
+esp_err_t led_driver_commit_frames(void);
+
+/**
+ * @brief Release an acquired frame without queueing it
+ *
+ * @return ESP_OK on success
+ *         ESP_ERR_INVALID_STATE if driver not initialized or nothing is acquired
+ */
+esp_err_t led_driver_cancel_frames(void);
+
 /**
  * @brief Submit frame data to a specific channel
  *
- * Copies GRB24 frame data to the back buffer of specified channel.
- * Channels operate independently - submit to each channel separately.
+ * Copies GRB24 frame data to the back slot of the specified channel; the
+ * other channels repeat their last committed frame.
+ * Prefer led_driver_acquire_frame()/led_driver_commit_frame() on the
+ * real-time path to avoid the copy.
  *
- * @param channel Channel to submit to (LED_CHANNEL_1 or LED_CHANNEL_2)
- * @param frame Pointer to GRB24 frame data (LED_FRAME_SIZE_CH bytes)
+ * @param channel Channel to submit to (< led_driver_get_channel_count())
+ * @param frame Pointer to GRB24 frame data (leds_per_channel * 3 bytes)
  * @return ESP_OK on success
  *         ESP_ERR_INVALID_ARG if frame is NULL or channel invalid
- *         ESP_ERR_INVALID_STATE if driver not initialized
+ *         ESP_ERR_INVALID_STATE if driver not initialized or a frame is acquired
+ *         ESP_ERR_NO_MEM if the render-ahead queue is full
  */
 esp_err_t led_driver_submit_frame(led_channel_t channel, const uint8_t *frame);
 
 /**
- * @brief Submit frames to both channels simultaneously
+ * @brief Submit frames to the first two channels simultaneously
  *
- * Convenience function to update both channels at once.
- * Both frames will be swapped together on next refresh.
+ * Convenience function to update Channels 1 and 2 at once; any further
+ * channels repeat their last committed frame. On a single-channel layout
+ * frame_ch2 is ignored. Both frames are queued together and shown on the
+ * same refresh.
  *
- * @param frame_ch1 Pointer to Channel 1 GRB24 data (480 bytes)
- * @param frame_ch2 Pointer to Channel 2 GRB24 data (480 bytes)
+ * @param frame_ch1 Pointer to Channel 1 GRB24 data (leds_per_channel * 3 bytes)
+ * @param frame_ch2 Pointer to Channel 2 GRB24 data (leds_per_channel * 3 bytes)
  * @return ESP_OK on success
  *         ESP_ERR_INVALID_ARG if either frame is NULL
- *         ESP_ERR_INVALID_STATE if driver not initialized
+ *         ESP_ERR_INVALID_STATE if driver not initialized or a frame is acquired
+ *         ESP_ERR_NO_MEM if the render-ahead queue is full
  */
 esp_err_t led_driver_submit_frames(const uint8_t *frame_ch1, const uint8_t *frame_ch2);
 
@@ -150,7 +350,8 @@ esp_err_t led_driver_get_stats(led_driver_stats_t *stats);
 /**
  * @brief Reset driver statistics
  *
- * Clears all counters and timing measurements for both channels.
+ * Clears all counters and timing measurements for all channels. While
+ * running, the clear is applied by the refresh task on its next frame.
  *
  * @return ESP_OK on success
  */
@@ -159,7 +360,7 @@ esp_err_t led_driver_reset_stats(void);
 /**
  * @brief Stop LED output transmission
  *
- * Stops refresh task and clears all LEDs on both channels.
+ * Stops refresh task and clears all LEDs on all channels.
  *
  * @return ESP_OK on success
  */
@@ -168,7 +369,7 @@ esp_err_t led_driver_stop(void);
 /**
  * @brief Deinitialize LED driver
  *
- * Releases all resources for both channels.
+ * Releases all channels and the render-ahead buffers.
  * Driver must be stopped before calling this.
  *
  * @return ESP_OK on success
@@ -176,6 +377,20 @@ esp_err_t led_driver_stop(void);
  */
 esp_err_t led_driver_deinit(void);
 
+/**
+ * @brief Run one refresh step at time now_us
+ *
+ * Takes the frame due for the clock slot at now_us and starts it on every
+ * channel, after waiting for the previous transmit to finish. The refresh
+ * task does this on each frame clock tick; calling it directly lets tests
+ * drive the scheduling with a mock backend and a synthetic clock.
+ *
+ * @param now_us Time on the esp_timer clock
+ * @return ESP_OK on success, or the backend's transmit error
+ *         ESP_ERR_INVALID_STATE if not initialized or the refresh task is running
+ */
+esp_err_t led_driver_refresh_once(int64_t now_us);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,78 @@
+/**
+ * @file led_hal.h
+ * @brief Output backend seam for the LED driver
+ *
+ * The LED driver owns frame scheduling and the render-ahead buffers; the
+ * backend only moves one channel's GRB bytes onto the wire. The default
+ * backend drives ESP32-S3 RMT TX channels (led_hal_rmt_ops). Tests install
+ * a mock through led_driver_config_t.hal to exercise the driver without
+ * hardware.
+ *
+ * All ops are called from the driver's refresh task, or from
+ * init/stop/deinit while the refresh task is not running.
+ */
+
+#ifndef PRISM_LED_HAL_H
+#define PRISM_LED_HAL_H
+
+#include "esp_err.h"
+#include "ws2812_symbols.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Per-channel setup passed to led_hal_ops_t.channel_init
+ */
+typedef struct {
+    uint8_t channel;            ///< Channel index (0-based)
+    uint8_t channel_count;      ///< Channels the driver is bringing up in total
+    int gpio;                   ///< Data output pin
+    uint16_t led_count;         ///< LEDs on this channel
+} led_hal_channel_config_t;
+
+/**
+ * Backend capabilities (led_hal_ops_t.caps)
+ */
+#define LED_HAL_CAP_OUTPUT_LUT  (1u << 0)   ///< transmit() applies an output LUT while encoding
+
+/**
+ * Backend operations. Every op receives the hal_ctx given in the driver
+ * config; per-channel ops also receive the handle returned by channel_init.
+ */
+typedef struct {
+    /** Claim and enable one output channel */
+    esp_err_t (*channel_init)(void *ctx, const led_hal_channel_config_t *config, void **out_handle);
+
+    /**
+     * Start sending len GRB bytes followed by the latch/reset gap. Must not
+     * block on the transfer: the driver starts every channel before waiting
+     * on any. The buffer (and lut) stay untouched until wait_done() returns.
+     * lut is only ever non-NULL on backends with LED_HAL_CAP_OUTPUT_LUT.
+     */
+    esp_err_t (*transmit)(void *ctx, void *handle, const uint8_t *grb, size_t len,
+                          const ws2812_output_lut_t *lut);
+
+    /** Wait for the channel's last transmit to finish (timeout_ms < 0: forever) */
+    esp_err_t (*wait_done)(void *ctx, void *handle, int32_t timeout_ms);
+
+    /** Disable and release a channel returned by channel_init */
+    void (*channel_deinit)(void *ctx, void *handle);
+
+    uint32_t caps;      ///< LED_HAL_CAP_* flags
+} led_hal_ops_t;
+
+/**
+ * RMT backend (WS2812B timing, 10MHz). hal_ctx is unused. Supports output
+ * LUTs when built with CONFIG_PRISM_LED_LUT_ENCODER.
+ */
+extern const led_hal_ops_t led_hal_rmt_ops;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PRISM_LED_HAL_H
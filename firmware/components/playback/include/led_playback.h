@@ -41,6 +41,23 @@ esp_err_t playback_init(void);
  */
 void playback_task(void *pvParameters);
 
+/**
+ * @brief Pattern loader task entry point
+ *
+ * Consumes load requests queued by the playback_load_* / playback_play_*
+ * calls: reads the pattern from storage, checks CRC, decodes frame 0 and
+ * publishes the result to playback_task, which swaps it in at the next frame
+ * boundary. Also frees patterns playback_task has replaced. Until this task
+ * runs, loads execute inline on the calling task.
+ *
+ * Stack: 6KB
+ * Priority: 4 (Medium-low)
+ * Core: 1 (keeps file I/O off the real-time core)
+ *
+ * @param pvParameters Task parameters (unused)
+ */
+void playback_loader_task(void *pvParameters);
+
 /**
  * @brief Deinitialize playback subsystem
  *
@@ -71,21 +88,101 @@ esp_err_t playback_play_builtin(uint16_t effect_id, const uint8_t* params, uint8
 /**
  * @brief Start playback of a packaged .prism pattern.
  *
+ * The blob is not copied: it must stay valid while the pattern plays (e.g.
+ * flash-resident or static data). Use playback_play_prism_borrowed() to be
+ * told when it can be freed.
+ *
  * @param pattern_id Identifier for logging/telemetry (null-terminated, already normalized)
- * @param blob Pointer to .prism file bytes
+ * @param blob Pointer to .prism file bytes (must outlive playback of the pattern)
  * @param blob_size Size of blob in bytes
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t playback_play_prism_blob(const char *pattern_id, const uint8_t *blob, size_t blob_size);
 
+/** Callback returning a borrowed blob to its owner (e.g. free, cache release). */
+typedef void (*playback_blob_release_fn)(void *ctx);
+
+/**
+ * @brief Release callback for blobs held by a pattern_cache handle (ctx).
+ *
+ * Patterns played with it keep their cache entry pinned in the ACTIVE slot
+ * while they play; other release callbacks leave the slot empty.
+ */
+void playback_release_cache_handle(void *ctx);
+
+/**
+ * @brief Start playback of a .prism blob without copying it.
+ *
+ * The decoder streams from `blob` for as long as the pattern plays. When the
+ * pattern is replaced or stopped, or if this call fails, playback calls
+ * release(release_ctx) exactly once.
+ *
+ * @param pattern_id Identifier for logging/telemetry
+ * @param blob Pointer to .prism file bytes (must stay valid until released)
+ * @param blob_size Size of blob in bytes
+ * @param release Release callback (may be NULL for static data)
+ * @param release_ctx Context passed to release
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t playback_play_prism_borrowed(const char *pattern_id, const uint8_t *blob, size_t blob_size,
+                                       playback_blob_release_fn release, void *release_ctx);
+
 /**
  * @brief Load a stored pattern from LittleFS and begin playback.
  *
+ * Blocks the caller until the loader has published the pattern; playback
+ * itself keeps running. Use playback_load_pattern_async() from tasks that
+ * must not wait on storage.
+ *
  * @param pattern_id Pattern identifier (normalized)
- * @return ESP_OK on success, ESP_ERR_NOT_FOUND if missing, error otherwise
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if missing,
+ *         ESP_ERR_INVALID_STATE if superseded by a later request, error otherwise
  */
 esp_err_t playback_play_pattern_from_storage(const char *pattern_id);
 
+/**
+ * @brief Load completion callback.
+ *
+ * Runs on the loader task once the pattern has been published to playback
+ * (result ESP_OK) or the load failed. Must not block for long.
+ */
+typedef void (*playback_load_cb_t)(esp_err_t result, const char *pattern_id, void *ctx);
+
+/**
+ * @brief Queue a stored pattern for loading without blocking.
+ *
+ * @param pattern_id Pattern identifier (normalized)
+ * @param done Completion callback (may be NULL); called exactly once if this returns ESP_OK
+ * @param ctx Context passed to done
+ * @return ESP_OK if queued, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM if the queue is full
+ */
+esp_err_t playback_load_pattern_async(const char *pattern_id, playback_load_cb_t done, void *ctx);
+
+/**
+ * @brief Load a stored pattern into the RAM cache and pin it as the next one.
+ *
+ * Blocks on storage if the pattern is not cached. The pin moves to the
+ * active slot when the pattern is played, and is dropped when another
+ * pattern is preloaded. NULL clears the next slot.
+ *
+ * @param pattern_id Pattern identifier (normalized), or NULL
+ * @return ESP_OK, ESP_ERR_NOT_FOUND, ESP_ERR_NO_MEM if the cache could not
+ *         hold it, or a storage error
+ */
+esp_err_t playback_preload_next(const char *pattern_id);
+
+/**
+ * @brief Queue a borrowed .prism blob for playback without blocking.
+ *
+ * Ownership rules match playback_play_prism_borrowed(): release runs exactly
+ * once, including when the request is rejected.
+ *
+ * @return ESP_OK if queued, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM if the queue is full
+ */
+esp_err_t playback_load_prism_async(const char *pattern_id, const uint8_t *blob, size_t blob_size,
+                                    playback_blob_release_fn release, void *release_ctx,
+                                    playback_load_cb_t done, void *ctx);
+
 /**
  * @brief Normalize a user-supplied pattern identifier.
  *
@@ -104,6 +201,43 @@ void playback_normalize_pattern_id(const char *input, char *output, size_t outpu
  */
 esp_err_t playback_stop(void);
 
+/**
+ * @brief Set the crossfade used when one .prism pattern replaces another.
+ *
+ * The outgoing and incoming patterns keep decoding side by side for the
+ * duration and are blended per LED. Switches to or from built-in effects,
+ * and stops, still cut immediately.
+ *
+ * @param duration_ms Fade length in ms (0 = hard cut, max 10000)
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if out of range
+ */
+esp_err_t playback_set_transition_ms(uint32_t duration_ms);
+
+/**
+ * @brief Enable temporal interpolation for low-FPS patterns.
+ *
+ * Patterns whose header fps is below LED_FPS_TARGET are rendered by blending
+ * frame k and k+1 by sub-frame phase instead of repeating frame k, at the
+ * cost of one source frame of latency. Takes effect from the next pattern
+ * load. Default comes from CONFIG_PRISM_INTERPOLATE_LOW_FPS.
+ *
+ * @param enable true to interpolate, false to repeat frames
+ */
+void playback_set_interpolation(bool enable);
+
+/**
+ * @brief Jump the playing .prism pattern to a frame.
+ *
+ * Applied by the playback task at the next frame boundary. Patterns carrying
+ * a keyframe seek index decode at most one keyframe interval; older files
+ * replay deltas from frame 0.
+ *
+ * @param frame Zero-based frame index (< frame_count)
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if no pattern is playing,
+ *         ESP_ERR_INVALID_ARG if frame is out of range
+ */
+esp_err_t playback_seek_frame(uint32_t frame);
+
 /**
  * @brief Query whether playback is active.
  * @return true if an effect is currently running
@@ -123,6 +257,16 @@ bool playback_is_running(void);
  */
 esp_err_t playback_set_brightness(uint8_t target, uint32_t duration_ms);
 
+/**
+ * @brief Set per-channel white balance gains (255 = unity).
+ *
+ * Folded into the compiled effect LUTs with gamma and brightness, so it adds
+ * no per-pixel work.
+ *
+ * @return ESP_OK
+ */
+esp_err_t playback_set_white_balance(uint8_t r_gain, uint8_t g_gain, uint8_t b_gain);
+
 // Profiling metrics accessors (available when CONFIG_PRISM_PROFILE_TEMPORAL=y)
 typedef struct {
     uint32_t samples;
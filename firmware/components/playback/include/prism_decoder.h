@@ -0,0 +1,163 @@
+/**
+ * @file prism_decoder.h
+ * @brief Streaming per-frame decoder for .prism payloads
+ *
+ * The decoder walks the payload section of a .prism blob (palette followed by
+ * [flags][len][segment] frame records) one frame at a time. It keeps only the
+ * palette, the previous index frame and a cursor into the blob, so memory use
+ * is constant and independent of pattern length. The blob is borrowed: the
+ * caller must keep it alive for as long as the decoder is in use.
+ *
+ * Random access uses the optional "seek_index" entry of the header extra-data
+ * JSON: {"interval": N, "offsets": [...]} lists the payload-relative byte
+ * offset of every Nth frame, each of which is encoded without
+ * PRISM_FLAG_DELTA. With an index a seek decodes at most N frames; without
+ * one it replays deltas from frame 0.
+ */
+
+#ifndef PRISM_DECODER_H
+#define PRISM_DECODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PRISM_DECODER_MAX_LEDS     300   // Longest LED driver channel (LED_MAX_LEDS_PER_CH)
+#define PRISM_DECODER_MAX_PALETTE  64
+
+#define PRISM_FLAG_DELTA           0x01
+#define PRISM_FLAG_RLE             0x02
+#define PRISM_RLE_MARK             0x80
+#define PRISM_RLE_MASK             0x7F
+
+#define PRISM_BLEND_ONE            256   // Blend weight selecting only the incoming/current frame
+
+typedef struct {
+    uint32_t interval;             // Frames between keyframes (0 = no index)
+    uint32_t count;                // Entries in offsets[]
+    const uint32_t *offsets;       // Payload-relative offset of keyframe k * interval
+} prism_seek_index_t;
+
+typedef struct {
+    const uint8_t *payload;        // Payload start (seek offsets are relative to this)
+    const uint8_t *frames_start;   // First frame record (after palette)
+    const uint8_t *cursor;         // Next frame record to decode
+    const uint8_t *end;            // End of payload (exclusive, CRC excluded)
+    uint32_t frame_count;
+    uint32_t frame_index;          // Index of the frame currently held in indices[]
+    uint32_t next_frame;           // Index the next prism_decoder_next() yields
+    uint16_t led_count;
+    uint16_t palette_count;
+    bool     frame_valid;          // indices[] holds a decoded frame
+    bool     keep_prev;            // Retain the previous frame for interpolation
+    bool     prev_valid;           // prev_indices[] holds frame_index - 1 (wrapping)
+    prism_seek_index_t seek;       // Borrowed keyframe table (interval 0 if absent)
+    uint8_t  palette_grb[PRISM_DECODER_MAX_PALETTE * 3];
+    uint8_t  indices[PRISM_DECODER_MAX_LEDS];
+    uint8_t  prev_indices[PRISM_DECODER_MAX_LEDS];
+} prism_decoder_t;
+
+/**
+ * Bind a decoder to a payload and load its palette.
+ *
+ * @param dec          Decoder state (caller-owned)
+ * @param payload      Start of payload (palette_count u16 LE)
+ * @param payload_len  Payload length in bytes, trailing CRC excluded
+ * @param frame_count  Frame count from the header
+ * @param led_count    LEDs per frame (<= PRISM_DECODER_MAX_LEDS)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG or ESP_ERR_INVALID_SIZE
+ */
+esp_err_t prism_decoder_init(prism_decoder_t *dec,
+                             const uint8_t *payload,
+                             size_t payload_len,
+                             uint32_t frame_count,
+                             uint16_t led_count);
+
+/**
+ * Decode the next frame into dec->indices, wrapping to frame 0 after the last
+ * frame. On error the decoder rewinds so the next call restarts at frame 0.
+ */
+esp_err_t prism_decoder_next(prism_decoder_t *dec);
+
+/** Rewind to before frame 0; the next prism_decoder_next() yields frame 0. */
+void prism_decoder_rewind(prism_decoder_t *dec);
+
+/**
+ * Attach a keyframe table. Every entry is checked to point at an in-bounds,
+ * non-delta frame record; on failure the decoder keeps linear seeking.
+ * The offsets array is borrowed and must outlive the decoder.
+ */
+esp_err_t prism_decoder_set_seek_index(prism_decoder_t *dec, const prism_seek_index_t *index);
+
+/**
+ * Position the decoder so dec->indices holds frame `frame`. Decodes at most
+ * one keyframe interval of frames when an index is attached.
+ */
+esp_err_t prism_decoder_seek(prism_decoder_t *dec, uint32_t frame);
+
+/**
+ * Parse the "seek_index" entry from header extra-data JSON.
+ * On success out->offsets is heap-allocated; release with prism_seek_index_free().
+ *
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if absent, ESP_ERR_INVALID_SIZE if malformed,
+ *         ESP_ERR_NO_MEM
+ */
+esp_err_t prism_seek_index_parse(const char *extra, size_t extra_len,
+                                 uint32_t frame_count, prism_seek_index_t *out);
+
+/** Free offsets allocated by prism_seek_index_parse() and zero the struct. */
+void prism_seek_index_free(prism_seek_index_t *index);
+
+/**
+ * Expand the current index frame through the palette into a GRB buffer of
+ * led_count * 3 bytes. Renders black if no frame has been decoded yet.
+ */
+void prism_decoder_expand_grb(const prism_decoder_t *dec, uint8_t *grb_out);
+
+/**
+ * Expand the current index frame through a caller-supplied GRB palette
+ * (palette_count entries, e.g. dec->palette_grb after effects) into one or
+ * two output buffers in a single pass. grb_out_b may be NULL.
+ */
+void prism_decoder_expand_palette(const prism_decoder_t *dec,
+                                  const uint8_t *palette_grb,
+                                  uint8_t *grb_out_a,
+                                  uint8_t *grb_out_b);
+
+/**
+ * Crossfade two decoders' current frames into one or two GRB buffers in a
+ * single pass: out = (from * (256 - weight) + to * weight) >> 8 per component.
+ * Each decoder is expanded through its own palette (e.g. after effects).
+ *
+ * @param weight 0 (all `from`) .. PRISM_BLEND_ONE (all `to`)
+ */
+void prism_decoder_expand_blend(const prism_decoder_t *from, const uint8_t *from_palette_grb,
+                                const prism_decoder_t *to, const uint8_t *to_palette_grb,
+                                uint16_t weight,
+                                uint8_t *grb_out_a,
+                                uint8_t *grb_out_b);
+
+/**
+ * Temporal interpolation: blend the previous and current index frames
+ * through one palette, out = (prev * (256 - weight) + cur * weight) >> 8.
+ * Requires dec->keep_prev set before decoding; falls back to the current
+ * frame right after init, a keyframe seek or when prev is unavailable.
+ *
+ * @param weight Sub-frame phase, 0 (previous) .. PRISM_BLEND_ONE (current)
+ */
+void prism_decoder_expand_interp(const prism_decoder_t *dec,
+                                 const uint8_t *palette_grb,
+                                 uint16_t weight,
+                                 uint8_t *grb_out_a,
+                                 uint8_t *grb_out_b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PRISM_DECODER_H
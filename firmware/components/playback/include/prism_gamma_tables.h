@@ -0,0 +1,29 @@
+/**
+ * @file prism_gamma_tables.h
+ * @brief Fixed-point log2/exp2 tables for integer gamma LUT generation
+ *
+ * out = 255 * (i / 255)^gamma is evaluated as 255 * 2^(-gamma * log2_q11[i]),
+ * splitting the exponent into an integer shift and a Q8 fraction looked up
+ * (with linear interpolation) in exp2_q15. Stays within +/-1 of powf().
+ */
+
+#ifndef PRISM_GAMMA_TABLES_H
+#define PRISM_GAMMA_TABLES_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PRISM_GAMMA_LOG2_FRAC_BITS 11
+#define PRISM_GAMMA_LOG2_ZERO      0xFFFF   // log2_q11[0]: input 0 always maps to 0
+
+extern const uint16_t prism_gamma_log2_q11[256];
+extern const uint16_t prism_gamma_exp2_q15[257];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PRISM_GAMMA_TABLES_H
@@ -0,0 +1,75 @@
+/**
+ * @file prism_history.h
+ * @brief CH1 frame history for time-shifted CH2 playback
+ *
+ * The temporal sync modes delay CH2 per LED. Rather than only gating LEDs
+ * on after their delay, CH2 LED i shows what CH1 LED i showed delay[i] ago:
+ * every rendered CH1 frame is pushed into a ring of palette-index frames
+ * (one byte per LED), and CH2 gathers each LED from the row its delay
+ * points back to. The ring is sized from the pattern's largest delay, so
+ * SYNC patterns allocate nothing.
+ */
+
+#ifndef PRISM_HISTORY_H
+#define PRISM_HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "prism_temporal_ctx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PRISM_HISTORY_MAX_DEPTH  120    // 1 s at 120 FPS (19.2KB at 160 LEDs)
+#define PRISM_HISTORY_BLANK      0xFF   // Index of a row never written: expands to black
+
+typedef struct {
+    uint8_t *frames;                        // depth rows of led_count indices (NULL: inactive)
+    uint16_t lag[PRISM_TEMPORAL_MAX_LEDS];  // Frames back each LED samples
+    uint16_t led_count;
+    uint16_t depth;                         // Rows: largest lag + 1
+    uint16_t head;                          // Row holding the newest frame
+    uint64_t frames_per_ms;                 // 32.32 fixed point, delay -> lag
+} prism_history_t;
+
+/**
+ * Size the ring for a compiled delay map, one row per frame period, deep
+ * enough for map->max_ms (so an animated WAVE fits at any phase).
+ * Delays round to the nearest frame and clamp to PRISM_HISTORY_MAX_DEPTH.
+ * Frees any previous ring; a map without delay leaves the history inactive.
+ * Every row starts blank, so LEDs stay dark until their delay has passed.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG or ESP_ERR_NO_MEM (history inactive)
+ */
+esp_err_t prism_history_init(prism_history_t *history, const prism_delay_map_t *map,
+                             uint32_t frame_period_us);
+
+/** Free the ring; the history becomes inactive */
+void prism_history_deinit(prism_history_t *history);
+
+/** True if CH2 should be gathered from the ring */
+static inline bool prism_history_active(const prism_history_t *history)
+{
+    return history->frames != NULL;
+}
+
+/** Re-read per-LED lags from a map whose delays moved (animated WAVE) */
+void prism_history_update_lags(prism_history_t *history, const prism_delay_map_t *map);
+
+/** Record one frame period of CH1 (led_count palette indices) */
+void prism_history_push(prism_history_t *history, const uint8_t *indices);
+
+/**
+ * Expand CH2 for led_count LEDs: each LED's delayed index through
+ * palette_grb (palette_count entries). Blank rows render black.
+ */
+void prism_history_expand(const prism_history_t *history, const uint8_t *palette_grb,
+                          uint16_t palette_count, uint8_t *grb_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PRISM_HISTORY_H
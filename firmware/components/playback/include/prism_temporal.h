@@ -21,7 +21,11 @@ void prism_build_progressive_ramp(uint16_t start_ms, uint16_t end_ms,
                                   uint16_t *table, size_t count);
 
 /**
- * @brief Apply motion direction mapping to a logical index
+ * @brief Position of LED index along the direction of propagation
+ *
+ * LEFT/STATIC: index. RIGHT: count-1-index. CENTER and EDGE fold the
+ * strip in half and return 0..(count-1)/2: CENTER counts outward from the
+ * middle LEDs, EDGE inward from both ends.
  */
 size_t prism_apply_motion_index(size_t index, size_t count, prism_motion_t direction);
 
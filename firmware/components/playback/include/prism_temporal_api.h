@@ -15,8 +15,19 @@ esp_err_t prism_motion_init(prism_temporal_ctx_t *ctx,
                              uint16_t *ch2_frame,
                              size_t led_count);
 
-// Calculate CH2 frame from CH1 using temporal context
-void calculate_ch2_frame(const prism_temporal_ctx_t *ctx,
+// Compile ctx's sync mode, motion direction and params (and delay_table for
+// CUSTOM, copied per LED; motion does not apply) into ctx->map for
+// led_count LEDs. Call when a pattern
+// loads; calculate_ch2_frame() recompiles by itself if the inputs change.
+esp_err_t prism_temporal_compile(prism_temporal_ctx_t *ctx, size_t led_count);
+
+// Move an animated WAVE map (wave_frequency_hz != 0) to ctx->frame_index:
+// the wave travels by a fixed phase step per frame. No-op for other maps.
+void prism_temporal_advance(prism_temporal_ctx_t *ctx);
+
+// Calculate CH2 frame from CH1 using temporal context: each LED is shown
+// once the frame time reaches its compiled delay, and is dark before
+void calculate_ch2_frame(prism_temporal_ctx_t *ctx,
                          const uint16_t *restrict ch1_frame,
                          uint16_t *restrict ch2_frame,
                          size_t led_count);
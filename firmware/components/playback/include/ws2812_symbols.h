@@ -0,0 +1,97 @@
+/**
+ * @file ws2812_symbols.h
+ * @brief Table-driven WS2812B byte to RMT symbol conversion
+ *
+ * Each GRB byte becomes 8 RMT symbols, MSB first. Rather than building
+ * them bit by bit in the encoder ISR, a 256-entry table holding the 8
+ * symbols of every byte value is generated once and copied out per byte.
+ *
+ * Symbols use the RMT symbol word layout (rmt_symbol_word_t.val):
+ * duration0 in bits 0-14, level0 in bit 15, duration1 in bits 16-30 and
+ * level1 in bit 31. Everything here is plain C with no driver dependency,
+ * so the generated stream can be checked bit-exactly on the host.
+ */
+
+#ifndef PRISM_WS2812_SYMBOLS_H
+#define PRISM_WS2812_SYMBOLS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WS2812_SYMBOLS_PER_BYTE 8
+
+/**
+ * Bit timing in RMT ticks
+ */
+typedef struct {
+    uint16_t t0h;       ///< High time of a 0 bit
+    uint16_t t0l;       ///< Low time of a 0 bit
+    uint16_t t1h;       ///< High time of a 1 bit
+    uint16_t t1l;       ///< Low time of a 1 bit
+    uint16_t reset;     ///< Low time of each half of the reset symbol
+} ws2812_timing_t;
+
+/**
+ * Proven Emotiscope timing at 10MHz: 0.4/0.6us, 0.7/0.6us, 2 x 25us reset
+ */
+#define WS2812_TIMING_10MHZ { .t0h = 4, .t0l = 6, .t1h = 7, .t1l = 6, .reset = 250 }
+
+/**
+ * Byte value -> its 8 symbols, MSB first (8KB)
+ */
+typedef struct {
+    uint32_t symbols[256][WS2812_SYMBOLS_PER_BYTE];
+} ws2812_symbol_table_t;
+
+/**
+ * Output transform applied while encoding: one table per byte position of
+ * a GRB triplet (component[0] for G, [1] for R, [2] for B)
+ */
+typedef struct {
+    uint8_t component[3][256];
+} ws2812_output_lut_t;
+
+/** Pack one RMT symbol word */
+static inline uint32_t ws2812_symbol(uint16_t duration0, bool level0, uint16_t duration1, bool level1)
+{
+    return (uint32_t)(duration0 & 0x7FFF) | ((uint32_t)level0 << 15) |
+           ((uint32_t)(duration1 & 0x7FFF) << 16) | ((uint32_t)level1 << 31);
+}
+
+/** Symbol for a single data bit */
+uint32_t ws2812_bit_symbol(const ws2812_timing_t *timing, bool bit);
+
+/** Reset (latch) symbol: both halves low */
+uint32_t ws2812_reset_symbol(const ws2812_timing_t *timing);
+
+/** Fill the byte -> symbols table for a timing */
+void ws2812_symbol_table_build(ws2812_symbol_table_t *table, const ws2812_timing_t *timing);
+
+/** Fill an output transform that sends every byte unchanged */
+void ws2812_output_lut_identity(ws2812_output_lut_t *lut);
+
+/**
+ * Convert as many whole bytes of data[pos..len) as fit in dst_symbols
+ * symbols. Called repeatedly with the free space of RMT memory, this
+ * refills it chunk by chunk (ping-pong) without per-bit work.
+ *
+ * @param lut  Optional output transform, indexed by byte position mod 3
+ *             within data; NULL sends bytes unchanged
+ * @param pos  First byte to encode (data is the start of the frame)
+ * @return Bytes consumed (dst receives 8 symbols per byte)
+ */
+size_t ws2812_encode_bytes(const ws2812_symbol_table_t *table,
+                           const ws2812_output_lut_t *lut,
+                           const uint8_t *data, size_t pos, size_t len,
+                           uint32_t *dst, size_t dst_symbols);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PRISM_WS2812_SYMBOLS_H
@@ -1,59 +1,46 @@
 /**
  * @file led_driver.c
- * @brief Dual-channel RMT LED driver implementation
+ * @brief N-channel LED driver implementation
  *
  * Task 8: Complete dual-channel LED driver based on proven Emotiscope patterns
- * Implements all 5 subtasks with battle-tested ESP32-S3 code
+ * Implements all 5 subtasks with battle-tested ESP32-S3 code. The channel
+ * layout is runtime configuration; the wire protocol lives behind led_hal.h.
  */
 
 #include "led_driver.h"
 #include "esp_log.h"
 #include "esp_check.h"
-#include "driver/rmt_tx.h"
-#include "driver/rmt_encoder.h"
+#include "esp_heap_caps.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
 #include "esp_timer.h"
 #include <string.h>
 
 static const char *TAG = "led_driver";
 
 /**
- * WS2812B Timing Configuration
- * PROVEN VALUES from Emotiscope - DO NOT MODIFY without hardware verification
+ * Render-ahead queue (Subtask 8.2/8.3)
  *
- * At 10MHz (0.1us ticks):
- * bit0: {duration0=4 ticks (0.4us high), level0=1, duration1=6 ticks (0.6us low), level1=0}
- * bit1: {duration0=7 ticks (0.7us high), level0=1, duration1=6 ticks (0.6us low), level1=0}
- * reset: {duration0=250 ticks (25us low), level0=0, duration1=250 ticks (25us low), level1=0}
- */
-
-/**
- * Subtask 8.1: WS2812B Encoder (Emotiscope-proven pattern)
+ * Single-producer/single-consumer ring of frame slots, each holding every
+ * channel so they always swap together. Slot head % N is being filled by
+ * the renderer (back), slots tail..head-1 are queued frames and the refresh
+ * task transmits the slot it consumed last (front). The renderer may run up
+ * to LED_RENDER_AHEAD_FRAMES ahead; head and tail are each written by one
+ * side only, so neither side ever waits.
+ *
+ * Slot pixel data is one allocation sized from the configured layout:
+ * slot s, channel c starts at frames + (s * channel_count + c) * frame_bytes.
  */
-typedef struct {
-    rmt_encoder_t base;
-    rmt_encoder_t *bytes_encoder;
-    rmt_encoder_t *copy_encoder;
-    int state;
-    rmt_symbol_word_t reset_code;
-} rmt_led_strip_encoder_t;
+#define LED_QUEUE_SLOTS     (LED_RENDER_AHEAD_FRAMES + 2)
 
 /**
- * Channel State (Subtask 8.2: Double buffers per channel)
+ * Channel State
  */
 typedef struct {
-    // RMT hardware (Subtask 8.1)
-    rmt_channel_handle_t rmt_channel;
-    rmt_encoder_handle_t encoder;
-
-    // Double buffers - static allocation (Emotiscope pattern)
-    uint8_t front_buffer[LED_FRAME_SIZE_CH];  // Currently transmitting (GRB order!)
-    uint8_t back_buffer[LED_FRAME_SIZE_CH];   // Being filled by effects engine
-    bool back_buffer_ready;
+    // Output backend handle (Subtask 8.1)
+    void *hal_handle;
 
-    // Statistics (Subtask 8.5)
+    // Statistics (Subtask 8.5) - written by the refresh task only, via atomics
     led_channel_stats_t stats;
 } led_channel_state_t;
 
@@ -61,14 +48,45 @@ typedef struct {
  * Driver State (Subtask 8.4: Timing and synchronization)
  */
 typedef struct {
-    led_channel_state_t channels[LED_CHANNEL_COUNT];
-
-    // Synchronization (Subtask 8.4)
-    SemaphoreHandle_t state_mutex;
+    led_channel_state_t channels[LED_MAX_CHANNELS];
+
+    // Layout (fixed between init and deinit)
+    uint8_t channel_count;
+    uint16_t leds_per_channel;
+    size_t frame_bytes;                 // Per channel: leds_per_channel * 3
+    const led_hal_ops_t *hal;
+    void *hal_ctx;
+
+    // Render-ahead queue - allocated once at init, swapped by index
+    uint8_t *frames;                    // GRB order!
+    ws2812_output_lut_t *luts;          // One per slot with config.output_lut, else NULL
+    int64_t present_slot[LED_QUEUE_SLOTS];  // Frame clock slot each was rendered for
+    uint32_t head;              // Atomic; renderer writes: next slot to fill
+    uint32_t tail;              // Atomic; refresh task writes: next slot to show
+    uint32_t front;             // Refresh task only: slot being transmitted
+    uint8_t acquired_mask;      // Renderer only: channels acquired in back
+    int64_t last_present_slot;  // Renderer only: slot of the last committed frame
+    bool starved;               // Refresh task only: queue ran dry last slot
+
+    // Timing (Subtask 8.4) - the frame timer is the single frame clock
     esp_timer_handle_t frame_timer;
-
-    // Global stats
+    esp_timer_handle_t render_timer;    // One-shot: wakes the renderer lead_us early
+    TaskHandle_t render_task;
+    uint32_t render_lead_us;
+    int64_t clock_epoch_us;             // Slot n is due at epoch + n * period
+    int64_t last_slot;                  // Refresh task only
+    bool transmit_pending;              // Refresh task only: channels are shifting out
+
+    // Global stats (atomic)
     uint32_t total_buffer_swaps;
+    uint32_t frames_dropped;
+    uint32_t frames_duplicated;
+    uint32_t frames_skipped;
+    uint32_t queue_underruns;
+    uint32_t jitter_max_us;
+    uint32_t jitter_avg_us;
+    uint32_t jitter_samples;            // Refresh task only
+    bool stats_reset_pending;
 
     // State flags
     bool initialized;
@@ -77,140 +95,167 @@ typedef struct {
 
 static led_driver_state_t s_driver = {0};
 
-// RMT TX configuration (shared by both channels)
-static rmt_transmit_config_t s_tx_config = {
-    .loop_count = 0,  // No transfer loop
-    .flags = {
-        .eot_level = 0,
-        .queue_nonblocking = 0,
-    },
-};
+static inline uint8_t *slot_channel(uint32_t slot, uint8_t channel)
+{
+    return s_driver.frames + ((size_t)slot * s_driver.channel_count + channel) * s_driver.frame_bytes;
+}
+
+static inline ws2812_output_lut_t *slot_lut(uint32_t slot)
+{
+    return (s_driver.luts != NULL) ? &s_driver.luts[slot] : NULL;
+}
+
+static inline uint8_t all_channels_mask(void)
+{
+    return (uint8_t)((1u << s_driver.channel_count) - 1u);
+}
 
 /**
- * SUBTASK 8.1: WS2812B Encoder Implementation
- * IRAM_ATTR for performance (Emotiscope pattern)
+ * Zero all statistics. Called by the refresh task (the only stats writer)
+ * or while it is not running.
  */
-IRAM_ATTR static size_t rmt_encode_led_strip(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
-                                               const void *primary_data, size_t data_size,
-                                               rmt_encode_state_t *ret_state)
-{
-    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_encoder_handle_t bytes_encoder = led_encoder->bytes_encoder;
-    rmt_encoder_handle_t copy_encoder = led_encoder->copy_encoder;
-    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
-    rmt_encode_state_t state = RMT_ENCODING_RESET;
-    size_t encoded_symbols = 0;
-
-    switch (led_encoder->state) {
-    case 0: // Send GRB data
-        encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, primary_data, data_size, &session_state);
-        if (session_state & RMT_ENCODING_COMPLETE) {
-            led_encoder->state = 1; // Move to reset phase
-        }
-        if (session_state & RMT_ENCODING_MEM_FULL) {
-            state = (rmt_encode_state_t)(state | (uint32_t)RMT_ENCODING_MEM_FULL);
-            goto out;
-        }
-        // fall-through
-    case 1: // Send reset code
-        encoded_symbols += copy_encoder->encode(copy_encoder, channel, &led_encoder->reset_code,
-                                                 sizeof(led_encoder->reset_code), &session_state);
-        if (session_state & RMT_ENCODING_COMPLETE) {
-            led_encoder->state = RMT_ENCODING_RESET;
-            state = (rmt_encode_state_t)(state | (uint32_t)RMT_ENCODING_COMPLETE);
-        }
-        if (session_state & RMT_ENCODING_MEM_FULL) {
-            state = (rmt_encode_state_t)(state | (uint32_t)RMT_ENCODING_MEM_FULL);
-            goto out;
-        }
+static void stats_clear(void)
+{
+    for (int ch = 0; ch < LED_MAX_CHANNELS; ch++) {
+        led_channel_stats_t *stats = &s_driver.channels[ch].stats;
+        __atomic_store_n(&stats->frames_transmitted, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&stats->underruns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&stats->max_frame_time_us, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&stats->avg_frame_time_us, 0, __ATOMIC_RELAXED);
     }
-out:
-    *ret_state = state;
-    return encoded_symbols;
+    __atomic_store_n(&s_driver.total_buffer_swaps, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_driver.frames_dropped, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_driver.frames_duplicated, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_driver.frames_skipped, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_driver.queue_underruns, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_driver.jitter_max_us, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_driver.jitter_avg_us, 0, __ATOMIC_RELAXED);
+    s_driver.jitter_samples = 0;
 }
 
-static esp_err_t rmt_del_led_strip_encoder(rmt_encoder_t *encoder)
+/**
+ * Place a refresh wake-up on the frame clock: count whole slots missed since
+ * the previous transmit and track how far off its slot this one landed.
+ */
+static int64_t clock_record_slot(int64_t now_us)
 {
-    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_del_encoder(led_encoder->bytes_encoder);
-    rmt_del_encoder(led_encoder->copy_encoder);
-    free(led_encoder);
-    return ESP_OK;
+    int64_t since_epoch = now_us - s_driver.clock_epoch_us;
+    int64_t slot = (since_epoch + LED_FRAME_PERIOD_US / 2) / LED_FRAME_PERIOD_US;
+    int64_t offset = since_epoch - slot * LED_FRAME_PERIOD_US;
+    uint32_t jitter = (uint32_t)(offset < 0 ? -offset : offset);
+
+    if (s_driver.jitter_samples > 0 && slot > s_driver.last_slot + 1) {
+        __atomic_store_n(&s_driver.frames_skipped,
+                         s_driver.frames_skipped + (uint32_t)(slot - s_driver.last_slot - 1),
+                         __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&s_driver.last_slot, slot, __ATOMIC_RELEASE);
+
+    if (jitter > s_driver.jitter_max_us) {
+        __atomic_store_n(&s_driver.jitter_max_us, jitter, __ATOMIC_RELAXED);
+    }
+    uint32_t n = ++s_driver.jitter_samples;
+    uint32_t avg = (uint32_t)(((uint64_t)s_driver.jitter_avg_us * (n - 1) + jitter) / n);
+    __atomic_store_n(&s_driver.jitter_avg_us, avg, __ATOMIC_RELAXED);
+    return slot;
 }
 
-static esp_err_t rmt_led_strip_encoder_reset(rmt_encoder_t *encoder)
+/**
+ * Refresh task: pick the queued frame for `slot`. Frames whose slot has
+ * already passed (the refresh task stalled) are dropped to get back in step,
+ * keeping the newest so something fresh is always shown.
+ */
+static void queue_consume(int64_t slot)
 {
-    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_encoder_reset(led_encoder->bytes_encoder);
-    rmt_encoder_reset(led_encoder->copy_encoder);
-    led_encoder->state = RMT_ENCODING_RESET;
-    return ESP_OK;
+    uint32_t head = __atomic_load_n(&s_driver.head, __ATOMIC_ACQUIRE);
+    uint32_t tail = s_driver.tail;
+
+    while (head - tail > 1 && s_driver.present_slot[tail % LED_QUEUE_SLOTS] < slot) {
+        tail++;
+        __atomic_store_n(&s_driver.frames_dropped, s_driver.frames_dropped + 1, __ATOMIC_RELAXED);
+    }
+
+    if (head != tail) {
+        s_driver.front = tail % LED_QUEUE_SLOTS;
+        __atomic_store_n(&s_driver.tail, tail + 1, __ATOMIC_RELEASE);
+        __atomic_fetch_add(&s_driver.total_buffer_swaps, 1, __ATOMIC_RELAXED);
+        s_driver.starved = false;
+        return;
+    }
+
+    // Nothing queued for this slot: the previous frame repeats
+    __atomic_store_n(&s_driver.frames_duplicated, s_driver.frames_duplicated + 1, __ATOMIC_RELAXED);
+    if (!s_driver.starved && s_driver.total_buffer_swaps > 0) {
+        // Frames were flowing and the renderer fell behind
+        __atomic_store_n(&s_driver.queue_underruns, s_driver.queue_underruns + 1, __ATOMIC_RELAXED);
+    }
+    s_driver.starved = true;
 }
 
 /**
- * Subtask 8.1: Create WS2812B encoder with PROVEN timing
+ * SUBTASK 8.4: One refresh step - wait out the previous transmit, take the
+ * frame due for the slot at now_us and start it on every channel
  */
-static esp_err_t rmt_new_led_strip_encoder(rmt_encoder_handle_t *ret_encoder)
+IRAM_ATTR static esp_err_t refresh_frame(int64_t now_us)
 {
-    esp_err_t ret = ESP_OK;
-    rmt_led_strip_encoder_t *led_encoder = NULL;
-
-    ESP_GOTO_ON_FALSE(ret_encoder, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
-
-    led_encoder = calloc(1, sizeof(rmt_led_strip_encoder_t));
-    ESP_GOTO_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip encoder");
-
-    led_encoder->base.encode = rmt_encode_led_strip;
-    led_encoder->base.del = rmt_del_led_strip_encoder;
-    led_encoder->base.reset = rmt_led_strip_encoder_reset;
-
-    // PROVEN WS2812B timing from Emotiscope (10MHz resolution)
-    // DO NOT MODIFY without hardware testing
-    rmt_bytes_encoder_config_t bytes_encoder_config = {
-        .bit0 = {
-            .level0 = 1,
-            .duration0 = 4,  // 0.4us high
-            .level1 = 0,
-            .duration1 = 6,  // 0.6us low
-        },
-        .bit1 = {
-            .level0 = 1,
-            .duration0 = 7,  // 0.7us high
-            .level1 = 0,
-            .duration1 = 6,  // 0.6us low
-        },
-        .flags.msb_first = 1,
-    };
-    ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, &led_encoder->bytes_encoder),
-                      err, TAG, "create bytes encoder failed");
-
-    // Copy encoder for reset code
-    rmt_copy_encoder_config_t copy_encoder_config = {};
-    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &led_encoder->copy_encoder),
-                      err, TAG, "create copy encoder failed");
-
-    // Reset code: >50us low (WS2812B spec)
-    led_encoder->reset_code = (rmt_symbol_word_t){
-        .level0 = 0,
-        .duration0 = 250,  // 25us
-        .level1 = 0,
-        .duration1 = 250,  // 25us (total 50us)
-    };
+    int64_t frame_start_us = esp_timer_get_time();
+    if (__atomic_exchange_n(&s_driver.stats_reset_pending, false, __ATOMIC_ACQ_REL)) {
+        stats_clear();
+    }
+    int64_t slot = clock_record_slot(now_us);
 
-    *ret_encoder = &led_encoder->base;
-    return ESP_OK;
+    // Wait for previous frame transmission to complete on every channel
+    if (s_driver.transmit_pending) {
+        for (uint8_t ch = 0; ch < s_driver.channel_count; ch++) {
+            s_driver.hal->wait_done(s_driver.hal_ctx, s_driver.channels[ch].hal_handle, -1);  // Infinite wait
+        }
+        s_driver.transmit_pending = false;
+    }
 
-err:
-    if (led_encoder) {
-        if (led_encoder->bytes_encoder) {
-            rmt_del_encoder(led_encoder->bytes_encoder);
+    // Take the next queued frame (Subtask 8.3); the old front is free
+    // for the renderer once tail moves past it
+    queue_consume(slot);
+
+    // Start every channel before waiting on any, so they shift out in
+    // parallel (asynchronous) - Subtask 8.4
+    for (uint8_t ch = 0; ch < s_driver.channel_count; ch++) {
+        esp_err_t ret = s_driver.hal->transmit(s_driver.hal_ctx, s_driver.channels[ch].hal_handle,
+                                               slot_channel(s_driver.front, ch), s_driver.frame_bytes,
+                                               slot_lut(s_driver.front));
+        if (ret != ESP_OK) {
+            return ret;
         }
-        if (led_encoder->copy_encoder) {
-            rmt_del_encoder(led_encoder->copy_encoder);
+        s_driver.transmit_pending = true;
+    }
+
+    // Update statistics (Subtask 8.5)
+    uint64_t frame_time_us = (uint64_t)(esp_timer_get_time() - frame_start_us);
+
+    for (uint8_t ch = 0; ch < s_driver.channel_count; ch++) {
+        led_channel_stats_t *stats = &s_driver.channels[ch].stats;
+        // Single writer: plain reads, atomic stores for concurrent readers
+        uint32_t frames = stats->frames_transmitted + 1;
+        __atomic_store_n(&stats->frames_transmitted, frames, __ATOMIC_RELAXED);
+
+        if (frame_time_us > LED_FRAME_PERIOD_US) {
+            __atomic_store_n(&stats->underruns, stats->underruns + 1, __ATOMIC_RELAXED);
         }
-        free(led_encoder);
+
+        if (frame_time_us > stats->max_frame_time_us) {
+            __atomic_store_n(&stats->max_frame_time_us, (uint32_t)frame_time_us, __ATOMIC_RELAXED);
+        }
+
+        // Running average
+        uint32_t avg = (uint32_t)(((uint64_t)stats->avg_frame_time_us * (frames - 1) + frame_time_us)
+                                  / frames);
+        __atomic_store_n(&stats->avg_frame_time_us, avg, __ATOMIC_RELAXED);
     }
-    return ret;
+
+    // Log underruns (Subtask 8.5)
+    if (frame_time_us > LED_FRAME_PERIOD_US) {
+        ESP_LOGW(TAG, "Frame underrun: %llu us (target: %d us)", frame_time_us, LED_FRAME_PERIOD_US);
+    }
+    return ESP_OK;
 }
 
 /**
@@ -224,12 +269,38 @@ static void frame_timer_callback(void *arg)
     BaseType_t higher_priority_task_woken = pdFALSE;
     TaskHandle_t *refresh_task_handle = (TaskHandle_t *)arg;
     vTaskNotifyGiveFromISR(*refresh_task_handle, &higher_priority_task_woken);
+
+    // Wake the renderer lead_us before the next slot, so it renders exactly
+    // one frame per transmit on the same clock
+    TaskHandle_t render_task = s_driver.render_task;
+    if (render_task != NULL) {
+        uint32_t lead_us = s_driver.render_lead_us;
+        if (lead_us >= LED_FRAME_PERIOD_US) {
+            vTaskNotifyGiveFromISR(render_task, &higher_priority_task_woken);
+        } else {
+            (void)esp_timer_start_once(s_driver.render_timer, LED_FRAME_PERIOD_US - lead_us);
+        }
+    }
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+/**
+ * Render Timer Callback: fires lead_us before a transmit slot
+ */
+static void render_timer_callback(void *arg)
+{
+    (void)arg;
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    TaskHandle_t render_task = s_driver.render_task;
+    if (render_task != NULL) {
+        vTaskNotifyGiveFromISR(render_task, &higher_priority_task_woken);
+    }
     portYIELD_FROM_ISR(higher_priority_task_woken);
 }
 
 /**
  * SUBTASK 8.4: LED Refresh Task
- * Asynchronously transmits frames to both channels at target FPS
+ * Asynchronously transmits frames to all channels at target FPS
  * IRAM_ATTR for performance
  */
 IRAM_ATTR static void led_refresh_task(void *arg)
@@ -237,7 +308,7 @@ IRAM_ATTR static void led_refresh_task(void *arg)
     ESP_LOGI(TAG, "LED refresh task started on core %d", xPortGetCoreID());
 
     while (s_driver.running) {
-        // Wait for frame timer signal (Subtask 8.4) - cadence per LED_FRAME_TIME_MS
+        // Wait for frame timer signal (Subtask 8.4) - cadence per LED_FRAME_PERIOD_US
         uint32_t notification_value = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LED_FRAME_TIME_MS * 2));
 
         if (notification_value == 0) {
@@ -245,157 +316,155 @@ IRAM_ATTR static void led_refresh_task(void *arg)
             continue;
         }
 
-        uint64_t frame_start_us = esp_timer_get_time();
-
-        // Wait for previous frame transmission to complete on both channels
-        rmt_tx_wait_all_done(s_driver.channels[LED_CHANNEL_1].rmt_channel, -1);  // Infinite wait
-        rmt_tx_wait_all_done(s_driver.channels[LED_CHANNEL_2].rmt_channel, -1);
-
-        // Swap buffers if new frames are ready (Subtask 8.3)
-        xSemaphoreTake(s_driver.state_mutex, portMAX_DELAY);
-
-        for (int ch = 0; ch < LED_CHANNEL_COUNT; ch++) {
-            led_channel_state_t *channel = &s_driver.channels[ch];
-            if (channel->back_buffer_ready) {
-                // Atomic swap
-                uint8_t temp[LED_FRAME_SIZE_CH];
-                memcpy(temp, channel->front_buffer, LED_FRAME_SIZE_CH);
-                memcpy(channel->front_buffer, channel->back_buffer, LED_FRAME_SIZE_CH);
-                memcpy(channel->back_buffer, temp, LED_FRAME_SIZE_CH);
-                channel->back_buffer_ready = false;
-                s_driver.total_buffer_swaps++;
-            }
-        }
-
-        xSemaphoreGive(s_driver.state_mutex);
-
-        // Transmit both channels in parallel (asynchronous) - Subtask 8.4
-        ESP_ERROR_CHECK(rmt_transmit(s_driver.channels[LED_CHANNEL_1].rmt_channel,
-                                     s_driver.channels[LED_CHANNEL_1].encoder,
-                                     s_driver.channels[LED_CHANNEL_1].front_buffer,
-                                     LED_FRAME_SIZE_CH,
-                                     &s_tx_config));
-
-        ESP_ERROR_CHECK(rmt_transmit(s_driver.channels[LED_CHANNEL_2].rmt_channel,
-                                     s_driver.channels[LED_CHANNEL_2].encoder,
-                                     s_driver.channels[LED_CHANNEL_2].front_buffer,
-                                     LED_FRAME_SIZE_CH,
-                                     &s_tx_config));
-
-        // Update statistics (Subtask 8.5)
-        uint64_t frame_time_us = esp_timer_get_time() - frame_start_us;
-
-        xSemaphoreTake(s_driver.state_mutex, portMAX_DELAY);
-
-        for (int ch = 0; ch < LED_CHANNEL_COUNT; ch++) {
-            led_channel_stats_t *stats = &s_driver.channels[ch].stats;
-            stats->frames_transmitted++;
-
-            if (frame_time_us > LED_FRAME_TIME_MS * 1000) {
-                stats->underruns++;
-            }
-
-            if (frame_time_us > stats->max_frame_time_us) {
-                stats->max_frame_time_us = (uint32_t)frame_time_us;
-            }
-
-            // Running average
-            if (stats->frames_transmitted > 0) {
-                stats->avg_frame_time_us =
-                    (stats->avg_frame_time_us * (stats->frames_transmitted - 1) + frame_time_us)
-                    / stats->frames_transmitted;
-            }
-        }
-
-        xSemaphoreGive(s_driver.state_mutex);
-
-        // Log underruns (Subtask 8.5)
-        if (frame_time_us > LED_FRAME_TIME_MS * 1000) {
-            ESP_LOGW(TAG, "Frame underrun: %llu us (target: %d ms)", frame_time_us, LED_FRAME_TIME_MS);
-        }
+        ESP_ERROR_CHECK(refresh_frame(esp_timer_get_time()));
     }
 
     ESP_LOGI(TAG, "LED refresh task exiting");
     vTaskDelete(NULL);
 }
 
+static void release_channels(void)
+{
+    for (int ch = 0; ch < LED_MAX_CHANNELS; ch++) {
+        led_channel_state_t *channel = &s_driver.channels[ch];
+        if (channel->hal_handle) {
+            s_driver.hal->channel_deinit(s_driver.hal_ctx, channel->hal_handle);
+            channel->hal_handle = NULL;
+        }
+    }
+    heap_caps_free(s_driver.frames);
+    s_driver.frames = NULL;
+    heap_caps_free(s_driver.luts);
+    s_driver.luts = NULL;
+}
+
 /**
- * SUBTASK 8.1 & 8.2: Initialize Dual-Channel LED Driver
+ * SUBTASK 8.1 & 8.2: Initialize LED Driver
  */
-esp_err_t led_driver_init(void)
+esp_err_t led_driver_init_with_config(const led_driver_config_t *config)
 {
     if (s_driver.initialized) {
         ESP_LOGW(TAG, "LED driver already initialized");
         return ESP_ERR_INVALID_STATE;
     }
 
-    ESP_LOGI(TAG, "Initializing dual-channel LED driver:");
-    ESP_LOGI(TAG, "  Channel 1: GPIO %d → %d LEDs", LED_GPIO_CH1, LED_COUNT_PER_CH);
-    ESP_LOGI(TAG, "  Channel 2: GPIO %d → %d LEDs", LED_GPIO_CH2, LED_COUNT_PER_CH);
-    ESP_LOGI(TAG, "  Total: %d LEDs @ %d FPS", LED_TOTAL_COUNT, LED_FPS_TARGET);
+    if (config == NULL ||
+        config->channel_count == 0 || config->channel_count > LED_MAX_CHANNELS ||
+        config->leds_per_channel == 0 || config->leds_per_channel > LED_MAX_LEDS_PER_CH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const led_hal_ops_t *hal = (config->hal != NULL) ? config->hal : &led_hal_rmt_ops;
+    if (!hal->channel_init || !hal->transmit || !hal->wait_done || !hal->channel_deinit) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->output_lut && !(hal->caps & LED_HAL_CAP_OUTPUT_LUT)) {
+        ESP_LOGE(TAG, "Output LUT requested but the backend cannot apply one");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
 
-    // Subtask 8.4: Create synchronization primitives
-    s_driver.state_mutex = xSemaphoreCreateMutex();
-    if (!s_driver.state_mutex) {
-        ESP_LOGE(TAG, "Failed to create state mutex");
-        return ESP_ERR_NO_MEM;
+    s_driver.channel_count = config->channel_count;
+    s_driver.leds_per_channel = config->leds_per_channel;
+    s_driver.frame_bytes = (size_t)config->leds_per_channel * LED_BYTES_PER_LED;
+    s_driver.hal = hal;
+    s_driver.hal_ctx = config->hal_ctx;
+
+    ESP_LOGI(TAG, "Initializing %u-channel LED driver:", (unsigned)s_driver.channel_count);
+    for (uint8_t ch = 0; ch < s_driver.channel_count; ch++) {
+        ESP_LOGI(TAG, "  Channel %u: GPIO %d → %u LEDs", (unsigned)(ch + 1), config->gpio[ch],
+                 (unsigned)s_driver.leds_per_channel);
+    }
+    ESP_LOGI(TAG, "  Total: %u LEDs @ %d FPS",
+             (unsigned)(s_driver.channel_count * s_driver.leds_per_channel), LED_FPS_TARGET);
+    if (LED_WIRE_TIME_US(s_driver.leds_per_channel) > LED_FRAME_PERIOD_US) {
+        ESP_LOGW(TAG, "%u LEDs take %lu us on the wire, longer than the %d us frame period",
+                 (unsigned)s_driver.leds_per_channel,
+                 (unsigned long)LED_WIRE_TIME_US(s_driver.leds_per_channel), LED_FRAME_PERIOD_US);
     }
 
-    // Subtask 8.1: Configure both RMT channels with PROVEN settings
-    const gpio_num_t channel_gpios[LED_CHANNEL_COUNT] = {LED_GPIO_CH1, LED_GPIO_CH2};
+    // Subtask 8.2: Render-ahead queue, sized for this layout and allocated once
+    size_t slots_bytes = (size_t)LED_QUEUE_SLOTS * s_driver.channel_count * s_driver.frame_bytes;
+    s_driver.frames = heap_caps_calloc(1, slots_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (s_driver.frames == NULL) {
+        ESP_LOGE(TAG, "No memory for %u byte frame queue", (unsigned)slots_bytes);
+        return ESP_ERR_NO_MEM;
+    }
+    if (config->output_lut) {
+        // Each slot keeps the colour transform it was rendered with
+        s_driver.luts = heap_caps_malloc(LED_QUEUE_SLOTS * sizeof(ws2812_output_lut_t),
+                                         MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (s_driver.luts == NULL) {
+            ESP_LOGE(TAG, "No memory for output LUTs");
+            release_channels();
+            return ESP_ERR_NO_MEM;
+        }
+        for (uint32_t slot = 0; slot < LED_QUEUE_SLOTS; slot++) {
+            ws2812_output_lut_identity(&s_driver.luts[slot]);
+        }
+    }
 
-    for (int ch = 0; ch < LED_CHANNEL_COUNT; ch++) {
+    // Subtask 8.1: Bring up every channel on the backend
+    for (uint8_t ch = 0; ch < s_driver.channel_count; ch++) {
         led_channel_state_t *channel = &s_driver.channels[ch];
-
-        // RMT TX channel config (Emotiscope-proven)
-        rmt_tx_channel_config_t tx_config = {
-            .gpio_num = channel_gpios[ch],
-            .clk_src = RMT_CLK_SRC_DEFAULT,
-            .resolution_hz = LED_RMT_RESOLUTION_HZ,  // 10MHz
-            .mem_block_symbols = LED_RMT_MEM_BLOCKS,  // 128 blocks
-            .trans_queue_depth = 4,
-            .intr_priority = 99,  // Emotiscope pattern
-            .flags = {
-                .invert_out = 0,
-                .with_dma = 0,  // NO DMA (Emotiscope pattern)
-                // Note: .io_loop_back and .io_od_mode removed in ESP-IDF v5.x
-                //       Use gpio_set_pull_mode() or gpio_set_drive_capability() if needed
-            },
+        const led_hal_channel_config_t channel_config = {
+            .channel = ch,
+            .channel_count = s_driver.channel_count,
+            .gpio = config->gpio[ch],
+            .led_count = s_driver.leds_per_channel,
         };
 
-        ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&tx_config, &channel->rmt_channel),
-                           TAG, "create RMT TX channel %d failed", ch);
-
-        // Create WS2812B encoder
-        ESP_RETURN_ON_ERROR(rmt_new_led_strip_encoder(&channel->encoder),
-                           TAG, "create LED encoder %d failed", ch);
-
-        // Enable RMT channel
-        ESP_RETURN_ON_ERROR(rmt_enable(channel->rmt_channel),
-                           TAG, "enable RMT channel %d failed", ch);
-
-        // Subtask 8.2: Initialize buffers (static, no allocation needed!)
-        memset(channel->front_buffer, 0, LED_FRAME_SIZE_CH);
-        memset(channel->back_buffer, 0, LED_FRAME_SIZE_CH);
-        channel->back_buffer_ready = false;
-
-        // Subtask 8.5: Initialize statistics
-        memset(&channel->stats, 0, sizeof(led_channel_stats_t));
+        esp_err_t ret = hal->channel_init(s_driver.hal_ctx, &channel_config, &channel->hal_handle);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Channel %u init failed: %s", (unsigned)ch, esp_err_to_name(ret));
+            channel->hal_handle = NULL;
+            release_channels();
+            return ret;
+        }
 
-        ESP_LOGI(TAG, "Channel %d initialized: GPIO %d, %d LEDs (%d bytes)",
-                 ch, channel_gpios[ch], LED_COUNT_PER_CH, LED_FRAME_SIZE_CH);
+        ESP_LOGI(TAG, "Channel %u initialized: GPIO %d, %u LEDs (%u bytes)",
+                 (unsigned)ch, config->gpio[ch], (unsigned)s_driver.leds_per_channel,
+                 (unsigned)s_driver.frame_bytes);
     }
 
-    s_driver.total_buffer_swaps = 0;
+    // Slot 0 starts as the (black) front; the renderer fills from slot 1
+    memset(s_driver.present_slot, 0, sizeof(s_driver.present_slot));
+    s_driver.front = 0;
+    s_driver.head = 1;
+    s_driver.tail = 1;
+    s_driver.acquired_mask = 0;
+    s_driver.last_present_slot = 0;
+    s_driver.starved = false;
+    s_driver.transmit_pending = false;
+    s_driver.clock_epoch_us = 0;
+    s_driver.last_slot = 0;
+
+    s_driver.stats_reset_pending = false;
+    stats_clear();
     s_driver.initialized = true;
 
-    ESP_LOGI(TAG, "Dual-channel LED driver initialized successfully");
-    ESP_LOGI(TAG, "Total memory: %d bytes (4×%d byte buffers)",
-             4 * LED_FRAME_SIZE_CH, LED_FRAME_SIZE_CH);
+    ESP_LOGI(TAG, "LED driver initialized successfully");
+    ESP_LOGI(TAG, "Total memory: %u bytes (%d slots x %u channels x %u bytes, %d frames render-ahead)",
+             (unsigned)slots_bytes, LED_QUEUE_SLOTS, (unsigned)s_driver.channel_count,
+             (unsigned)s_driver.frame_bytes, LED_RENDER_AHEAD_FRAMES);
 
     return ESP_OK;
 }
 
+esp_err_t led_driver_init(void)
+{
+    const led_driver_config_t config = LED_DRIVER_CONFIG_DEFAULT();
+    return led_driver_init_with_config(&config);
+}
+
+uint8_t led_driver_get_channel_count(void)
+{
+    return s_driver.initialized ? s_driver.channel_count : 2;
+}
+
+uint16_t led_driver_get_leds_per_channel(void)
+{
+    return s_driver.initialized ? s_driver.leds_per_channel : LED_COUNT_PER_CH;
+}
+
 /**
  * SUBTASK 8.4: Start LED Output
  */
@@ -410,7 +479,8 @@ esp_err_t led_driver_start(void)
         return ESP_OK;
     }
 
-    ESP_LOGI(TAG, "Starting dual-channel LED output @ %d FPS", LED_FPS_TARGET);
+    ESP_LOGI(TAG, "Starting %u-channel LED output @ %d FPS",
+             (unsigned)s_driver.channel_count, LED_FPS_TARGET);
 
     s_driver.running = true;
 
@@ -440,67 +510,244 @@ esp_err_t led_driver_start(void)
         .skip_unhandled_events = true,
     };
 
-    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &s_driver.frame_timer),
-                       TAG, "create frame timer failed");
+    esp_err_t ret = ESP_OK;
+    ESP_GOTO_ON_ERROR(esp_timer_create(&timer_args, &s_driver.frame_timer),
+                      err, TAG, "create frame timer failed");
 
-    // Start periodic timer at 60 FPS
-    ESP_RETURN_ON_ERROR(esp_timer_start_periodic(s_driver.frame_timer, LED_FRAME_TIME_MS * 1000),
-                       TAG, "start frame timer failed");
+    esp_timer_create_args_t render_timer_args = {
+        .callback = render_timer_callback,
+        .arg = NULL,
+        .name = "led_render_timer",
+        .skip_unhandled_events = true,
+    };
+
+    ESP_GOTO_ON_ERROR(esp_timer_create(&render_timer_args, &s_driver.render_timer),
+                      err, TAG, "create render timer failed");
+
+    // Start periodic timer at LED_FPS_TARGET (sub-ms period, not tick-quantized)
+    s_driver.clock_epoch_us = esp_timer_get_time() + LED_FRAME_PERIOD_US;
+    s_driver.last_slot = 0;
+    s_driver.last_present_slot = 0;
+    s_driver.jitter_samples = 0;
+    ESP_GOTO_ON_ERROR(esp_timer_start_periodic(s_driver.frame_timer, LED_FRAME_PERIOD_US),
+                      err, TAG, "start frame timer failed");
+
+    ESP_LOGI(TAG, "LED driver started (frame period: %d us, render lead: %lu us)",
+             LED_FRAME_PERIOD_US, (unsigned long)s_driver.render_lead_us);
+
+    return ESP_OK;
+
+err:
+    // No timer has fired yet, so the refresh task is still parked in
+    // ulTaskNotifyTake and can be deleted outright.
+    if (s_driver.frame_timer) {
+        esp_timer_delete(s_driver.frame_timer);
+        s_driver.frame_timer = NULL;
+    }
+    if (s_driver.render_timer) {
+        esp_timer_delete(s_driver.render_timer);
+        s_driver.render_timer = NULL;
+    }
+    s_driver.running = false;
+    vTaskDelete(refresh_task_handle);
+    refresh_task_handle = NULL;
+    return ret;
+}
 
-    ESP_LOGI(TAG, "Dual-channel LED driver started (frame period: %d ms)", LED_FRAME_TIME_MS);
+esp_err_t led_driver_set_render_task(TaskHandle_t task, uint32_t lead_us)
+{
+    if (task != NULL && lead_us == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
 
+    s_driver.render_lead_us = (lead_us > LED_FRAME_PERIOD_US) ? LED_FRAME_PERIOD_US : lead_us;
+    __atomic_store_n(&s_driver.render_task, task, __ATOMIC_RELEASE);
     return ESP_OK;
 }
 
 /**
- * SUBTASK 8.3: Submit Frame to Specific Channel
+ * Renderer: reserve the back slot if the queue has room and stamp it with
+ * the clock slot it will be shown in (one per slot after everything queued).
  */
-esp_err_t led_driver_submit_frame(led_channel_t channel, const uint8_t *frame)
+static esp_err_t queue_acquire(uint8_t mask)
 {
-    if (!s_driver.initialized) {
+    if (!s_driver.initialized || s_driver.acquired_mask) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (frame == NULL || channel >= LED_CHANNEL_COUNT) {
-        return ESP_ERR_INVALID_ARG;
+    uint32_t head = s_driver.head;
+    uint32_t tail = __atomic_load_n(&s_driver.tail, __ATOMIC_ACQUIRE);
+    uint32_t queued = head - tail;
+    if (queued >= LED_RENDER_AHEAD_FRAMES) {
+        return ESP_ERR_NO_MEM;
     }
 
-    // Copy frame to back buffer (Subtask 8.3)
-    xSemaphoreTake(s_driver.state_mutex, portMAX_DELAY);
-    memcpy(s_driver.channels[channel].back_buffer, frame, LED_FRAME_SIZE_CH);
-    s_driver.channels[channel].back_buffer_ready = true;
-    xSemaphoreGive(s_driver.state_mutex);
-
+    int64_t slot = __atomic_load_n(&s_driver.last_slot, __ATOMIC_ACQUIRE) + 1 + (int64_t)queued;
+    if (slot <= s_driver.last_present_slot) {
+        slot = s_driver.last_present_slot + 1;
+    }
+    s_driver.present_slot[head % LED_QUEUE_SLOTS] = slot;
+    s_driver.acquired_mask = mask;
     return ESP_OK;
 }
 
 /**
- * SUBTASK 8.3: Submit Frames to Both Channels
+ * Renderer: queue the back slot. Wait-free.
  */
-esp_err_t led_driver_submit_frames(const uint8_t *frame_ch1, const uint8_t *frame_ch2)
+static void queue_publish(void)
 {
-    if (!s_driver.initialized) {
+    uint32_t head = s_driver.head;
+    s_driver.last_present_slot = s_driver.present_slot[head % LED_QUEUE_SLOTS];
+    s_driver.acquired_mask = 0;
+    __atomic_store_n(&s_driver.head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Carry channels the renderer did not write, and the output LUT, forward
+ * from the last committed frame. That slot is queued or front, which only
+ * the refresh task reads.
+ */
+static void queue_fill_unwritten(uint8_t written_mask)
+{
+    uint32_t back = s_driver.head % LED_QUEUE_SLOTS;
+    uint32_t latest = (s_driver.head - 1) % LED_QUEUE_SLOTS;
+    for (uint8_t ch = 0; ch < s_driver.channel_count; ch++) {
+        if (!(written_mask & (1u << ch))) {
+            memcpy(slot_channel(back, ch), slot_channel(latest, ch), s_driver.frame_bytes);
+        }
+    }
+    if (s_driver.luts != NULL) {
+        s_driver.luts[back] = s_driver.luts[latest];
+    }
+}
+
+/**
+ * Presentation time of the acquired back slot
+ */
+static int64_t queue_present_us(void)
+{
+    int64_t slot = s_driver.present_slot[s_driver.head % LED_QUEUE_SLOTS];
+    if (!s_driver.running) {
+        return esp_timer_get_time();
+    }
+    return s_driver.clock_epoch_us + slot * LED_FRAME_PERIOD_US;
+}
+
+esp_err_t led_driver_acquire_frame(led_channel_t channel, uint8_t **out_buffer)
+{
+    if (out_buffer == NULL || channel >= LED_MAX_CHANNELS ||
+        (s_driver.initialized && channel >= s_driver.channel_count)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = queue_acquire((uint8_t)(1u << channel));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    *out_buffer = slot_channel(s_driver.head % LED_QUEUE_SLOTS, (uint8_t)channel);
+    return ESP_OK;
+}
+
+esp_err_t led_driver_commit_frame(led_channel_t channel)
+{
+    if (channel >= LED_MAX_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_driver.initialized || s_driver.acquired_mask != (1u << channel)) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (frame_ch1 == NULL || frame_ch2 == NULL) {
+    queue_fill_unwritten(s_driver.acquired_mask);
+    queue_publish();
+    return ESP_OK;
+}
+
+esp_err_t led_driver_acquire_frames(led_frame_t *out_frame)
+{
+    if (out_frame == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Copy both frames atomically
-    xSemaphoreTake(s_driver.state_mutex, portMAX_DELAY);
+    esp_err_t ret = queue_acquire(s_driver.initialized ? all_channels_mask() : 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    uint32_t back = s_driver.head % LED_QUEUE_SLOTS;
+    memset(out_frame->ch, 0, sizeof(out_frame->ch));
+    for (uint8_t ch = 0; ch < s_driver.channel_count; ch++) {
+        out_frame->ch[ch] = slot_channel(back, ch);
+    }
+    out_frame->channel_count = s_driver.channel_count;
+    out_frame->leds_per_channel = s_driver.leds_per_channel;
+    out_frame->present_us = queue_present_us();
+    out_frame->output_lut = slot_lut(back);
+    return ESP_OK;
+}
 
-    memcpy(s_driver.channels[LED_CHANNEL_1].back_buffer, frame_ch1, LED_FRAME_SIZE_CH);
-    s_driver.channels[LED_CHANNEL_1].back_buffer_ready = true;
+esp_err_t led_driver_commit_frames(void)
+{
+    if (!s_driver.initialized || s_driver.acquired_mask != all_channels_mask()) {
+        return ESP_ERR_INVALID_STATE;
+    }
 
-    memcpy(s_driver.channels[LED_CHANNEL_2].back_buffer, frame_ch2, LED_FRAME_SIZE_CH);
-    s_driver.channels[LED_CHANNEL_2].back_buffer_ready = true;
+    // One publish queues every channel, so they swap on the same refresh
+    queue_publish();
+    return ESP_OK;
+}
 
-    xSemaphoreGive(s_driver.state_mutex);
+esp_err_t led_driver_cancel_frames(void)
+{
+    if (!s_driver.initialized || !s_driver.acquired_mask) {
+        return ESP_ERR_INVALID_STATE;
+    }
 
+    s_driver.acquired_mask = 0;
     return ESP_OK;
 }
 
+/**
+ * SUBTASK 8.3: Submit Frame to Specific Channel
+ */
+esp_err_t led_driver_submit_frame(led_channel_t channel, const uint8_t *frame)
+{
+    if (frame == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Copy frame into the back slot (Subtask 8.3); the other channel repeats
+    uint8_t *back = NULL;
+    esp_err_t ret = led_driver_acquire_frame(channel, &back);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    memcpy(back, frame, s_driver.frame_bytes);
+    return led_driver_commit_frame(channel);
+}
+
+/**
+ * SUBTASK 8.3: Submit Frames to Channels 1 and 2
+ */
+esp_err_t led_driver_submit_frames(const uint8_t *frame_ch1, const uint8_t *frame_ch2)
+{
+    if (frame_ch1 == NULL || frame_ch2 == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    led_frame_t frame;
+    esp_err_t ret = led_driver_acquire_frames(&frame);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    memcpy(frame.ch[LED_CHANNEL_1], frame_ch1, s_driver.frame_bytes);
+    if (frame.channel_count > 1) {
+        memcpy(frame.ch[LED_CHANNEL_2], frame_ch2, s_driver.frame_bytes);
+    }
+    // Only the first two channels were written; the rest repeat
+    queue_fill_unwritten((1u << LED_CHANNEL_1) | (1u << LED_CHANNEL_2));
+    return led_driver_commit_frames();
+}
+
 /**
  * SUBTASK 8.5: Get Driver Statistics
  */
@@ -510,15 +757,32 @@ esp_err_t led_driver_get_stats(led_driver_stats_t *stats)
         return ESP_ERR_INVALID_ARG;
     }
 
-    xSemaphoreTake(s_driver.state_mutex, portMAX_DELAY);
-
-    stats->ch1 = s_driver.channels[LED_CHANNEL_1].stats;
-    stats->ch2 = s_driver.channels[LED_CHANNEL_2].stats;
-    stats->total_buffer_swaps = s_driver.total_buffer_swaps;
+    // Lock-free snapshot; fields are individually consistent
+    memset(stats->channels, 0, sizeof(stats->channels));
+    stats->channel_count = s_driver.initialized ? s_driver.channel_count : 0;
+    for (uint8_t ch = 0; ch < stats->channel_count; ch++) {
+        const led_channel_stats_t *src = &s_driver.channels[ch].stats;
+        led_channel_stats_t *dst = &stats->channels[ch];
+        dst->frames_transmitted = __atomic_load_n(&src->frames_transmitted, __ATOMIC_RELAXED);
+        dst->underruns = __atomic_load_n(&src->underruns, __ATOMIC_RELAXED);
+        dst->max_frame_time_us = __atomic_load_n(&src->max_frame_time_us, __ATOMIC_RELAXED);
+        dst->avg_frame_time_us = __atomic_load_n(&src->avg_frame_time_us, __ATOMIC_RELAXED);
+    }
+    stats->total_buffer_swaps = __atomic_load_n(&s_driver.total_buffer_swaps, __ATOMIC_RELAXED);
+    stats->frames_dropped = __atomic_load_n(&s_driver.frames_dropped, __ATOMIC_RELAXED);
+    stats->frames_duplicated = __atomic_load_n(&s_driver.frames_duplicated, __ATOMIC_RELAXED);
+    stats->frames_skipped = __atomic_load_n(&s_driver.frames_skipped, __ATOMIC_RELAXED);
+    stats->queue_underruns = __atomic_load_n(&s_driver.queue_underruns, __ATOMIC_RELAXED);
+    stats->queue_depth = __atomic_load_n(&s_driver.head, __ATOMIC_RELAXED) -
+                         __atomic_load_n(&s_driver.tail, __ATOMIC_RELAXED);
+    if (stats->queue_depth > LED_RENDER_AHEAD_FRAMES) {
+        stats->queue_depth = LED_RENDER_AHEAD_FRAMES;   // Raced a concurrent update
+    }
+    stats->queue_capacity = LED_RENDER_AHEAD_FRAMES;
+    stats->jitter_max_us = __atomic_load_n(&s_driver.jitter_max_us, __ATOMIC_RELAXED);
+    stats->jitter_avg_us = __atomic_load_n(&s_driver.jitter_avg_us, __ATOMIC_RELAXED);
     stats->is_running = s_driver.running;
 
-    xSemaphoreGive(s_driver.state_mutex);
-
     return ESP_OK;
 }
 
@@ -527,14 +791,13 @@ esp_err_t led_driver_get_stats(led_driver_stats_t *stats)
  */
 esp_err_t led_driver_reset_stats(void)
 {
-    xSemaphoreTake(s_driver.state_mutex, portMAX_DELAY);
-
-    for (int ch = 0; ch < LED_CHANNEL_COUNT; ch++) {
-        memset(&s_driver.channels[ch].stats, 0, sizeof(led_channel_stats_t));
+    // The refresh task is the only stats writer; let it clear on its next
+    // frame so no update is torn by the reset
+    if (s_driver.running) {
+        __atomic_store_n(&s_driver.stats_reset_pending, true, __ATOMIC_RELEASE);
+    } else {
+        stats_clear();
     }
-    s_driver.total_buffer_swaps = 0;
-
-    xSemaphoreGive(s_driver.state_mutex);
 
     ESP_LOGI(TAG, "Driver statistics reset");
     return ESP_OK;
@@ -549,7 +812,7 @@ esp_err_t led_driver_stop(void)
         return ESP_OK;
     }
 
-    ESP_LOGI(TAG, "Stopping dual-channel LED driver");
+    ESP_LOGI(TAG, "Stopping LED driver");
 
     // Stop timer
     if (s_driver.frame_timer) {
@@ -557,6 +820,11 @@ esp_err_t led_driver_stop(void)
         esp_timer_delete(s_driver.frame_timer);
         s_driver.frame_timer = NULL;
     }
+    if (s_driver.render_timer) {
+        esp_timer_stop(s_driver.render_timer);
+        esp_timer_delete(s_driver.render_timer);
+        s_driver.render_timer = NULL;
+    }
 
     // Signal task to exit
     s_driver.running = false;
@@ -564,18 +832,20 @@ esp_err_t led_driver_stop(void)
     // Wait for task to exit
     vTaskDelay(pdMS_TO_TICKS(100));
 
-    // Clear all LEDs on both channels
-    for (int ch = 0; ch < LED_CHANNEL_COUNT; ch++) {
-        memset(s_driver.channels[ch].front_buffer, 0, LED_FRAME_SIZE_CH);
-        rmt_transmit(s_driver.channels[ch].rmt_channel,
-                    s_driver.channels[ch].encoder,
-                    s_driver.channels[ch].front_buffer,
-                    LED_FRAME_SIZE_CH,
-                    &s_tx_config);
-        rmt_tx_wait_all_done(s_driver.channels[ch].rmt_channel, LED_FRAME_TIME_MS);
+    // Clear all LEDs on every channel
+    for (uint8_t ch = 0; ch < s_driver.channel_count; ch++) {
+        void *handle = s_driver.channels[ch].hal_handle;
+        s_driver.hal->wait_done(s_driver.hal_ctx, handle, LED_FRAME_TIME_MS);
+        memset(slot_channel(s_driver.front, ch), 0, s_driver.frame_bytes);
+        s_driver.hal->transmit(s_driver.hal_ctx, handle, slot_channel(s_driver.front, ch), s_driver.frame_bytes,
+                               NULL);
     }
+    for (uint8_t ch = 0; ch < s_driver.channel_count; ch++) {
+        s_driver.hal->wait_done(s_driver.hal_ctx, s_driver.channels[ch].hal_handle, LED_FRAME_TIME_MS);
+    }
+    s_driver.transmit_pending = false;
 
-    ESP_LOGI(TAG, "Dual-channel LED driver stopped");
+    ESP_LOGI(TAG, "LED driver stopped");
     return ESP_OK;
 }
 
@@ -589,32 +859,31 @@ esp_err_t led_driver_deinit(void)
         return ESP_ERR_INVALID_STATE;
     }
 
-    ESP_LOGI(TAG, "Deinitializing dual-channel LED driver");
-
-    // Destroy synchronization primitives
-    if (s_driver.state_mutex) {
-        vSemaphoreDelete(s_driver.state_mutex);
-        s_driver.state_mutex = NULL;
+    if (!s_driver.initialized) {
+        return ESP_OK;
     }
 
-    // Disable and delete RMT resources for both channels
-    for (int ch = 0; ch < LED_CHANNEL_COUNT; ch++) {
-        led_channel_state_t *channel = &s_driver.channels[ch];
-
-        if (channel->rmt_channel) {
-            rmt_disable(channel->rmt_channel);
-            rmt_del_channel(channel->rmt_channel);
-            channel->rmt_channel = NULL;
-        }
+    ESP_LOGI(TAG, "Deinitializing LED driver");
 
-        if (channel->encoder) {
-            rmt_del_encoder(channel->encoder);
-            channel->encoder = NULL;
+    // Let the last frame finish before the channels are released
+    if (s_driver.transmit_pending) {
+        for (uint8_t ch = 0; ch < s_driver.channel_count; ch++) {
+            s_driver.hal->wait_done(s_driver.hal_ctx, s_driver.channels[ch].hal_handle, LED_FRAME_TIME_MS);
         }
+        s_driver.transmit_pending = false;
     }
+    release_channels();
 
     s_driver.initialized = false;
-    ESP_LOGI(TAG, "Dual-channel LED driver deinitialized");
+    ESP_LOGI(TAG, "LED driver deinitialized");
 
     return ESP_OK;
 }
+
+esp_err_t led_driver_refresh_once(int64_t now_us)
+{
+    if (!s_driver.initialized || s_driver.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return refresh_frame(now_us);
+}
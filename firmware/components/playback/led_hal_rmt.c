@@ -0,0 +1,336 @@
+/**
+ * @file led_hal_rmt.c
+ * @brief RMT output backend for the LED driver
+ *
+ * One RMT TX channel and WS2812B encoder per LED channel. Transmits are
+ * queued asynchronously so all channels shift out in parallel.
+ */
+
+#include "sdkconfig.h"
+#include "led_hal.h"
+#include "led_driver.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "driver/rmt_tx.h"
+#include "driver/rmt_encoder.h"
+#include "ws2812_symbols.h"
+#include <stdlib.h>
+
+static const char *TAG = "led_hal_rmt";
+
+/**
+ * WS2812B Timing Configuration
+ * PROVEN VALUES from Emotiscope - DO NOT MODIFY without hardware verification
+ *
+ * At 10MHz (0.1us ticks):
+ * bit0: {duration0=4 ticks (0.4us high), level0=1, duration1=6 ticks (0.6us low), level1=0}
+ * bit1: {duration0=7 ticks (0.7us high), level0=1, duration1=6 ticks (0.6us low), level1=0}
+ * reset: {duration0=250 ticks (25us low), level0=0, duration1=250 ticks (25us low), level1=0}
+ */
+
+/**
+ * Subtask 8.1: WS2812B Encoder (Emotiscope-proven pattern)
+ */
+typedef struct {
+    rmt_encoder_t base;
+    rmt_encoder_t *bytes_encoder;
+    rmt_encoder_t *copy_encoder;
+    int state;
+    rmt_symbol_word_t reset_code;
+} rmt_led_strip_encoder_t;
+
+/**
+ * SUBTASK 8.1: WS2812B Encoder Implementation
+ * IRAM_ATTR for performance (Emotiscope pattern)
+ */
+IRAM_ATTR static size_t rmt_encode_led_strip(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
+                                               const void *primary_data, size_t data_size,
+                                               rmt_encode_state_t *ret_state)
+{
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    rmt_encoder_handle_t bytes_encoder = led_encoder->bytes_encoder;
+    rmt_encoder_handle_t copy_encoder = led_encoder->copy_encoder;
+    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded_symbols = 0;
+
+    switch (led_encoder->state) {
+    case 0: // Send GRB data
+        encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, primary_data, data_size, &session_state);
+        if (session_state & RMT_ENCODING_COMPLETE) {
+            led_encoder->state = 1; // Move to reset phase
+        }
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            state = (rmt_encode_state_t)(state | (uint32_t)RMT_ENCODING_MEM_FULL);
+            goto out;
+        }
+        // fall-through
+    case 1: // Send reset code
+        encoded_symbols += copy_encoder->encode(copy_encoder, channel, &led_encoder->reset_code,
+                                                 sizeof(led_encoder->reset_code), &session_state);
+        if (session_state & RMT_ENCODING_COMPLETE) {
+            led_encoder->state = RMT_ENCODING_RESET;
+            state = (rmt_encode_state_t)(state | (uint32_t)RMT_ENCODING_COMPLETE);
+        }
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            state = (rmt_encode_state_t)(state | (uint32_t)RMT_ENCODING_MEM_FULL);
+            goto out;
+        }
+    }
+out:
+    *ret_state = state;
+    return encoded_symbols;
+}
+
+static esp_err_t rmt_del_led_strip_encoder(rmt_encoder_t *encoder)
+{
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    rmt_del_encoder(led_encoder->bytes_encoder);
+    rmt_del_encoder(led_encoder->copy_encoder);
+    free(led_encoder);
+    return ESP_OK;
+}
+
+static esp_err_t rmt_led_strip_encoder_reset(rmt_encoder_t *encoder)
+{
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    rmt_encoder_reset(led_encoder->bytes_encoder);
+    rmt_encoder_reset(led_encoder->copy_encoder);
+    led_encoder->state = RMT_ENCODING_RESET;
+    return ESP_OK;
+}
+
+/**
+ * Subtask 8.1: Create WS2812B encoder with PROVEN timing
+ */
+static esp_err_t rmt_new_led_strip_encoder(rmt_encoder_handle_t *ret_encoder)
+{
+    esp_err_t ret = ESP_OK;
+    rmt_led_strip_encoder_t *led_encoder = NULL;
+
+    ESP_GOTO_ON_FALSE(ret_encoder, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
+
+    led_encoder = calloc(1, sizeof(rmt_led_strip_encoder_t));
+    ESP_GOTO_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip encoder");
+
+    led_encoder->base.encode = rmt_encode_led_strip;
+    led_encoder->base.del = rmt_del_led_strip_encoder;
+    led_encoder->base.reset = rmt_led_strip_encoder_reset;
+
+    // PROVEN WS2812B timing from Emotiscope (10MHz resolution)
+    // DO NOT MODIFY without hardware testing
+    rmt_bytes_encoder_config_t bytes_encoder_config = {
+        .bit0 = {
+            .level0 = 1,
+            .duration0 = 4,  // 0.4us high
+            .level1 = 0,
+            .duration1 = 6,  // 0.6us low
+        },
+        .bit1 = {
+            .level0 = 1,
+            .duration0 = 7,  // 0.7us high
+            .level1 = 0,
+            .duration1 = 6,  // 0.6us low
+        },
+        .flags.msb_first = 1,
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, &led_encoder->bytes_encoder),
+                      err, TAG, "create bytes encoder failed");
+
+    // Copy encoder for reset code
+    rmt_copy_encoder_config_t copy_encoder_config = {};
+    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &led_encoder->copy_encoder),
+                      err, TAG, "create copy encoder failed");
+
+    // Reset code: >50us low (WS2812B spec)
+    led_encoder->reset_code = (rmt_symbol_word_t){
+        .level0 = 0,
+        .duration0 = 250,  // 25us
+        .level1 = 0,
+        .duration1 = 250,  // 25us (total 50us)
+    };
+
+    *ret_encoder = &led_encoder->base;
+    return ESP_OK;
+
+err:
+    if (led_encoder) {
+        if (led_encoder->bytes_encoder) {
+            rmt_del_encoder(led_encoder->bytes_encoder);
+        }
+        if (led_encoder->copy_encoder) {
+            rmt_del_encoder(led_encoder->copy_encoder);
+        }
+        free(led_encoder);
+    }
+    return ret;
+}
+
+typedef struct {
+    rmt_channel_handle_t rmt_channel;
+    rmt_encoder_handle_t encoder;
+    const ws2812_output_lut_t *lut;     // Output transform of the transmit in flight
+} led_hal_rmt_channel_t;
+
+#if CONFIG_PRISM_LED_LUT_ENCODER
+/**
+ * Table-driven WS2812B encoder: the simple-encoder callback is invoked
+ * whenever RMT memory has room (ping-pong refill) and copies 8 prebuilt
+ * symbols per byte instead of running the bytes encoder bit by bit.
+ * The table is shared by all channels and built on first use.
+ */
+static DRAM_ATTR ws2812_symbol_table_t s_symbol_table;
+static DRAM_ATTR uint32_t s_reset_symbol;
+static bool s_symbol_table_ready;
+
+IRAM_ATTR static size_t rmt_encode_led_strip_lut(const void *data, size_t data_size,
+                                                 size_t symbols_written, size_t symbols_free,
+                                                 rmt_symbol_word_t *symbols, bool *done, void *arg)
+{
+    // The channel's output LUT is fixed for the whole transmit
+    const ws2812_output_lut_t *lut = ((const led_hal_rmt_channel_t *)arg)->lut;
+    size_t byte_pos = symbols_written / WS2812_SYMBOLS_PER_BYTE;
+
+    if (byte_pos < data_size) {
+        size_t bytes = ws2812_encode_bytes(&s_symbol_table, lut, (const uint8_t *)data, byte_pos, data_size,
+                                           (uint32_t *)symbols, symbols_free);
+        return bytes * WS2812_SYMBOLS_PER_BYTE;
+    }
+
+    // All GRB data is out: finish with the reset code
+    symbols[0].val = s_reset_symbol;
+    *done = true;
+    return 1;
+}
+
+static esp_err_t rmt_new_led_strip_lut_encoder(led_hal_rmt_channel_t *channel,
+                                                rmt_encoder_handle_t *ret_encoder)
+{
+    if (!s_symbol_table_ready) {
+        const ws2812_timing_t timing = WS2812_TIMING_10MHZ;
+        ws2812_symbol_table_build(&s_symbol_table, &timing);
+        s_reset_symbol = ws2812_reset_symbol(&timing);
+        s_symbol_table_ready = true;
+    }
+
+    const rmt_simple_encoder_config_t config = {
+        .callback = rmt_encode_led_strip_lut,
+        .arg = channel,
+        .min_chunk_size = WS2812_SYMBOLS_PER_BYTE,  // Whole bytes only
+    };
+    return rmt_new_simple_encoder(&config, ret_encoder);
+}
+#endif
+
+// RMT TX configuration (shared by all channels)
+static const rmt_transmit_config_t s_tx_config = {
+    .loop_count = 0,  // No transfer loop
+    .flags = {
+        .eot_level = 0,
+        .queue_nonblocking = 0,
+    },
+};
+
+static void rmt_hal_channel_deinit(void *ctx, void *handle);
+
+/**
+ * Subtask 8.1: Configure one RMT channel with PROVEN settings
+ */
+static esp_err_t rmt_hal_channel_init(void *ctx, const led_hal_channel_config_t *config, void **out_handle)
+{
+    (void)ctx;
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && out_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    led_hal_rmt_channel_t *channel = calloc(1, sizeof(led_hal_rmt_channel_t));
+    ESP_RETURN_ON_FALSE(channel, ESP_ERR_NO_MEM, TAG, "no mem for channel %d", config->channel);
+
+    // The proven 128-symbol buffer spans several RMT memory blocks; with
+    // more than two channels each one gets a single block instead
+    size_t mem_symbols = (config->channel_count <= 2) ? LED_RMT_MEM_BLOCKS : LED_RMT_MEM_BLOCKS_MIN;
+
+    // RMT TX channel config (Emotiscope-proven)
+    rmt_tx_channel_config_t tx_config = {
+        .gpio_num = config->gpio,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = LED_RMT_RESOLUTION_HZ,  // 10MHz
+        .mem_block_symbols = mem_symbols,
+        .trans_queue_depth = 4,
+        .intr_priority = 99,  // Emotiscope pattern
+        .flags = {
+            .invert_out = 0,
+            .with_dma = 0,  // NO DMA (Emotiscope pattern)
+            // Note: .io_loop_back and .io_od_mode removed in ESP-IDF v5.x
+            //       Use gpio_set_pull_mode() or gpio_set_drive_capability() if needed
+        },
+    };
+
+    ESP_GOTO_ON_ERROR(rmt_new_tx_channel(&tx_config, &channel->rmt_channel),
+                      err, TAG, "create RMT TX channel %d failed", config->channel);
+
+    // Create WS2812B encoder
+#if CONFIG_PRISM_LED_LUT_ENCODER
+    ESP_GOTO_ON_ERROR(rmt_new_led_strip_lut_encoder(channel, &channel->encoder),
+                      err, TAG, "create LED encoder %d failed", config->channel);
+#else
+    ESP_GOTO_ON_ERROR(rmt_new_led_strip_encoder(&channel->encoder),
+                      err, TAG, "create LED encoder %d failed", config->channel);
+#endif
+
+    // Enable RMT channel
+    ESP_GOTO_ON_ERROR(rmt_enable(channel->rmt_channel),
+                      err, TAG, "enable RMT channel %d failed", config->channel);
+
+    *out_handle = channel;
+    return ESP_OK;
+
+err:
+    rmt_hal_channel_deinit(NULL, channel);
+    return ret;
+}
+
+IRAM_ATTR static esp_err_t rmt_hal_transmit(void *ctx, void *handle, const uint8_t *grb, size_t len,
+                                            const ws2812_output_lut_t *lut)
+{
+    (void)ctx;
+    led_hal_rmt_channel_t *channel = (led_hal_rmt_channel_t *)handle;
+    channel->lut = lut;     // Previous transmit is done, so the encoder is idle
+    return rmt_transmit(channel->rmt_channel, channel->encoder, grb, len, &s_tx_config);
+}
+
+IRAM_ATTR static esp_err_t rmt_hal_wait_done(void *ctx, void *handle, int32_t timeout_ms)
+{
+    (void)ctx;
+    led_hal_rmt_channel_t *channel = (led_hal_rmt_channel_t *)handle;
+    return rmt_tx_wait_all_done(channel->rmt_channel, timeout_ms);
+}
+
+static void rmt_hal_channel_deinit(void *ctx, void *handle)
+{
+    (void)ctx;
+    led_hal_rmt_channel_t *channel = (led_hal_rmt_channel_t *)handle;
+    if (channel == NULL) {
+        return;
+    }
+
+    if (channel->rmt_channel) {
+        rmt_disable(channel->rmt_channel);
+        rmt_del_channel(channel->rmt_channel);
+    }
+    if (channel->encoder) {
+        rmt_del_encoder(channel->encoder);
+    }
+    free(channel);
+}
+
+const led_hal_ops_t led_hal_rmt_ops = {
+    .channel_init = rmt_hal_channel_init,
+    .transmit = rmt_hal_transmit,
+    .wait_done = rmt_hal_wait_done,
+    .channel_deinit = rmt_hal_channel_deinit,
+#if CONFIG_PRISM_LED_LUT_ENCODER
+    .caps = LED_HAL_CAP_OUTPUT_LUT,
+#else
+    .caps = 0,
+#endif
+};
@@ -9,6 +9,7 @@
 #include "pattern_metadata.h"
 #include "prism_parser.h"
 #include "pattern_storage.h"
+#include "pattern_cache.h"
 #include "esp_timer.h"
 #include "esp_log.h"
 #include "prism_wave_tables.h"
@@ -22,17 +23,19 @@
 #include <string.h>
 #include <stdlib.h>
 #include "effect_engine.h"
+#include "prism_decoder.h"
+#include "prism_history.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 
 // Built-in effect IDs (initial set)
 #define EFFECT_WAVE_SINGLE      0x0001
 #define EFFECT_PALETTE_CYCLE    0x0040
 
 #define PLAYBACK_PATTERN_ID_MAX 64
-#define PRISM_FLAG_DELTA        0x01
-#define PRISM_FLAG_RLE          0x02
-#define PRISM_RLE_MARK          0x80
-#define PRISM_RLE_MASK          0x7F
-#define PRISM_MAX_PALETTE       64
+// Frames decoded in sequence per tick when catching up after a stall; larger
+// gaps seek instead of replaying the backlog.
+#define PLAYBACK_MAX_CATCHUP_FRAMES 4
 
 static const char *TAG = "playback";
 
@@ -45,6 +48,10 @@ static const char *TAG = "playback";
 static uint64_t s_build_sum_us = 0;
 static uint64_t s_build_max_us = 0;
 static uint32_t s_build_samples = 0;
+// Crossfade blend cost (us), sampled only while a transition runs
+static uint64_t s_blend_sum_us = 0;
+static uint64_t s_blend_max_us = 0;
+static uint32_t s_blend_samples = 0;
 #endif
 
 typedef enum {
@@ -65,7 +72,7 @@ typedef struct {
 static playback_state_t s_pb = {0};
 
 // Temporal integration (Task 14)
-#define PRISM_LGP_LED_COUNT 160
+#define PRISM_LGP_LED_COUNT PRISM_TEMPORAL_MAX_LEDS
 static uint16_t s_temporal_ch1_u16[PRISM_LGP_LED_COUNT];
 static uint16_t s_temporal_ch2_u16[PRISM_LGP_LED_COUNT];
 static prism_temporal_ctx_t temporal_ctx;
@@ -73,26 +80,156 @@ static int64_t pattern_start_time_us = 0; // Pattern start timestamp (us)
 static int64_t s_last_fx_tick_us = 0;     // Effect engine last tick time
 
 typedef struct {
-    bool loaded;
     char id[PLAYBACK_PATTERN_ID_MAX];
     prism_header_v11_t header;
-    uint8_t *frames;
-    size_t frame_stride;
+    const uint8_t *blob;        // .prism blob the decoder streams from
+    size_t blob_size;
+    playback_blob_release_fn blob_release; // Returns the blob to its owner
+    void *blob_release_ctx;
+    prism_decoder_t decoder;    // Palette + current index frame + cursor
+    prism_seek_index_t seek_index; // Keyframe offsets from extra data (owned, may be empty)
     uint32_t frame_count;
-    uint32_t current_frame;
     uint32_t led_count;
     uint32_t frame_interval_us;
     int64_t last_frame_us;
+    prism_temporal_ctx_t temporal; // Compiled delay map from the pattern's metadata
+    prism_history_t history;    // CH1 history for time-shifted CH2 (owned, inactive for SYNC)
+    bool unpin_on_free;         // Failed while playing: drop its ACTIVE cache pin when freed
 } pattern_runtime_t;
 
-static pattern_runtime_t s_pattern = {0};
+// Pattern handoff: the loader task builds a runtime off the real-time path and
+// publishes it through s_pattern_pending with a single atomic exchange;
+// playback_task adopts it at the next frame boundary. Only playback_task
+// touches s_pattern, so the renderer never sees a half-built pattern.
+#define PATTERN_SWAP_STOP ((pattern_runtime_t *)1) // Pending value: drop the active pattern
+
+static pattern_runtime_t *s_pattern = NULL;
+static pattern_runtime_t *s_pattern_pending = NULL;
+static volatile uint32_t s_pattern_frame_count = 0; // Adopted pattern's frame count (0 = none)
+// Published by playback_seek_frame(): target first, then the flag with
+// release ordering, so playback_task never acts on a stale target.
+static bool s_seek_pending = false;
+static uint32_t s_seek_target = 0;
+
+// Crossfade: while s_pattern_out is set, playback_task decodes both patterns
+// and blends them per LED straight into the channel buffers. At most two
+// decoders are live; a switch mid-fade drops the oldest.
+#ifdef CONFIG_PRISM_TRANSITION_MS
+#define PLAYBACK_DEFAULT_TRANSITION_MS CONFIG_PRISM_TRANSITION_MS
+#else
+#define PLAYBACK_DEFAULT_TRANSITION_MS 300
+#endif
+#define PLAYBACK_MAX_TRANSITION_MS 10000
+
+static pattern_runtime_t *s_pattern_out = NULL;     // Outgoing pattern (playback_task only)
+static int64_t s_transition_start_us = 0;
+static uint32_t s_transition_us = 0;
+static volatile uint32_t s_transition_ms = PLAYBACK_DEFAULT_TRANSITION_MS;
+
+// Opt-in temporal interpolation for patterns authored below LED_FPS_TARGET:
+// the decoder keeps frame k while decoding k+1 and the renderer blends the
+// two by sub-frame phase. Output runs one source frame behind.
+#ifdef CONFIG_PRISM_INTERPOLATE_LOW_FPS
+#define PLAYBACK_DEFAULT_INTERPOLATE true
+#else
+#define PLAYBACK_DEFAULT_INTERPOLATE false
+#endif
+static volatile bool s_interpolate = PLAYBACK_DEFAULT_INTERPOLATE;
+
+// playback_task is woken by the LED driver's frame clock this long before
+// each transmit slot, so render and transmit share one clock
+#ifdef CONFIG_PRISM_RENDER_LEAD_US
+#define PLAYBACK_RENDER_LEAD_US CONFIG_PRISM_RENDER_LEAD_US
+#else
+#define PLAYBACK_RENDER_LEAD_US 4000
+#endif
+
+// Loader task (Core 1): storage reads, CRC and first-frame decode happen here
+#define PLAYBACK_LOADER_QUEUE_LEN 4
+#define PLAYBACK_RETIRE_QUEUE_LEN 4
+#define PLAYBACK_LOADER_IDLE_MS   100
+
+typedef enum {
+    LOADER_CMD_STORAGE = 0,     // Acquire pattern `id` from storage/cache
+    LOADER_CMD_BLOB             // Use the caller's borrowed blob
+} loader_cmd_type_t;
 
-static void playback_free_pattern(void)
+typedef struct {
+    loader_cmd_type_t type;
+    uint32_t seq;               // Request sequence; stale requests are dropped
+    char id[PLAYBACK_PATTERN_ID_MAX];
+    const uint8_t *blob;
+    size_t blob_size;
+    playback_blob_release_fn release;
+    void *release_ctx;
+    playback_load_cb_t done;
+    void *done_ctx;
+} loader_cmd_t;
+
+static QueueHandle_t s_loader_queue = NULL;  // loader_cmd_t
+static QueueHandle_t s_retire_queue = NULL;  // pattern_runtime_t * replaced by playback_task
+static volatile bool s_loader_running = false;
+static uint32_t s_load_seq = 0;             // Bumped by every load/stop/builtin request
+static SemaphoreHandle_t s_publish_lock = NULL; // Orders loader publishes against stop/builtin
+
+// Cache handle backing the runtime's blob, or NULL if the blob is not cached
+static pattern_cache_handle_t pattern_runtime_cache_handle(const pattern_runtime_t *rt)
 {
-    if (s_pattern.frames) {
-        free(s_pattern.frames);
+    return (rt->blob_release == playback_release_cache_handle)
+               ? (pattern_cache_handle_t)rt->blob_release_ctx : NULL;
+}
+
+static void pattern_runtime_free(pattern_runtime_t *rt)
+{
+    if (rt == NULL || rt == PATTERN_SWAP_STOP) {
+        return;
+    }
+    if (rt->unpin_on_free) {
+        // Only if a later pattern has not taken the slot since
+        pattern_cache_unpin(PATTERN_CACHE_PIN_ACTIVE, pattern_runtime_cache_handle(rt));
+    }
+    if (rt->blob && rt->blob_release) {
+        rt->blob_release(rt->blob_release_ctx);
+    }
+    prism_seek_index_free(&rt->seek_index);
+    prism_history_deinit(&rt->history);
+    free(rt);
+}
+
+// Hand a runtime playback_task no longer references to the loader, which
+// frees it; keeps cache locks and heap frees out of the frame loop.
+static void pattern_runtime_retire(pattern_runtime_t *rt)
+{
+    if (rt == NULL || rt == PATTERN_SWAP_STOP) {
+        return;
     }
-    memset(&s_pattern, 0, sizeof(s_pattern));
+    if (s_loader_running && s_retire_queue && xQueueSend(s_retire_queue, &rt, 0) == pdTRUE) {
+        return;
+    }
+    pattern_runtime_free(rt);
+}
+
+// Publish a runtime (or PATTERN_SWAP_STOP) for playback_task. A runtime
+// published earlier but not yet adopted is superseded and freed here.
+static void pattern_publish(pattern_runtime_t *rt)
+{
+    pattern_runtime_t *prev = __atomic_exchange_n(&s_pattern_pending, rt, __ATOMIC_ACQ_REL);
+    pattern_runtime_free(prev);
+}
+
+static void publish_lock(void) { if (s_publish_lock) xSemaphoreTake(s_publish_lock, portMAX_DELAY); }
+static void publish_unlock(void) { if (s_publish_lock) xSemaphoreGive(s_publish_lock); }
+
+// Cancel in-flight loads and have playback_task drop the active pattern.
+// Serialized with the loader's stale check + publish so a load that passed
+// its check cannot land after (and overwrite) this STOP.
+static void pattern_publish_stop(void)
+{
+    publish_lock();
+    (void)__atomic_add_fetch(&s_load_seq, 1, __ATOMIC_ACQ_REL);
+    pattern_publish(PATTERN_SWAP_STOP);
+    (void)pattern_cache_pin(PATTERN_CACHE_PIN_ACTIVE, NULL);
+    publish_unlock();
 }
 
 void playback_normalize_pattern_id(const char *input, char *output, size_t output_len)
@@ -143,45 +280,46 @@ void playback_normalize_pattern_id(const char *input, char *output, size_t outpu
 }
 
 // Update temporal context from loaded pattern metadata
-static void update_temporal_context(const prism_pattern_meta_v11_t *meta) {
+static void update_temporal_context(prism_temporal_ctx_t *ctx, const prism_pattern_meta_v11_t *meta) {
     if (!meta) {
         ESP_LOGW(TAG, "NULL metadata, using SYNC defaults");
-        temporal_ctx.sync_mode = PRISM_SYNC_SYNC;
-        temporal_ctx.motion_direction = PRISM_MOTION_STATIC;
-        memset(&temporal_ctx.params, 0, sizeof(temporal_ctx.params));
+        ctx->sync_mode = PRISM_SYNC_SYNC;
+        ctx->motion_direction = PRISM_MOTION_STATIC;
+        memset(&ctx->params, 0, sizeof(ctx->params));
         return;
     }
 
     // Validate and copy metadata
     if (PRISM_SYNC_IS_VALID(meta->sync_mode)) {
-        temporal_ctx.sync_mode = (prism_sync_mode_t)meta->sync_mode;
+        ctx->sync_mode = (prism_sync_mode_t)meta->sync_mode;
     } else {
         ESP_LOGW(TAG, "Invalid sync mode %d, defaulting to SYNC", meta->sync_mode);
-        temporal_ctx.sync_mode = PRISM_SYNC_SYNC;
+        ctx->sync_mode = PRISM_SYNC_SYNC;
     }
 
     if (PRISM_MOTION_IS_VALID(meta->motion_direction)) {
-        temporal_ctx.motion_direction = (prism_motion_t)meta->motion_direction;
+        ctx->motion_direction = (prism_motion_t)meta->motion_direction;
     } else {
         ESP_LOGW(TAG, "Invalid motion %d, defaulting to STATIC", meta->motion_direction);
-        temporal_ctx.motion_direction = PRISM_MOTION_STATIC;
+        ctx->motion_direction = PRISM_MOTION_STATIC;
     }
 
     // Copy sync parameters
-    memcpy(&temporal_ctx.params, &meta->params, sizeof(temporal_ctx.params));
+    memcpy(&ctx->params, &meta->params, sizeof(ctx->params));
 
     // Reset frame timing
-    temporal_ctx.frame_index = 0;
-    temporal_ctx.frame_time_ms = 0;
+    ctx->frame_index = 0;
+    ctx->frame_time_ms = 0;
 
     ESP_LOGI(TAG, "Temporal context updated: mode=%d, motion=%d",
-             temporal_ctx.sync_mode, temporal_ctx.motion_direction);
+             ctx->sync_mode, ctx->motion_direction);
 }
 
 // Start a new pattern with temporal sequencing
-static void playback_start_pattern(const prism_pattern_meta_v11_t *meta) {
-    // Update temporal context from pattern metadata
-    update_temporal_context(meta);
+static void playback_start_pattern(const pattern_runtime_t *rt) {
+    // The loader already compiled the delay map and sized the history;
+    // builtin effects started later keep the pattern's temporal settings
+    temporal_ctx = rt->temporal;
 
     // Record pattern start time
     pattern_start_time_us = esp_timer_get_time();
@@ -192,26 +330,23 @@ static void playback_start_pattern(const prism_pattern_meta_v11_t *meta) {
 }
 
 // Update frame timing before each frame calculation
-static void playback_update_timing(void) {
+static void playback_update_timing(int64_t now_us) {
     // Calculate elapsed time since pattern start
-    int64_t now_us = esp_timer_get_time();
     int64_t elapsed_us = now_us - pattern_start_time_us;
     temporal_ctx.frame_time_ms = (uint32_t)(elapsed_us / 1000);
 }
 
-// Calculate CH2 frame using temporal logic (for future RMT dual-channel)
-static void playback_frame_temporal(const uint16_t *ch1_frame_u16, size_t led_count) {
-    // Update timing before calculation
-    playback_update_timing();
-
-    // Calculate CH2 frame using temporal logic
-    calculate_ch2_frame(&temporal_ctx, ch1_frame_u16, s_temporal_ch2_u16, led_count);
+// Precomputed spatial phase per LED (0-255 over the channel length)
+static uint8_t s_phase_per_led[LED_MAX_LEDS_PER_CH];
+static uint16_t s_phase_led_count;
 
-    // Increment frame counter
-    temporal_ctx.frame_index++;
+static void playback_build_phase_table(uint16_t led_count)
+{
+    for (uint16_t i = 0; i < led_count; i++) {
+        s_phase_per_led[i] = (uint8_t)((i * 256u) / led_count);
+    }
+    s_phase_led_count = led_count;
 }
-// Precomputed spatial phase per LED (0-255 over LED_COUNT_PER_CH)
-static uint8_t s_phase_per_led[LED_COUNT_PER_CH];
 
 #ifdef CONFIG_PRISM_PROFILE_TEMPORAL
 typedef struct {
@@ -468,6 +603,22 @@ static int cmd_prism_stop(int argc, char **argv)
     return 0;
 }
 
+static int cmd_prism_seek(int argc, char **argv)
+{
+    if (argc < 2 || argv[1] == NULL) {
+        printf("usage: prism_seek <frame>\n");
+        return 0;
+    }
+    uint32_t frame = (uint32_t)strtoul(argv[1], NULL, 10);
+    esp_err_t err = playback_seek_frame(frame);
+    if (err != ESP_OK) {
+        printf("seek failed: %s\n", esp_err_to_name(err));
+    } else {
+        printf("seeking to frame %" PRIu32 "\n", frame);
+    }
+    return 0;
+}
+
 static void playback_register_pattern_cli(void)
 {
     const esp_console_cmd_t play_cmd = {
@@ -487,15 +638,22 @@ static void playback_register_pattern_cli(void)
         .argtable = NULL,
     };
     (void)esp_console_cmd_register(&stop_cmd);
+
+    const esp_console_cmd_t seek_cmd = {
+        .command = "prism_seek",
+        .help = "Jump the playing pattern to a frame: prism_seek <frame>",
+        .hint = NULL,
+        .func = &cmd_prism_seek,
+        .argtable = NULL,
+    };
+    (void)esp_console_cmd_register(&seek_cmd);
 }
 
 esp_err_t playback_init(void) {
     ESP_LOGI(TAG, "Initializing playback subsystem (120 FPS target)...");
     // Defer LED driver init until first play request
     // Precompute spatial phase offsets for WAVE effects
-    for (int i = 0; i < LED_COUNT_PER_CH; i++) {
-        s_phase_per_led[i] = (uint8_t)((i * 256) / LED_COUNT_PER_CH);
-    }
+    playback_build_phase_table(led_driver_get_leds_per_channel());
     // Initialize temporal buffers
     memset(s_temporal_ch1_u16, 0, sizeof(s_temporal_ch1_u16));
     memset(s_temporal_ch2_u16, 0, sizeof(s_temporal_ch2_u16));
@@ -518,210 +676,515 @@ esp_err_t playback_init(void) {
         return terr;
     }
 
+    // Loader command/retire queues; playback_loader_task consumes them
+    if (s_loader_queue == NULL) {
+        s_loader_queue = xQueueCreate(PLAYBACK_LOADER_QUEUE_LEN, sizeof(loader_cmd_t));
+    }
+    if (s_retire_queue == NULL) {
+        s_retire_queue = xQueueCreate(PLAYBACK_RETIRE_QUEUE_LEN, sizeof(pattern_runtime_t *));
+    }
+    if (s_publish_lock == NULL) {
+        s_publish_lock = xSemaphoreCreateMutex();
+    }
+    if (s_loader_queue == NULL || s_retire_queue == NULL || s_publish_lock == NULL) {
+        ESP_LOGE(TAG, "Failed to create pattern loader queues/lock");
+        return ESP_ERR_NO_MEM;
+    }
+
     ESP_LOGI(TAG, "Playback subsystem ready");
     s_pb.source = PLAYBACK_SOURCE_NONE;
     return ESP_OK;
 }
 
-void playback_task(void *pvParameters) {
-    ESP_LOGI(TAG, "Playback task started on core %d (HIGHEST priority)", xPortGetCoreID());
+#if PRISM_PERF_INSTRUMENTATION
+// Accumulate frame build time and log a summary once per second of frames
+static void playback_perf_record(int64_t build_dt)
+{
+    s_build_sum_us += (uint64_t)build_dt;
+    if ((uint64_t)build_dt > s_build_max_us) s_build_max_us = (uint64_t)build_dt;
+    s_build_samples++;
+    if ((s_pb.frame_counter % 120) == 0 && s_build_samples) {
+        uint64_t avg = s_build_sum_us / s_build_samples;
+        ESP_LOGI(TAG, "Frame build: samples=%lu max=%luus avg=%luus",
+                 (unsigned long)s_build_samples, (unsigned long)s_build_max_us, (unsigned long)avg);
+        s_build_sum_us = 0; s_build_max_us = 0; s_build_samples = 0;
+        if (s_blend_samples) {
+            ESP_LOGI(TAG, "Crossfade blend: samples=%lu max=%luus avg=%luus",
+                     (unsigned long)s_blend_samples, (unsigned long)s_blend_max_us,
+                     (unsigned long)(s_blend_sum_us / s_blend_samples));
+            s_blend_sum_us = 0; s_blend_max_us = 0; s_blend_samples = 0;
+        }
+    }
+}
 
-    TickType_t last_wake = xTaskGetTickCount();
+// Blend-only share of the frame build while a crossfade is running
+static void playback_perf_record_blend(int64_t blend_dt)
+{
+    s_blend_sum_us += (uint64_t)blend_dt;
+    if ((uint64_t)blend_dt > s_blend_max_us) s_blend_max_us = (uint64_t)blend_dt;
+    s_blend_samples++;
+}
+#endif
 
-    // Simple frame buffers for both channels (GRB)
-    static uint8_t frame_ch1[LED_FRAME_SIZE_CH];
-    static uint8_t frame_ch2[LED_FRAME_SIZE_CH];
+// Advance the pattern clock and decode however many frames have elapsed.
+// Delta frames must be decoded in order, so skipped frames are still decoded.
+static esp_err_t playback_pattern_advance(pattern_runtime_t *rt, int64_t now_us)
+{
+    if (__atomic_exchange_n(&s_seek_pending, false, __ATOMIC_ACQUIRE)) {
+        rt->last_frame_us = now_us;
+        return prism_decoder_seek(&rt->decoder, __atomic_load_n(&s_seek_target, __ATOMIC_RELAXED));
+    }
 
-    // Main render loop at LED_FPS_TARGET
-    while (1) {
-        if (s_pb.running) {
-            if (s_pb.source == PLAYBACK_SOURCE_PATTERN) {
-                if (s_pattern.loaded && s_pattern.frames && s_pattern.frame_count > 0) {
-                    int64_t now_us = esp_timer_get_time();
-                    if (s_pattern.last_frame_us == 0 || now_us < s_pattern.last_frame_us) {
-                        s_pattern.last_frame_us = now_us;
-                    }
-                    uint32_t interval_us = s_pattern.frame_interval_us ? s_pattern.frame_interval_us : (1000000 / LED_FPS_TARGET);
-                    if ((uint64_t)(now_us - s_pattern.last_frame_us) >= interval_us) {
-                        uint32_t advance = (uint32_t)((now_us - s_pattern.last_frame_us) / interval_us);
-                        if (advance == 0) {
-                            advance = 1;
-                        }
-                        s_pattern.last_frame_us += (int64_t)advance * interval_us;
-                        s_pattern.current_frame = (s_pattern.current_frame + advance) % s_pattern.frame_count;
-                    }
-
-                    const uint8_t *frame_ptr = s_pattern.frames + s_pattern.current_frame * s_pattern.frame_stride;
-                    memcpy(frame_ch1, frame_ptr, LED_FRAME_SIZE_CH);
-                    memcpy(frame_ch2, frame_ptr, LED_FRAME_SIZE_CH);
-
-                    int64_t now_us_fx = now_us;
-                    uint32_t elapsed_ms = 0;
-                    if (s_last_fx_tick_us == 0) {
-                        s_last_fx_tick_us = now_us_fx;
-                    } else {
-                        int64_t dt = now_us_fx - s_last_fx_tick_us;
-                        if (dt < 0) dt = 0;
-                        elapsed_ms = (uint32_t)(dt / 1000);
-                        s_last_fx_tick_us = now_us_fx;
-                    }
-                    if (elapsed_ms) {
-                        effect_engine_tick(elapsed_ms);
-                    }
-                    effect_chain_apply(frame_ch1, LED_COUNT_PER_CH);
-                    effect_chain_apply(frame_ch2, LED_COUNT_PER_CH);
-
-                    (void)led_driver_submit_frames(frame_ch1, frame_ch2);
-                    s_pb.frame_counter++;
+    if (rt->last_frame_us == 0 || now_us < rt->last_frame_us) {
+        rt->last_frame_us = now_us;
+    }
+    uint32_t interval_us = rt->frame_interval_us ? rt->frame_interval_us : (1000000 / LED_FPS_TARGET);
+    if ((uint64_t)(now_us - rt->last_frame_us) < interval_us) {
+        return ESP_OK;
+    }
+
+    uint32_t advance = (uint32_t)((now_us - rt->last_frame_us) / interval_us);
+    if (advance == 0) {
+        advance = 1;
+    }
+    rt->last_frame_us += (int64_t)advance * interval_us;
+
+    // Long stalls jump via the keyframe index (or a bounded replay without
+    // one) rather than decoding every skipped delta frame this tick.
+    if (advance > PLAYBACK_MAX_CATCHUP_FRAMES) {
+        uint32_t target = (uint32_t)((rt->decoder.frame_index + (uint64_t)advance) % rt->frame_count);
+        return prism_decoder_seek(&rt->decoder, target);
+    }
+
+    for (uint32_t i = 0; i < advance; ++i) {
+        esp_err_t ret = prism_decoder_next(&rt->decoder);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+// Adopt whatever the loader published since the last frame. Runs at the top
+// of the frame loop so a render never straddles two patterns.
+static void playback_adopt_pending(void)
+{
+    pattern_runtime_t *next = __atomic_exchange_n(&s_pattern_pending, NULL, __ATOMIC_ACQ_REL);
+    if (next == NULL) {
+        return;
+    }
+
+    pattern_runtime_t *old = s_pattern;
+    s_pattern = NULL;
+    __atomic_store_n(&s_seek_pending, false, __ATOMIC_RELAXED);
+
+    // A switch between two playing patterns crossfades: the current pattern
+    // becomes the outgoing source instead of being retired. Anything already
+    // fading out is dropped so only two decoders are ever live.
+    pattern_runtime_t *dropped = s_pattern_out;
+    s_pattern_out = NULL;
+    uint32_t transition_ms = s_transition_ms;
+    if (next != PATTERN_SWAP_STOP && old != NULL && transition_ms > 0 &&
+        s_pb.running && s_pb.source == PLAYBACK_SOURCE_PATTERN) {
+        s_pattern_out = old;
+        old = NULL;
+        s_transition_start_us = 0;   // Set from the first blended frame's presentation time
+        s_transition_us = transition_ms * 1000u;
+    }
+    pattern_runtime_retire(dropped);
+
+    if (next == PATTERN_SWAP_STOP) {
+        s_pattern_frame_count = 0;
+        if (s_pb.source == PLAYBACK_SOURCE_PATTERN) {
+            s_pb.running = false;
+            s_pb.source = PLAYBACK_SOURCE_NONE;
+        }
+    } else {
+        s_pattern = next;
+        s_pattern_frame_count = next->frame_count;
+        playback_start_pattern(next);
+        s_pb.frame_counter = 0;
+        s_last_fx_tick_us = 0;
+        s_pb.source = PLAYBACK_SOURCE_PATTERN;
+        s_pb.running = true;
+    }
+
+    pattern_runtime_retire(old);
+}
+
+// Render one frame into the next render-ahead slot of the LED driver,
+// timed for the frame clock slot it will be shown in. Returns true if the
+// queue may take another frame now; false once it is full, when there is
+// nothing to render, or when the driver is not initialized (the frame then
+// goes to local scratch and is dropped).
+//
+// Content is rendered for Channels 1 and 2 (the LGP edge pair); further
+// channels repeat them alternately.
+static bool playback_render_frame(void)
+{
+    static uint8_t scratch_ch1[LED_MAX_FRAME_SIZE_CH];
+    static uint8_t scratch_ch2[LED_MAX_FRAME_SIZE_CH];
+    led_frame_t frame;
+    uint8_t *frame_ch1 = scratch_ch1;
+    uint8_t *frame_ch2 = scratch_ch2;
+    uint16_t led_count = 0;
+    int64_t now_us = 0;   // Presentation time: all animation clocks run on it
+    bool lut_filled = false;
+
+    esp_err_t aerr = led_driver_acquire_frames(&frame);
+    if (aerr == ESP_ERR_NO_MEM) {
+        return false;   // Already rendered LED_RENDER_AHEAD_FRAMES ahead
+    }
+    bool acquired = (aerr == ESP_OK);
+    if (acquired) {
+        frame_ch1 = frame.ch[LED_CHANNEL_1];
+        if (frame.channel_count > 1) {
+            frame_ch2 = frame.ch[LED_CHANNEL_2];
+        }
+        led_count = frame.leds_per_channel;
+        now_us = frame.present_us;
+    } else {
+        led_count = led_driver_get_leds_per_channel();
+        now_us = esp_timer_get_time();
+    }
+
+    if (s_pb.source == PLAYBACK_SOURCE_PATTERN) {
+        if (s_pattern != NULL && s_pattern->frame_count > 0 &&
+            s_pattern->decoder.led_count == led_count) {
+#if PRISM_PERF_INSTRUMENTATION
+            int64_t build_t0 = esp_timer_get_time();
+#endif
+            esp_err_t derr = playback_pattern_advance(s_pattern, now_us);
+            if (derr != ESP_OK) {
+                ESP_LOGE(TAG, "Pattern '%s' decode failed at frame %" PRIu32 " (%s)",
+                         s_pattern->id, s_pattern->decoder.frame_index, esp_err_to_name(derr));
+                s_pb.running = false;
+                s_pb.source = PLAYBACK_SOURCE_NONE;
+                s_pattern_frame_count = 0;
+                s_pattern->unpin_on_free = true;
+                pattern_runtime_retire(s_pattern);
+                s_pattern = NULL;
+                pattern_runtime_retire(s_pattern_out);
+                s_pattern_out = NULL;
+                if (acquired) {
+                    (void)led_driver_cancel_frames();
                 }
+                return false;
+            }
+
+            int64_t now_us_fx = now_us;
+            uint32_t elapsed_ms = 0;
+            if (s_last_fx_tick_us == 0) {
+                s_last_fx_tick_us = now_us_fx;
             } else {
+                int64_t dt = now_us_fx - s_last_fx_tick_us;
+                if (dt < 0) dt = 0;
+                elapsed_ms = (uint32_t)(dt / 1000);
+                s_last_fx_tick_us = now_us_fx;
+            }
+            if (elapsed_ms) {
+                effect_engine_tick(elapsed_ms);
+            }
+
+            // Effects are per-component, so run the chain over the
+            // palette (<=64 entries) instead of every LED, then
+            // expand indices into both channels in one pass.
+            const prism_decoder_t *dec = &s_pattern->decoder;
+            uint8_t palette_fx[PRISM_DECODER_MAX_PALETTE * 3];
+            memcpy(palette_fx, dec->palette_grb, (size_t)dec->palette_count * 3);
+            effect_chain_apply(palette_fx, dec->palette_count);
+
+            // Delayed sync modes: CH2 replays CH1 from each LED's delay ago,
+            // gathered from the history instead of mirroring CH1
+            prism_history_t *history = &s_pattern->history;
+            prism_temporal_ctx_t *temporal = &s_pattern->temporal;
+            const bool delayed = prism_history_active(history) && history->led_count <= led_count;
+            uint8_t *expand_ch2 = frame_ch2;
+            if (delayed) {
+                if (temporal->map.wave_step != 0) {
+                    // Animated WAVE: the delays travel, so the lags follow
+                    prism_temporal_advance(temporal);
+                    prism_history_update_lags(history, &temporal->map);
+                }
+                temporal->frame_index++;
+                if (dec->frame_valid) {
+                    prism_history_push(history, dec->indices);
+                }
+                expand_ch2 = NULL;
+            }
+
+            // Outgoing pattern keeps its own clock until the fade ends
+            uint16_t weight = PRISM_BLEND_ONE;
+            if (s_pattern_out != NULL) {
+                if (s_transition_start_us == 0) {
+                    s_transition_start_us = now_us;   // Fade starts with its first frame
+                }
+                int64_t elapsed_us = now_us - s_transition_start_us;
+                if (elapsed_us < 0) {
+                    elapsed_us = 0;
+                }
+                if ((uint64_t)elapsed_us >= s_transition_us ||
+                    playback_pattern_advance(s_pattern_out, now_us) != ESP_OK) {
+                    pattern_runtime_retire(s_pattern_out);
+                    s_pattern_out = NULL;
+                } else {
+                    weight = (uint16_t)(((uint64_t)elapsed_us * PRISM_BLEND_ONE) / s_transition_us);
+                }
+            }
+
+            if (s_pattern_out != NULL) {
+                const prism_decoder_t *dec_out = &s_pattern_out->decoder;
+                uint8_t palette_out_fx[PRISM_DECODER_MAX_PALETTE * 3];
+                memcpy(palette_out_fx, dec_out->palette_grb, (size_t)dec_out->palette_count * 3);
+                effect_chain_apply(palette_out_fx, dec_out->palette_count);
+#if PRISM_PERF_INSTRUMENTATION
+                int64_t blend_t0 = esp_timer_get_time();
+#endif
+                prism_decoder_expand_blend(dec_out, palette_out_fx, dec, palette_fx, weight,
+                                           frame_ch1, frame_ch2);
+#if PRISM_PERF_INSTRUMENTATION
+                playback_perf_record_blend(esp_timer_get_time() - blend_t0);
+#endif
+            } else if (dec->keep_prev) {
+                // Sub-frame phase within the current source frame;
+                // playback_pattern_advance() keeps it in [0, interval)
+                uint32_t interval_us = s_pattern->frame_interval_us;
+                int64_t into_us = now_us - s_pattern->last_frame_us;
+                uint16_t phase = PRISM_BLEND_ONE;
+                if (into_us >= 0 && (uint64_t)into_us < interval_us) {
+                    phase = (uint16_t)(((uint64_t)into_us * PRISM_BLEND_ONE) / interval_us);
+                }
+                prism_decoder_expand_interp(dec, palette_fx, phase, frame_ch1, expand_ch2);
+            } else {
+                prism_decoder_expand_palette(dec, palette_fx, frame_ch1, expand_ch2);
+            }
+            if (delayed && s_pattern_out == NULL) {
+                prism_history_expand(history, palette_fx, dec->palette_count, frame_ch2);
+                // LEDs past the temporal model mirror CH1
+                memcpy(&frame_ch2[history->led_count * 3], &frame_ch1[history->led_count * 3],
+                       (size_t)(led_count - history->led_count) * 3);
+            }
 #if PRISM_PERF_INSTRUMENTATION
-                int64_t build_t0 = esp_timer_get_time();
+            playback_perf_record(esp_timer_get_time() - build_t0);
 #endif
-                // Minimal built-in effects (fast, integer math)
-                switch (s_pb.effect_id) {
-                    case EFFECT_WAVE_SINGLE: {
-                        uint32_t t0 = wave_prof_begin();
-                        uint8_t amp = (s_pb.param_count >= 1) ? s_pb.params[0] : 255;
-                        uint8_t spd = (s_pb.param_count >= 2) ? s_pb.params[1] : 2;
-                        uint8_t tphase = (uint8_t)(s_pb.frame_counter * spd);
-                        for (int i = 0; i < LED_COUNT_PER_CH; i++) {
-                            uint8_t phase = (uint8_t)(s_phase_per_led[i] + tphase);
-                            uint8_t s = sin8_table[phase];
-                            uint8_t val = (uint8_t)((uint16_t)s * amp / 255);
-                            frame_ch1[i * 3 + 0] = val;
-                            frame_ch1[i * 3 + 1] = 0;
-                            frame_ch1[i * 3 + 2] = 0;
-                            frame_ch2[i * 3 + 0] = val;
-                            frame_ch2[i * 3 + 1] = 0;
-                            frame_ch2[i * 3 + 2] = 0;
-                        }
-                        wave_prof_end(t0);
+        } else {
+            if (acquired) {
+                (void)led_driver_cancel_frames();
+            }
+            return false;
+        }
+    } else {
+#if PRISM_PERF_INSTRUMENTATION
+        int64_t build_t0 = esp_timer_get_time();
+#endif
+        // Minimal built-in effects (fast, integer math)
+        if (s_phase_led_count != led_count) {
+            playback_build_phase_table(led_count);
+        }
+        switch (s_pb.effect_id) {
+            case EFFECT_WAVE_SINGLE: {
+                uint32_t t0 = wave_prof_begin();
+                uint8_t amp = (s_pb.param_count >= 1) ? s_pb.params[0] : 255;
+                uint8_t spd = (s_pb.param_count >= 2) ? s_pb.params[1] : 2;
+                uint8_t tphase = (uint8_t)(s_pb.frame_counter * spd);
+                for (int i = 0; i < led_count; i++) {
+                    uint8_t phase = (uint8_t)(s_phase_per_led[i] + tphase);
+                    uint8_t s = sin8_table[phase];
+                    uint8_t val = (uint8_t)((uint16_t)s * amp / 255);
+                    frame_ch1[i * 3 + 0] = val;
+                    frame_ch1[i * 3 + 1] = 0;
+                    frame_ch1[i * 3 + 2] = 0;
+                    frame_ch2[i * 3 + 0] = val;
+                    frame_ch2[i * 3 + 1] = 0;
+                    frame_ch2[i * 3 + 2] = 0;
+                }
+                wave_prof_end(t0);
 #ifdef CONFIG_PRISM_PROFILE_TEMPORAL
-                        if ((s_pb.frame_counter % 120) == 0 && s_prof_wave.samples) {
-                            uint32_t avg = s_prof_wave.total_cycles / s_prof_wave.samples;
-                            unsigned long long d_hits = s_prof_wave.dcache_hits;
-                            unsigned long long d_miss = s_prof_wave.dcache_misses;
-                            unsigned long long d_tot  = d_hits + d_miss;
-                            unsigned long d_hit_pct = d_tot ? (unsigned long)((d_hits * 100ULL) / d_tot) : 0;
-                            unsigned long d_miss_pct = d_tot ? (unsigned long)((d_miss * 100ULL) / d_tot) : 0;
-
-                            unsigned long long i_hits = s_prof_wave.icache_hits;
-                            unsigned long long i_miss = s_prof_wave.icache_misses;
-                            unsigned long long i_tot  = i_hits + i_miss;
-                            unsigned long i_hit_pct = i_tot ? (unsigned long)((i_hits * 100ULL) / i_tot) : 0;
-                            unsigned long i_miss_pct = i_tot ? (unsigned long)((i_miss * 100ULL) / i_tot) : 0;
-
-                            unsigned long ipc_x100 = 0;
+                if ((s_pb.frame_counter % 120) == 0 && s_prof_wave.samples) {
+                    uint32_t avg = s_prof_wave.total_cycles / s_prof_wave.samples;
+                    unsigned long long d_hits = s_prof_wave.dcache_hits;
+                    unsigned long long d_miss = s_prof_wave.dcache_misses;
+                    unsigned long long d_tot  = d_hits + d_miss;
+                    unsigned long d_hit_pct = d_tot ? (unsigned long)((d_hits * 100ULL) / d_tot) : 0;
+                    unsigned long d_miss_pct = d_tot ? (unsigned long)((d_miss * 100ULL) / d_tot) : 0;
+
+                    unsigned long long i_hits = s_prof_wave.icache_hits;
+                    unsigned long long i_miss = s_prof_wave.icache_misses;
+                    unsigned long long i_tot  = i_hits + i_miss;
+                    unsigned long i_hit_pct = i_tot ? (unsigned long)((i_hits * 100ULL) / i_tot) : 0;
+                    unsigned long i_miss_pct = i_tot ? (unsigned long)((i_miss * 100ULL) / i_tot) : 0;
+
+                    unsigned long ipc_x100 = 0;
 #if CONFIG_PRISM_PROFILE_COUNT_INSN
-                            if (avg) ipc_x100 = (unsigned long)((s_prof_wave.insn_count * 100ULL) / avg);
+                    if (avg) ipc_x100 = (unsigned long)((s_prof_wave.insn_count * 100ULL) / avg);
 #endif
 
-                            ESP_LOGI(TAG, "WAVE prof: samples=%lu min=%lu max=%lu avg=%lu cycles | D$ hit/miss=%llu/%llu (%lu%%/%lu%%) | I$ hit/miss=%llu/%llu (%lu%%/%lu%%)%s%lu",
-                                     (unsigned long)s_prof_wave.samples,
-                                     (unsigned long)s_prof_wave.min_cycles,
-                                     (unsigned long)s_prof_wave.max_cycles,
-                                     (unsigned long)avg,
-                                     d_hits, d_miss, d_hit_pct, d_miss_pct,
-                                     i_hits, i_miss, i_hit_pct, i_miss_pct,
+                    ESP_LOGI(TAG, "WAVE prof: samples=%lu min=%lu max=%lu avg=%lu cycles | D$ hit/miss=%llu/%llu (%lu%%/%lu%%) | I$ hit/miss=%llu/%llu (%lu%%/%lu%%)%s%lu",
+                             (unsigned long)s_prof_wave.samples,
+                             (unsigned long)s_prof_wave.min_cycles,
+                             (unsigned long)s_prof_wave.max_cycles,
+                             (unsigned long)avg,
+                             d_hits, d_miss, d_hit_pct, d_miss_pct,
+                             i_hits, i_miss, i_hit_pct, i_miss_pct,
 #if CONFIG_PRISM_PROFILE_COUNT_INSN
-                                     " | IPC(x100)=",
+                             " | IPC(x100)=",
 #else
-                                     " | IPC(x100)=",
+                             " | IPC(x100)=",
 #endif
-                                     ipc_x100);
-                            s_prof_wave.total_cycles = 0;
-                            s_prof_wave.min_cycles = 0;
-                            s_prof_wave.max_cycles = 0;
-                            s_prof_wave.dcache_hits = 0;
-                            s_prof_wave.dcache_misses = 0;
-                            s_prof_wave.icache_hits = 0;
-                            s_prof_wave.icache_misses = 0;
-                            s_prof_wave.insn_count = 0;
-                            s_prof_wave.samples = 0;
-                        }
+                             ipc_x100);
+                    s_prof_wave.total_cycles = 0;
+                    s_prof_wave.min_cycles = 0;
+                    s_prof_wave.max_cycles = 0;
+                    s_prof_wave.dcache_hits = 0;
+                    s_prof_wave.dcache_misses = 0;
+                    s_prof_wave.icache_hits = 0;
+                    s_prof_wave.icache_misses = 0;
+                    s_prof_wave.insn_count = 0;
+                    s_prof_wave.samples = 0;
+                }
 #endif
-                        break;
-                    }
-                    case EFFECT_PALETTE_CYCLE:
-                    default: {
-                        uint8_t t = (uint8_t)(s_pb.frame_counter & 0xFF);
-                        uint8_t r = t;
-                        uint8_t g = 255 - t;
-                        uint8_t b = (t >> 1) ^ 0x7F;
-                        for (int i = 0; i < LED_COUNT_PER_CH; i++) {
-                            uint8_t o = (uint8_t)((i * 2 + t) & 0xFF);
-                            frame_ch1[i * 3 + 0] = g ^ o;
-                            frame_ch1[i * 3 + 1] = r ^ (o >> 1);
-                            frame_ch1[i * 3 + 2] = b ^ (o << 1);
-                            frame_ch2[i * 3 + 0] = frame_ch1[i * 3 + 0];
-                            frame_ch2[i * 3 + 1] = frame_ch1[i * 3 + 1];
-                            frame_ch2[i * 3 + 2] = frame_ch1[i * 3 + 2];
-                        }
-                        break;
-                    }
+                break;
+            }
+            case EFFECT_PALETTE_CYCLE:
+            default: {
+                uint8_t t = (uint8_t)(s_pb.frame_counter & 0xFF);
+                uint8_t r = t;
+                uint8_t g = 255 - t;
+                uint8_t b = (t >> 1) ^ 0x7F;
+                for (int i = 0; i < led_count; i++) {
+                    uint8_t o = (uint8_t)((i * 2 + t) & 0xFF);
+                    frame_ch1[i * 3 + 0] = g ^ o;
+                    frame_ch1[i * 3 + 1] = r ^ (o >> 1);
+                    frame_ch1[i * 3 + 2] = b ^ (o << 1);
+                    frame_ch2[i * 3 + 0] = frame_ch1[i * 3 + 0];
+                    frame_ch2[i * 3 + 1] = frame_ch1[i * 3 + 1];
+                    frame_ch2[i * 3 + 2] = frame_ch1[i * 3 + 2];
                 }
+                break;
+            }
+        }
 #if PRISM_PERF_INSTRUMENTATION
-                int64_t build_dt = esp_timer_get_time() - build_t0;
-                s_build_sum_us += (uint64_t)build_dt;
-                if ((uint64_t)build_dt > s_build_max_us) s_build_max_us = (uint64_t)build_dt;
-                s_build_samples++;
-                if ((s_pb.frame_counter % 120) == 0 && s_build_samples) {
-                    uint64_t avg = s_build_sum_us / s_build_samples;
-                    ESP_LOGI(TAG, "Frame build: samples=%lu max=%luus avg=%luus",
-                             (unsigned long)s_build_samples, (unsigned long)s_build_max_us, (unsigned long)avg);
-                    s_build_sum_us = 0; s_build_max_us = 0; s_build_samples = 0;
-                }
+        playback_perf_record(esp_timer_get_time() - build_t0);
 #endif
-                for (int i = 0; i < LED_COUNT_PER_CH; ++i) {
-                    uint8_t g = frame_ch1[i * 3 + 0];
-                    uint8_t r = frame_ch1[i * 3 + 1];
-                    uint8_t b = frame_ch1[i * 3 + 2];
-                    uint8_t maxc = g;
-                    if (r > maxc) maxc = r;
-                    if (b > maxc) maxc = b;
-                    s_temporal_ch1_u16[i] = (uint16_t)(maxc * 257u);
-                }
+        // The temporal model covers the LGP edge length; any LEDs past it
+        // on longer strips copy CH1 unmasked
+        const uint16_t temporal_count = (led_count < PRISM_LGP_LED_COUNT) ? led_count : PRISM_LGP_LED_COUNT;
+        for (int i = 0; i < temporal_count; ++i) {
+            uint8_t g = frame_ch1[i * 3 + 0];
+            uint8_t r = frame_ch1[i * 3 + 1];
+            uint8_t b = frame_ch1[i * 3 + 2];
+            uint8_t maxc = g;
+            if (r > maxc) maxc = r;
+            if (b > maxc) maxc = b;
+            s_temporal_ch1_u16[i] = (uint16_t)(maxc * 257u);
+        }
 
-                playback_update_timing();
-                calculate_ch2_frame(&temporal_ctx, s_temporal_ch1_u16, s_temporal_ch2_u16, PRISM_LGP_LED_COUNT);
-                temporal_ctx.frame_index++;
-
-                for (int i = 0; i < LED_COUNT_PER_CH; ++i) {
-                    if (s_temporal_ch2_u16[i] == 0) {
-                        frame_ch2[i * 3 + 0] = 0;
-                        frame_ch2[i * 3 + 1] = 0;
-                        frame_ch2[i * 3 + 2] = 0;
-                    } else {
-                        frame_ch2[i * 3 + 0] = frame_ch1[i * 3 + 0];
-                        frame_ch2[i * 3 + 1] = frame_ch1[i * 3 + 1];
-                        frame_ch2[i * 3 + 2] = frame_ch1[i * 3 + 2];
-                    }
-                }
+        playback_update_timing(now_us);
+        calculate_ch2_frame(&temporal_ctx, s_temporal_ch1_u16, s_temporal_ch2_u16, temporal_count);
+        temporal_ctx.frame_index++;
 
-                int64_t now_us_fx = esp_timer_get_time();
-                uint32_t elapsed_ms = 0;
-                if (s_last_fx_tick_us == 0) {
-                    s_last_fx_tick_us = now_us_fx;
-                } else {
-                    int64_t dt = now_us_fx - s_last_fx_tick_us;
-                    if (dt < 0) dt = 0;
-                    elapsed_ms = (uint32_t)(dt / 1000);
-                    s_last_fx_tick_us = now_us_fx;
-                }
-                if (elapsed_ms) {
-                    effect_engine_tick(elapsed_ms);
-                }
-                effect_chain_apply(frame_ch1, LED_COUNT_PER_CH);
-                effect_chain_apply(frame_ch2, LED_COUNT_PER_CH);
+        int64_t now_us_fx = now_us;
+        uint32_t elapsed_ms = 0;
+        if (s_last_fx_tick_us == 0) {
+            s_last_fx_tick_us = now_us_fx;
+        } else {
+            int64_t dt = now_us_fx - s_last_fx_tick_us;
+            if (dt < 0) dt = 0;
+            elapsed_ms = (uint32_t)(dt / 1000);
+            s_last_fx_tick_us = now_us_fx;
+        }
+        if (elapsed_ms) {
+            effect_engine_tick(elapsed_ms);
+        }
 
-                (void)led_driver_submit_frames(frame_ch1, frame_ch2);
-                s_pb.frame_counter++;
+        // CH2 is a masked copy of CH1, so run the compiled chain over
+        // CH1 once and copy; masked pixels get the chain's image of black.
+        // With an output LUT the encoder applies the chain instead.
+        uint8_t fx_black[3] = {0, 0, 0};
+        if (acquired && frame.output_lut != NULL) {
+            effect_chain_get_lut(frame.output_lut->component);
+            lut_filled = true;
+        } else {
+            effect_chain_apply(fx_black, 1);
+            effect_chain_apply(frame_ch1, led_count);
+        }
+        for (int i = 0; i < led_count; ++i) {
+            bool masked = (i < temporal_count) && (s_temporal_ch2_u16[i] == 0);
+            const uint8_t *src = masked ? fx_black : &frame_ch1[i * 3];
+            frame_ch2[i * 3 + 0] = src[0];
+            frame_ch2[i * 3 + 1] = src[1];
+            frame_ch2[i * 3 + 2] = src[2];
+        }
+    }
+    s_pb.frame_counter++;
+
+    if (!acquired) {
+        return false;
+    }
+    for (uint8_t ch = 2; ch < frame.channel_count; ++ch) {
+        memcpy(frame.ch[ch], frame.ch[ch % 2], (size_t)led_count * LED_BYTES_PER_LED);
+    }
+    // Patterns apply effects to the palette before blending, so they go
+    // out unchanged
+    if (frame.output_lut != NULL && !lut_filled) {
+        ws2812_output_lut_identity(frame.output_lut);
+    }
+    (void)led_driver_commit_frames();
+    return true;
+}
+
+// Queue an all-black frame on every channel
+static bool playback_blank(void)
+{
+    led_frame_t frame;
+    if (led_driver_acquire_frames(&frame) != ESP_OK) {
+        return false;
+    }
+    for (uint8_t ch = 0; ch < frame.channel_count; ++ch) {
+        memset(frame.ch[ch], 0, (size_t)frame.leds_per_channel * LED_BYTES_PER_LED);
+    }
+    if (frame.output_lut != NULL) {
+        ws2812_output_lut_identity(frame.output_lut);
+    }
+    return led_driver_commit_frames() == ESP_OK;
+}
+
+// Block until the driver's frame clock asks for the next frame. The timeout
+// only paces the loop (adopting loads, blanking) while the driver is stopped.
+static inline void playback_wait_frame(void)
+{
+    (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LED_FRAME_TIME_MS * 2));
+}
+
+void playback_task(void *pvParameters) {
+    ESP_LOGI(TAG, "Playback task started on core %d (HIGHEST priority)", xPortGetCoreID());
+
+    (void)led_driver_set_render_task(xTaskGetCurrentTaskHandle(), PLAYBACK_RENDER_LEAD_US);
+
+    // This task is the driver's only frame producer, so stops from other
+    // tasks just clear s_pb.running and the blank frame is sent from here
+    bool blanked = true;
+
+    // Main render loop, woken by the driver's frame clock
+    while (1) {
+        playback_adopt_pending();
+
+        if (!s_pb.running && !blanked) {
+            blanked = playback_blank();
+        }
+
+        if (s_pb.running) {
+            blanked = false;
+            // One frame per wake in steady state; after a stall keep
+            // rendering until the render-ahead queue is full again
+            for (int n = 0; n < LED_RENDER_AHEAD_FRAMES && s_pb.running; ++n) {
+                if (!playback_render_frame()) {
+                    break;
+                }
             }
         }
 
-        // 120 FPS frame time
-        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(LED_FRAME_TIME_MS));
+        playback_wait_frame();
     }
 
     ESP_LOGW(TAG, "Playback task exiting (unexpected)");
@@ -734,9 +1197,9 @@ esp_err_t playback_deinit(void) {
     return ESP_OK;
 }
 
-esp_err_t playback_play_builtin(uint16_t effect_id, const uint8_t* params, uint8_t param_count)
+// Ensure the LED driver is initialized and running
+static esp_err_t playback_ensure_driver(void)
 {
-    // Ensure LED driver is initialized and running
     esp_err_t ret = led_driver_init();
     if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
         ESP_LOGE(TAG, "LED driver init failed: %s", esp_err_to_name(ret));
@@ -747,9 +1210,20 @@ esp_err_t playback_play_builtin(uint16_t effect_id, const uint8_t* params, uint8
         ESP_LOGE(TAG, "LED driver start failed: %s", esp_err_to_name(ret));
         return ret;
     }
+    return ESP_OK;
+}
+
+esp_err_t playback_play_builtin(uint16_t effect_id, const uint8_t* params, uint8_t param_count)
+{
+    esp_err_t ret = playback_ensure_driver();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Cancel in-flight loads and have playback_task drop the active pattern
+    pattern_publish_stop();
 
     // Set playback state
-    playback_free_pattern();
     s_pb.effect_id = effect_id;
     s_pb.param_count = (param_count > 8) ? 8 : param_count;
     if (params && s_pb.param_count) {
@@ -767,20 +1241,39 @@ esp_err_t playback_play_builtin(uint16_t effect_id, const uint8_t* params, uint8
     return ESP_OK;
 }
 
-esp_err_t playback_play_prism_blob(const char *pattern_id, const uint8_t *blob, size_t blob_size)
+// Validate a .prism blob and build a ready-to-adopt runtime with frame 0
+// decoded. Takes ownership of the blob: release runs on failure, or later
+// when the runtime is freed.
+static esp_err_t pattern_runtime_build(const char *pattern_id, const uint8_t *blob, size_t blob_size,
+                                       playback_blob_release_fn release, void *release_ctx,
+                                       pattern_runtime_t **out)
 {
+    *out = NULL;
     if (blob == NULL || blob_size < sizeof(prism_header_v10_t)) {
+        if (release) {
+            release(release_ctx);
+        }
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Stop any existing playback and clear state
-    (void)playback_stop();
+    pattern_runtime_t *rt = (pattern_runtime_t *)calloc(1, sizeof(*rt));
+    if (rt == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate pattern runtime");
+        if (release) {
+            release(release_ctx);
+        }
+        return ESP_ERR_NO_MEM;
+    }
+    rt->blob = blob;
+    rt->blob_size = blob_size;
+    rt->blob_release = release;
+    rt->blob_release_ctx = release_ctx;
 
     prism_header_v11_t header = {0};
     esp_err_t ret = parse_prism_header(blob, blob_size, &header);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to parse .prism header (%s)", esp_err_to_name(ret));
-        return ret;
+        goto fail;
     }
 
     size_t offset = sizeof(prism_header_v10_t);
@@ -788,18 +1281,20 @@ esp_err_t playback_play_prism_blob(const char *pattern_id, const uint8_t *blob,
         offset += sizeof(prism_pattern_meta_v11_t);
     }
 
+    ret = ESP_ERR_INVALID_SIZE;
     if (offset + 2 > blob_size) {
-        return ESP_ERR_INVALID_SIZE;
+        goto fail;
     }
     uint16_t extra_len = (uint16_t)(blob[offset] | ((uint16_t)blob[offset + 1] << 8));
     offset += 2;
     if (offset + extra_len > blob_size) {
-        return ESP_ERR_INVALID_SIZE;
+        goto fail;
     }
+    const char *extra = (const char *)(blob + offset);
     offset += extra_len;
 
     if (offset + 4 > blob_size) {
-        return ESP_ERR_INVALID_SIZE;
+        goto fail;
     }
 
     size_t payload_len = blob_size - offset - 4;
@@ -814,269 +1309,400 @@ esp_err_t playback_play_prism_blob(const char *pattern_id, const uint8_t *blob,
     if (calc_crc != expected_crc) {
         ESP_LOGE(TAG, "Payload CRC mismatch (expected=0x%08" PRIX32 " got=0x%08" PRIX32 ")",
                  expected_crc, calc_crc);
-        return ESP_ERR_INVALID_CRC;
+        ret = ESP_ERR_INVALID_CRC;
+        goto fail;
     }
 
     uint32_t led_count = header.base.led_count;
-    if (led_count != LED_COUNT_PER_CH) {
-        ESP_LOGE(TAG, "Unsupported LED count %u (expected %d)", led_count, LED_COUNT_PER_CH);
-        return ESP_ERR_INVALID_SIZE;
+    uint16_t channel_leds = led_driver_get_leds_per_channel();
+    if (led_count != channel_leds) {
+        ESP_LOGE(TAG, "Unsupported LED count %u (channels have %u)", led_count, (unsigned)channel_leds);
+        goto fail;
     }
 
     uint32_t frame_count = header.base.frame_count;
     if (frame_count == 0) {
         ESP_LOGE(TAG, "Pattern has zero frames");
-        return ESP_ERR_INVALID_SIZE;
+        goto fail;
     }
 
-    size_t frame_stride = LED_FRAME_SIZE_CH;
-    size_t frames_size = (size_t)frame_count * frame_stride;
-    uint8_t *frames_buf = (uint8_t *)malloc(frames_size);
-    if (!frames_buf) {
-        ESP_LOGE(TAG, "Failed to allocate frame buffer (%zu bytes)", frames_size);
-        return ESP_ERR_NO_MEM;
+    // Bind the streaming decoder and decode frame 0 up front so the first
+    // tick has something to show; later frames decode one per tick.
+    ret = prism_decoder_init(&rt->decoder, payload, payload_len, frame_count, (uint16_t)led_count);
+    if (ret == ESP_OK) {
+        ret = prism_decoder_next(&rt->decoder);
     }
-
-    uint8_t *decoded = (uint8_t *)malloc(led_count);
-    uint8_t *prev = (uint8_t *)calloc(led_count, 1);
-    uint8_t *rle_buf = (uint8_t *)malloc(led_count);
-    if (!decoded || !prev || !rle_buf) {
-        free(frames_buf);
-        if (decoded) free(decoded);
-        if (prev) free(prev);
-        if (rle_buf) free(rle_buf);
-        return ESP_ERR_NO_MEM;
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to decode first frame (%s)", esp_err_to_name(ret));
+        goto fail;
     }
 
-    bool prev_valid = false;
-    const uint8_t *cursor = payload;
-    const uint8_t *end = payload + payload_len;
-
-    if (cursor + 2 > end) {
-        free(frames_buf);
-        free(decoded);
-        free(prev);
-        free(rle_buf);
-        return ESP_ERR_INVALID_SIZE;
+    // Optional keyframe index; patterns without one seek by replaying deltas
+    esp_err_t seek_ret = prism_seek_index_parse(extra, extra_len, frame_count, &rt->seek_index);
+    if (seek_ret == ESP_OK) {
+        seek_ret = prism_decoder_set_seek_index(&rt->decoder, &rt->seek_index);
+        if (seek_ret != ESP_OK) {
+            prism_seek_index_free(&rt->seek_index);
+        }
     }
-
-    uint16_t palette_entries = (uint16_t)(cursor[0] | (cursor[1] << 8));
-    cursor += 2;
-    if (palette_entries == 0 || palette_entries > PRISM_MAX_PALETTE) {
-        free(frames_buf);
-        free(decoded);
-        free(prev);
-        free(rle_buf);
-        ESP_LOGE(TAG, "Invalid palette size %u", palette_entries);
-        return ESP_ERR_INVALID_SIZE;
+    if (seek_ret != ESP_OK && seek_ret != ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG, "Ignoring invalid seek index (%s)", esp_err_to_name(seek_ret));
     }
 
-    if (cursor + palette_entries * 3 > end) {
-        free(frames_buf);
-        free(decoded);
-        free(prev);
-        free(rle_buf);
-        return ESP_ERR_INVALID_SIZE;
+    rt->frame_count = frame_count;
+    rt->led_count = led_count;
+    rt->last_frame_us = 0;
+    rt->header = header;
+    if (pattern_id && pattern_id[0]) {
+        strlcpy(rt->id, pattern_id, sizeof(rt->id));
     }
 
-    uint8_t palette_grb[PRISM_MAX_PALETTE * 3];
-    for (uint16_t i = 0; i < palette_entries; ++i) {
-        uint8_t r = cursor[i * 3 + 0];
-        uint8_t g = cursor[i * 3 + 1];
-        uint8_t b = cursor[i * 3 + 2];
-        palette_grb[i * 3 + 0] = g;
-        palette_grb[i * 3 + 1] = r;
-        palette_grb[i * 3 + 2] = b;
+    double fps = (header.base.fps > 0) ? ((double)header.base.fps / 256.0) : LED_FPS_TARGET;
+    if (fps <= 0.0) {
+        fps = LED_FPS_TARGET;
+    }
+    uint32_t interval_us = (uint32_t)(1000000.0 / fps);
+    if (interval_us == 0) {
+        interval_us = 1000000 / LED_FPS_TARGET;
+    }
+    rt->frame_interval_us = interval_us;
+
+    // Only patterns slower than the output rate have sub-frames to fill
+    rt->decoder.keep_prev = s_interpolate && interval_us > (1000000 / LED_FPS_TARGET);
+
+    // Compile the per-LED delay map and size the CH1 history for its largest
+    // delay here, so playback_task neither allocates nor plays without it
+    update_temporal_context(&rt->temporal, &header.meta);
+    ret = prism_temporal_compile(&rt->temporal,
+                                 (channel_leds < PRISM_LGP_LED_COUNT) ? channel_leds : PRISM_LGP_LED_COUNT);
+    if (ret == ESP_OK) {
+        ret = prism_history_init(&rt->history, &rt->temporal.map, LED_FRAME_PERIOD_US);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up CH1 history (%s)", esp_err_to_name(ret));
+        goto fail;
     }
-    cursor += palette_entries * 3;
-
-    for (uint32_t frame_idx = 0; frame_idx < frame_count; ++frame_idx) {
-        if (cursor + 3 > end) {
-            ret = ESP_ERR_INVALID_SIZE;
-            break;
-        }
 
-        uint8_t flags = cursor[0];
-        uint16_t segment_len = (uint16_t)(cursor[1] | (cursor[2] << 8));
-        cursor += 3;
+    ESP_LOGI(TAG, "Pattern loaded: id='%s' frames=%u fps=%.2f interval_us=%u keyframe_interval=%" PRIu32 " interp=%d",
+             rt->id, frame_count, fps, rt->frame_interval_us, rt->decoder.seek.interval,
+             (int)rt->decoder.keep_prev);
+    *out = rt;
+    return ESP_OK;
 
-        if (cursor + segment_len > end) {
-            ret = ESP_ERR_INVALID_SIZE;
-            break;
-        }
+fail:
+    pattern_runtime_free(rt);
+    return ret;
+}
 
-        const uint8_t *segment = cursor;
-        cursor += segment_len;
-
-        size_t produced = 0;
-        if (flags & PRISM_FLAG_RLE) {
-            size_t out_idx = 0;
-            size_t pos = 0;
-            while (pos < segment_len && out_idx < led_count) {
-                uint8_t value = segment[pos++];
-                if (value & PRISM_RLE_MARK) {
-                    uint8_t run_len = value & PRISM_RLE_MASK;
-                    if (pos >= segment_len) {
-                        ret = ESP_ERR_INVALID_SIZE;
-                        break;
-                    }
-                    uint8_t run_val = segment[pos++];
-                    for (uint8_t c = 0; c < run_len && out_idx < led_count; ++c) {
-                        rle_buf[out_idx++] = run_val;
-                    }
-                } else {
-                    rle_buf[out_idx++] = value;
-                }
-            }
-            if (ret != ESP_OK) {
-                break;
-            }
-            if (out_idx != led_count) {
-                ret = ESP_ERR_INVALID_SIZE;
-                break;
-            }
-            memcpy(decoded, rle_buf, led_count);
-            produced = out_idx;
-        } else {
-            if (segment_len < led_count) {
-                ret = ESP_ERR_INVALID_SIZE;
-                break;
-            }
-            memcpy(decoded, segment, led_count);
-            produced = led_count;
-        }
+void playback_release_cache_handle(void *ctx)
+{
+    pattern_cache_release((pattern_cache_handle_t)ctx);
+}
 
-        if (produced != led_count) {
-            ret = ESP_ERR_INVALID_SIZE;
-            break;
-        }
+static bool loader_cmd_stale(const loader_cmd_t *cmd)
+{
+    return cmd->seq != __atomic_load_n(&s_load_seq, __ATOMIC_ACQUIRE);
+}
 
-        if (flags & PRISM_FLAG_DELTA) {
-            if (!prev_valid) {
-                ret = ESP_ERR_INVALID_STATE;
-                break;
-            }
-            for (uint32_t i = 0; i < led_count; ++i) {
-                decoded[i] ^= prev[i];
-            }
+// Build and publish the pattern for one command. Never touches s_pattern;
+// playback_task picks the result up at its next frame boundary.
+static esp_err_t loader_execute(const loader_cmd_t *cmd)
+{
+    const uint8_t *blob = cmd->blob;
+    size_t blob_size = cmd->blob_size;
+    playback_blob_release_fn release = cmd->release;
+    void *release_ctx = cmd->release_ctx;
+
+    // A later play/stop request already superseded this one
+    if (loader_cmd_stale(cmd)) {
+        if (cmd->type == LOADER_CMD_BLOB && release) {
+            release(release_ctx);
         }
+        return ESP_ERR_INVALID_STATE;
+    }
 
-        memcpy(prev, decoded, led_count);
-        prev_valid = true;
-
-        uint8_t *dst = frames_buf + frame_idx * frame_stride;
-        for (uint32_t i = 0; i < led_count; ++i) {
-            uint8_t idx = decoded[i];
-            if (idx >= palette_entries) {
-                ret = ESP_ERR_INVALID_SIZE;
-                break;
-            }
-            const uint8_t *grb = &palette_grb[idx * 3];
-            dst[i * 3 + 0] = grb[0];
-            dst[i * 3 + 1] = grb[1];
-            dst[i * 3 + 2] = grb[2];
-        }
+    if (cmd->type == LOADER_CMD_STORAGE) {
+        // Pin the blob (cache hit or fresh exact-size read) and stream from it
+        // in place; the pin is dropped when the runtime is freed.
+        pattern_cache_handle_t handle = NULL;
+        esp_err_t ret = storage_pattern_acquire(cmd->id, &handle, &blob, &blob_size);
         if (ret != ESP_OK) {
-            break;
+            return ret;
         }
+        release = playback_release_cache_handle;
+        release_ctx = handle;
     }
 
-    free(decoded);
-    free(prev);
-    free(rle_buf);
-
+    esp_err_t ret = playback_ensure_driver();
     if (ret != ESP_OK) {
-        free(frames_buf);
+        if (release) {
+            release(release_ctx);
+        }
         return ret;
     }
 
-    ret = led_driver_init();
-    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
-        free(frames_buf);
-        ESP_LOGE(TAG, "LED driver init failed: %s", esp_err_to_name(ret));
+    pattern_runtime_t *rt = NULL;
+    ret = pattern_runtime_build(cmd->id, blob, blob_size, release, release_ctx, &rt);
+    if (ret != ESP_OK) {
         return ret;
     }
-    ret = led_driver_start();
-    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
-        free(frames_buf);
-        ESP_LOGE(TAG, "LED driver start failed: %s", esp_err_to_name(ret));
-        return ret;
+    // Re-check and publish under the publish lock: a stop/builtin either
+    // lands first (and this load is stale) or after, superseding it
+    publish_lock();
+    if (loader_cmd_stale(cmd)) {
+        publish_unlock();
+        pattern_runtime_free(rt);
+        return ESP_ERR_INVALID_STATE;
     }
+    // Keep the playing pattern cached past its runtime (e.g. across a stop
+    // and replay); blobs not held through a cache handle just clear the slot.
+    // Pinned before publishing, while the loader still owns rt.
+    (void)pattern_cache_pin(PATTERN_CACHE_PIN_ACTIVE, pattern_runtime_cache_handle(rt));
+    pattern_publish(rt);
+    publish_unlock();
+    return ESP_OK;
+}
 
-    playback_free_pattern();
-    s_pattern.frames = frames_buf;
-    s_pattern.frame_stride = frame_stride;
-    s_pattern.frame_count = frame_count;
-    s_pattern.current_frame = 0;
-    s_pattern.led_count = led_count;
-    s_pattern.last_frame_us = 0;
-    s_pattern.header = header;
-    s_pattern.loaded = true;
-    if (pattern_id && pattern_id[0]) {
-        strlcpy(s_pattern.id, pattern_id, sizeof(s_pattern.id));
-    } else {
-        s_pattern.id[0] = '\0';
+static void loader_drain_retired(void)
+{
+    pattern_runtime_t *rt = NULL;
+    while (s_retire_queue && xQueueReceive(s_retire_queue, &rt, 0) == pdTRUE) {
+        pattern_runtime_free(rt);
     }
+}
 
-    double fps = (header.base.fps > 0) ? ((double)header.base.fps / 256.0) : LED_FPS_TARGET;
-    if (fps <= 0.0) {
-        fps = LED_FPS_TARGET;
-    }
-    uint32_t interval_us = (uint32_t)(1000000.0 / fps);
-    if (interval_us == 0) {
-        interval_us = 1000000 / LED_FPS_TARGET;
+void playback_loader_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Pattern loader task started on core %d", xPortGetCoreID());
+    s_loader_running = true;
+
+    loader_cmd_t cmd;
+    while (1) {
+        if (xQueueReceive(s_loader_queue, &cmd, pdMS_TO_TICKS(PLAYBACK_LOADER_IDLE_MS)) == pdTRUE) {
+            esp_err_t ret = loader_execute(&cmd);
+            if (ret != ESP_OK) {
+                ESP_LOGW(TAG, "Load of '%s' failed: %s", cmd.id, esp_err_to_name(ret));
+            }
+            if (cmd.done) {
+                cmd.done(ret, cmd.id, cmd.done_ctx);
+            }
+        }
+        loader_drain_retired();
     }
-    s_pattern.frame_interval_us = interval_us;
+}
 
-    playback_start_pattern(&header.meta);
-    s_pb.running = true;
-    s_pb.source = PLAYBACK_SOURCE_PATTERN;
-    s_pb.frame_counter = 0;
-    s_last_fx_tick_us = 0;
+// Queue a load for the loader task, or run it inline on the caller if the
+// loader has not been started (unit tests, early boot).
+static esp_err_t loader_submit(loader_cmd_t *cmd)
+{
+    cmd->seq = __atomic_add_fetch(&s_load_seq, 1, __ATOMIC_ACQ_REL);
+
+    if (!s_loader_running || s_loader_queue == NULL) {
+        // Same contract as the queued path: done only runs when we return
+        // ESP_OK, so callers that handle an error return don't report twice
+        esp_err_t ret = loader_execute(cmd);
+        if (ret == ESP_OK && cmd->done) {
+            cmd->done(ret, cmd->id, cmd->done_ctx);
+        }
+        return ret;
+    }
 
-    ESP_LOGI(TAG, "Pattern playback started: id='%s' frames=%u fps=%.2f interval_us=%u",
-             s_pattern.id, frame_count, fps, s_pattern.frame_interval_us);
+    if (xQueueSend(s_loader_queue, cmd, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Loader queue full, rejecting '%s'", cmd->id);
+        if (cmd->type == LOADER_CMD_BLOB && cmd->release) {
+            cmd->release(cmd->release_ctx);
+        }
+        return ESP_ERR_NO_MEM;
+    }
     return ESP_OK;
 }
 
-esp_err_t playback_play_pattern_from_storage(const char *pattern_id)
+esp_err_t playback_load_pattern_async(const char *pattern_id, playback_load_cb_t done, void *ctx)
 {
     if (!pattern_id || pattern_id[0] == '\0') {
         return ESP_ERR_INVALID_ARG;
     }
+    loader_cmd_t cmd = {
+        .type = LOADER_CMD_STORAGE,
+        .done = done,
+        .done_ctx = ctx,
+    };
+    strlcpy(cmd.id, pattern_id, sizeof(cmd.id));
+    return loader_submit(&cmd);
+}
 
-    uint8_t *buffer = (uint8_t *)malloc(PATTERN_MAX_SIZE);
-    if (!buffer) {
-        return ESP_ERR_NO_MEM;
+esp_err_t playback_preload_next(const char *pattern_id)
+{
+    if (!pattern_id) {
+        return pattern_cache_pin(PATTERN_CACHE_PIN_NEXT, NULL);
     }
-
-    size_t bytes_read = 0;
-    esp_err_t ret = storage_pattern_read(pattern_id, buffer, PATTERN_MAX_SIZE, &bytes_read);
+    // Warm the cache (flash read + CRC on a miss), then let the NEXT slot
+    // hold the pin until the pattern plays or another one replaces it
+    pattern_cache_handle_t handle = NULL;
+    const uint8_t *blob = NULL;
+    size_t blob_size = 0;
+    esp_err_t ret = storage_pattern_acquire(pattern_id, &handle, &blob, &blob_size);
     if (ret != ESP_OK) {
-        free(buffer);
         return ret;
     }
+    // Not found here means the load bypassed the cache (no room)
+    ret = pattern_cache_pin(PATTERN_CACHE_PIN_NEXT, handle);
+    pattern_cache_release(handle);
+    return (ret == ESP_ERR_NOT_FOUND) ? ESP_ERR_NO_MEM : ret;
+}
+
+esp_err_t playback_load_prism_async(const char *pattern_id, const uint8_t *blob, size_t blob_size,
+                                    playback_blob_release_fn release, void *release_ctx,
+                                    playback_load_cb_t done, void *ctx)
+{
+    if (blob == NULL || blob_size < sizeof(prism_header_v10_t)) {
+        if (release) {
+            release(release_ctx);
+        }
+        return ESP_ERR_INVALID_ARG;
+    }
+    loader_cmd_t cmd = {
+        .type = LOADER_CMD_BLOB,
+        .blob = blob,
+        .blob_size = blob_size,
+        .release = release,
+        .release_ctx = release_ctx,
+        .done = done,
+        .done_ctx = ctx,
+    };
+    if (pattern_id) {
+        strlcpy(cmd.id, pattern_id, sizeof(cmd.id));
+    }
+    return loader_submit(&cmd);
+}
+
+typedef struct {
+    SemaphoreHandle_t done;
+    esp_err_t result;
+} playback_load_wait_t;
+
+static void playback_load_wait_cb(esp_err_t result, const char *pattern_id, void *ctx)
+{
+    (void)pattern_id;
+    playback_load_wait_t *wait = (playback_load_wait_t *)ctx;
+    wait->result = result;
+    xSemaphoreGive(wait->done);
+}
+
+// Blocking wrapper for callers that want the load result inline. Only the
+// caller blocks; playback_task keeps rendering the current pattern.
+static esp_err_t playback_load_and_wait(loader_cmd_t *cmd)
+{
+    playback_load_wait_t wait = {
+        .done = xSemaphoreCreateBinary(),
+        .result = ESP_FAIL,
+    };
+    if (wait.done == NULL) {
+        if (cmd->type == LOADER_CMD_BLOB && cmd->release) {
+            cmd->release(cmd->release_ctx);
+        }
+        return ESP_ERR_NO_MEM;
+    }
+    cmd->done = playback_load_wait_cb;
+    cmd->done_ctx = &wait;
 
-    ret = playback_play_prism_blob(pattern_id, buffer, bytes_read);
-    free(buffer);
+    esp_err_t ret = loader_submit(cmd);
+    if (ret == ESP_OK) {
+        (void)xSemaphoreTake(wait.done, portMAX_DELAY);
+        ret = wait.result;
+    }
+    vSemaphoreDelete(wait.done);
     return ret;
 }
 
+esp_err_t playback_play_prism_borrowed(const char *pattern_id, const uint8_t *blob, size_t blob_size,
+                                       playback_blob_release_fn release, void *release_ctx)
+{
+    if (blob == NULL || blob_size < sizeof(prism_header_v10_t)) {
+        if (release) {
+            release(release_ctx);
+        }
+        return ESP_ERR_INVALID_ARG;
+    }
+    loader_cmd_t cmd = {
+        .type = LOADER_CMD_BLOB,
+        .blob = blob,
+        .blob_size = blob_size,
+        .release = release,
+        .release_ctx = release_ctx,
+    };
+    if (pattern_id) {
+        strlcpy(cmd.id, pattern_id, sizeof(cmd.id));
+    }
+    return playback_load_and_wait(&cmd);
+}
+
+esp_err_t playback_play_prism_blob(const char *pattern_id, const uint8_t *blob, size_t blob_size)
+{
+    return playback_play_prism_borrowed(pattern_id, blob, blob_size, NULL, NULL);
+}
+
+esp_err_t playback_play_pattern_from_storage(const char *pattern_id)
+{
+    if (!pattern_id || pattern_id[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+    loader_cmd_t cmd = {
+        .type = LOADER_CMD_STORAGE,
+    };
+    strlcpy(cmd.id, pattern_id, sizeof(cmd.id));
+    return playback_load_and_wait(&cmd);
+}
+
 esp_err_t playback_stop(void)
 {
+    // Cancel in-flight loads and any published-but-unadopted pattern even
+    // when idle, so a queued PLAY cannot start after the stop
+    pattern_publish_stop();
     if (!s_pb.running) {
         return ESP_OK;
     }
-    playback_free_pattern();
     s_pb.running = false;
     s_pb.source = PLAYBACK_SOURCE_NONE;
-    // Clear LEDs once
-    static uint8_t black[LED_FRAME_SIZE_CH] = {0};
-    (void)led_driver_submit_frames(black, black);
+    // playback_task blanks the LEDs on its next frame
     ESP_LOGI(TAG, "Playback stopped (driver remains running)");
     return ESP_OK;
 }
 
+esp_err_t playback_set_transition_ms(uint32_t duration_ms)
+{
+    if (duration_ms > PLAYBACK_MAX_TRANSITION_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_transition_ms = duration_ms;
+    return ESP_OK;
+}
+
+esp_err_t playback_set_white_balance(uint8_t r_gain, uint8_t g_gain, uint8_t b_gain)
+{
+    effect_set_white_balance(r_gain, g_gain, b_gain);
+    return ESP_OK;
+}
+
+void playback_set_interpolation(bool enable)
+{
+    s_interpolate = enable;
+}
+
+esp_err_t playback_seek_frame(uint32_t frame)
+{
+    uint32_t frame_count = s_pattern_frame_count;
+    if (!s_pb.running || s_pb.source != PLAYBACK_SOURCE_PATTERN || frame_count == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (frame >= frame_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    __atomic_store_n(&s_seek_target, frame, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_seek_pending, true, __ATOMIC_RELEASE);
+    return ESP_OK;
+}
+
 bool playback_is_running(void)
 {
     return s_pb.running;
@@ -1084,10 +1710,8 @@ bool playback_is_running(void)
 
 esp_err_t playback_set_brightness(uint8_t target, uint32_t duration_ms)
 {
-    // Ensure engine initialized
-    effect_engine_init();
-    // If brightness not yet added, add it with current=target then no-op ramp
-    effect_add_brightness(target);
+    // Ramp from the current level; the engine adds the stage on first use.
+    // Gamma and white balance set elsewhere are left untouched.
     effect_brightness_set_target(target, duration_ms);
     return ESP_OK;
 }
@@ -0,0 +1,470 @@
+/**
+ * @file prism_decoder.c
+ * @brief Streaming per-frame decoder for .prism payloads
+ */
+
+#include "prism_decoder.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+esp_err_t prism_decoder_init(prism_decoder_t *dec,
+                             const uint8_t *payload,
+                             size_t payload_len,
+                             uint32_t frame_count,
+                             uint16_t led_count)
+{
+    if (!dec || !payload) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (led_count == 0 || led_count > PRISM_DECODER_MAX_LEDS || frame_count == 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    memset(dec, 0, sizeof(*dec));
+
+    const uint8_t *cursor = payload;
+    const uint8_t *end = payload + payload_len;
+    if (cursor + 2 > end) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint16_t palette_entries = (uint16_t)(cursor[0] | (cursor[1] << 8));
+    cursor += 2;
+    if (palette_entries == 0 || palette_entries > PRISM_DECODER_MAX_PALETTE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (cursor + palette_entries * 3 > end) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // Palette is stored RGB; keep it GRB to match the wire order
+    for (uint16_t i = 0; i < palette_entries; ++i) {
+        dec->palette_grb[i * 3 + 0] = cursor[i * 3 + 1];
+        dec->palette_grb[i * 3 + 1] = cursor[i * 3 + 0];
+        dec->palette_grb[i * 3 + 2] = cursor[i * 3 + 2];
+    }
+    cursor += palette_entries * 3;
+
+    dec->payload = payload;
+    dec->frames_start = cursor;
+    dec->cursor = cursor;
+    dec->end = end;
+    dec->frame_count = frame_count;
+    dec->led_count = led_count;
+    dec->palette_count = palette_entries;
+    dec->frame_index = 0;
+    dec->next_frame = 0;
+    dec->frame_valid = false;
+    return ESP_OK;
+}
+
+void prism_decoder_rewind(prism_decoder_t *dec)
+{
+    if (!dec) {
+        return;
+    }
+    dec->cursor = dec->frames_start;
+    dec->next_frame = 0;
+    dec->frame_valid = false;
+    dec->prev_valid = false;
+}
+
+esp_err_t prism_decoder_next(prism_decoder_t *dec)
+{
+    if (!dec || !dec->frames_start) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Interpolating decoders keep the outgoing frame (including across the
+    // loop back to frame 0) so the renderer can blend towards the new one.
+    const bool had_frame = dec->frame_valid;
+    if (dec->keep_prev && had_frame) {
+        memcpy(dec->prev_indices, dec->indices, dec->led_count);
+    }
+
+    if (dec->next_frame >= dec->frame_count) {
+        prism_decoder_rewind(dec);
+    }
+
+    const uint8_t *cursor = dec->cursor;
+    if (cursor + 3 > dec->end) {
+        prism_decoder_rewind(dec);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint8_t flags = cursor[0];
+    uint16_t segment_len = (uint16_t)(cursor[1] | (cursor[2] << 8));
+    cursor += 3;
+    if (cursor + segment_len > dec->end) {
+        prism_decoder_rewind(dec);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const uint8_t *segment = cursor;
+
+    bool delta = (flags & PRISM_FLAG_DELTA) != 0;
+    if (delta && !dec->frame_valid) {
+        prism_decoder_rewind(dec);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Decode straight into indices[]: delta frames XOR onto the previous
+    // frame in place, so no scratch buffer is needed.
+    uint8_t *out = dec->indices;
+    const uint32_t led_count = dec->led_count;
+    uint32_t out_idx = 0;
+    if (flags & PRISM_FLAG_RLE) {
+        size_t pos = 0;
+        while (pos < segment_len && out_idx < led_count) {
+            uint8_t value = segment[pos++];
+            uint8_t run_len = 1;
+            if (value & PRISM_RLE_MARK) {
+                if (pos >= segment_len) {
+                    break;
+                }
+                run_len = value & PRISM_RLE_MASK;
+                value = segment[pos++];
+            }
+            for (uint8_t c = 0; c < run_len && out_idx < led_count; ++c, ++out_idx) {
+                out[out_idx] = delta ? (uint8_t)(out[out_idx] ^ value) : value;
+            }
+        }
+    } else if (segment_len >= led_count) {
+        if (delta) {
+            for (; out_idx < led_count; ++out_idx) {
+                out[out_idx] ^= segment[out_idx];
+            }
+        } else {
+            memcpy(out, segment, led_count);
+            out_idx = led_count;
+        }
+    }
+
+    if (out_idx != led_count) {
+        prism_decoder_rewind(dec);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const uint8_t palette_count = (uint8_t)dec->palette_count;
+    for (uint32_t i = 0; i < led_count; ++i) {
+        if (out[i] >= palette_count) {
+            prism_decoder_rewind(dec);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+
+    dec->cursor = cursor + segment_len;
+    dec->frame_index = dec->next_frame++;
+    dec->frame_valid = true;
+    dec->prev_valid = dec->keep_prev && had_frame;
+    return ESP_OK;
+}
+
+esp_err_t prism_decoder_set_seek_index(prism_decoder_t *dec, const prism_seek_index_t *index)
+{
+    if (!dec || !dec->frames_start) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    memset(&dec->seek, 0, sizeof(dec->seek));
+    if (!index || index->interval == 0 || !index->offsets) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t needed = (dec->frame_count + index->interval - 1) / index->interval;
+    if (index->count < needed) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const size_t payload_len = (size_t)(dec->end - dec->payload);
+    const size_t first = (size_t)(dec->frames_start - dec->payload);
+    for (uint32_t k = 0; k < needed; ++k) {
+        uint32_t off = index->offsets[k];
+        if (off < first || (size_t)off + 3 > payload_len ||
+            (dec->payload[off] & PRISM_FLAG_DELTA)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+
+    dec->seek = *index;
+    dec->seek.count = needed;
+    return ESP_OK;
+}
+
+esp_err_t prism_decoder_seek(prism_decoder_t *dec, uint32_t frame)
+{
+    if (!dec || !dec->frames_start) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    frame %= dec->frame_count;
+
+    if (dec->frame_valid && dec->frame_index == frame) {
+        return ESP_OK;
+    }
+
+    bool forward = dec->frame_valid && frame > dec->frame_index;
+    if (dec->seek.interval) {
+        uint32_t key = frame / dec->seek.interval;
+        uint32_t key_frame = key * dec->seek.interval;
+        // Only jump when the keyframe is ahead of where we already are
+        if (!forward || key_frame > dec->frame_index) {
+            dec->cursor = dec->payload + dec->seek.offsets[key];
+            dec->next_frame = key_frame;
+            dec->frame_valid = false;
+        }
+    } else if (!forward) {
+        prism_decoder_rewind(dec);
+    }
+
+    while (!dec->frame_valid || dec->frame_index != frame) {
+        esp_err_t ret = prism_decoder_next(dec);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+// Minimal scanner for the seek_index object in the extra-data JSON. The
+// packaging tool emits plain json.dumps() output, so only whitespace,
+// unsigned integers and one nesting level need handling.
+static const char *json_skip_ws(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        ++p;
+    }
+    return p;
+}
+
+static const char *json_find_key(const char *p, const char *end, const char *key)
+{
+    size_t key_len = strlen(key);
+    while (p + key_len + 2 <= end) {
+        if (p[0] == '"' && memcmp(p + 1, key, key_len) == 0 && p[1 + key_len] == '"') {
+            p = json_skip_ws(p + key_len + 2, end);
+            if (p < end && *p == ':') {
+                return json_skip_ws(p + 1, end);
+            }
+        }
+        ++p;
+    }
+    return NULL;
+}
+
+static const char *json_parse_u32(const char *p, const char *end, uint32_t *out)
+{
+    uint64_t value = 0;
+    const char *start = p;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10u + (uint64_t)(*p - '0');
+        if (value > UINT32_MAX) {
+            return NULL;
+        }
+        ++p;
+    }
+    if (p == start) {
+        return NULL;
+    }
+    *out = (uint32_t)value;
+    return p;
+}
+
+esp_err_t prism_seek_index_parse(const char *extra, size_t extra_len,
+                                 uint32_t frame_count, prism_seek_index_t *out)
+{
+    if (!out || frame_count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(out, 0, sizeof(*out));
+    if (!extra || extra_len == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const char *end = extra + extra_len;
+    const char *obj = json_find_key(extra, end, "seek_index");
+    if (!obj) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (*obj != '{') {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const char *obj_end = memchr(obj, '}', (size_t)(end - obj));
+    if (!obj_end) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint32_t interval = 0;
+    const char *p = json_find_key(obj, obj_end, "interval");
+    if (!p || !json_parse_u32(p, obj_end, &interval) || interval == 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    p = json_find_key(obj, obj_end, "offsets");
+    if (!p || *p != '[') {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    ++p;
+
+    // frame_count is untrusted: no wrap in the ceil-division or the size,
+    // and every entry takes at least two characters ("0,") of extra data
+    uint32_t needed = frame_count / interval + (frame_count % interval != 0);
+    if (needed > extra_len / 2 || needed > SIZE_MAX / sizeof(uint32_t)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint32_t *offsets = (uint32_t *)malloc((size_t)needed * sizeof(uint32_t));
+    if (!offsets) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t count = 0;
+    p = json_skip_ws(p, obj_end);
+    while (p < obj_end && *p != ']') {
+        uint32_t value = 0;
+        p = json_parse_u32(p, obj_end, &value);
+        if (!p) {
+            free(offsets);
+            return ESP_ERR_INVALID_SIZE;
+        }
+        if (count < needed) {
+            offsets[count] = value;
+        }
+        ++count;
+        p = json_skip_ws(p, obj_end);
+        if (p < obj_end && *p == ',') {
+            p = json_skip_ws(p + 1, obj_end);
+        }
+    }
+    if (p >= obj_end || count != needed) {
+        free(offsets);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    out->interval = interval;
+    out->count = count;
+    out->offsets = offsets;
+    return ESP_OK;
+}
+
+void prism_seek_index_free(prism_seek_index_t *index)
+{
+    if (!index) {
+        return;
+    }
+    free((void *)index->offsets);
+    memset(index, 0, sizeof(*index));
+}
+
+void prism_decoder_expand_grb(const prism_decoder_t *dec, uint8_t *grb_out)
+{
+    if (!dec) {
+        return;
+    }
+    prism_decoder_expand_palette(dec, dec->palette_grb, grb_out, NULL);
+}
+
+void prism_decoder_expand_palette(const prism_decoder_t *dec,
+                                  const uint8_t *palette_grb,
+                                  uint8_t *grb_out_a,
+                                  uint8_t *grb_out_b)
+{
+    if (!dec || !palette_grb || !grb_out_a) {
+        return;
+    }
+    const uint32_t led_count = dec->led_count;
+    if (!dec->frame_valid) {
+        memset(grb_out_a, 0, led_count * 3);
+        if (grb_out_b) {
+            memset(grb_out_b, 0, led_count * 3);
+        }
+        return;
+    }
+
+    // prism_decoder_next() rejects out-of-range indices, so no bounds check
+    // is needed per LED here.
+    const uint8_t *idx = dec->indices;
+    if (grb_out_b) {
+        for (uint32_t i = 0; i < led_count; ++i) {
+            const uint8_t *grb = &palette_grb[idx[i] * 3];
+            uint8_t g = grb[0], r = grb[1], b = grb[2];
+            grb_out_a[i * 3 + 0] = g; grb_out_a[i * 3 + 1] = r; grb_out_a[i * 3 + 2] = b;
+            grb_out_b[i * 3 + 0] = g; grb_out_b[i * 3 + 1] = r; grb_out_b[i * 3 + 2] = b;
+        }
+    } else {
+        for (uint32_t i = 0; i < led_count; ++i) {
+            const uint8_t *grb = &palette_grb[idx[i] * 3];
+            grb_out_a[i * 3 + 0] = grb[0];
+            grb_out_a[i * 3 + 1] = grb[1];
+            grb_out_a[i * 3 + 2] = grb[2];
+        }
+    }
+}
+
+void prism_decoder_expand_blend(const prism_decoder_t *from, const uint8_t *from_palette_grb,
+                                const prism_decoder_t *to, const uint8_t *to_palette_grb,
+                                uint16_t weight,
+                                uint8_t *grb_out_a,
+                                uint8_t *grb_out_b)
+{
+    if (!from || !to || !from_palette_grb || !to_palette_grb || !grb_out_a) {
+        return;
+    }
+    if (!from->frame_valid || weight >= PRISM_BLEND_ONE) {
+        prism_decoder_expand_palette(to, to_palette_grb, grb_out_a, grb_out_b);
+        return;
+    }
+    if (!to->frame_valid || weight == 0) {
+        prism_decoder_expand_palette(from, from_palette_grb, grb_out_a, grb_out_b);
+        return;
+    }
+
+    // Both frames are still index form, so the blend reads two palette
+    // entries per LED and writes the result straight to the channel buffers.
+    const uint32_t led_count = (from->led_count < to->led_count) ? from->led_count : to->led_count;
+    const uint32_t w_to = weight;
+    const uint32_t w_from = PRISM_BLEND_ONE - weight;
+    const uint8_t *idx_from = from->indices;
+    const uint8_t *idx_to = to->indices;
+    for (uint32_t i = 0; i < led_count; ++i) {
+        const uint8_t *a = &from_palette_grb[idx_from[i] * 3];
+        const uint8_t *b = &to_palette_grb[idx_to[i] * 3];
+        uint8_t g = (uint8_t)((a[0] * w_from + b[0] * w_to) >> 8);
+        uint8_t r = (uint8_t)((a[1] * w_from + b[1] * w_to) >> 8);
+        uint8_t bl = (uint8_t)((a[2] * w_from + b[2] * w_to) >> 8);
+        grb_out_a[i * 3 + 0] = g; grb_out_a[i * 3 + 1] = r; grb_out_a[i * 3 + 2] = bl;
+        if (grb_out_b) {
+            grb_out_b[i * 3 + 0] = g; grb_out_b[i * 3 + 1] = r; grb_out_b[i * 3 + 2] = bl;
+        }
+    }
+}
+
+void prism_decoder_expand_interp(const prism_decoder_t *dec,
+                                 const uint8_t *palette_grb,
+                                 uint16_t weight,
+                                 uint8_t *grb_out_a,
+                                 uint8_t *grb_out_b)
+{
+    if (!dec || !palette_grb || !grb_out_a) {
+        return;
+    }
+    if (!dec->frame_valid || !dec->prev_valid || weight >= PRISM_BLEND_ONE) {
+        prism_decoder_expand_palette(dec, palette_grb, grb_out_a, grb_out_b);
+        return;
+    }
+
+    // Same kernel as the crossfade, but both endpoints share one palette
+    const uint32_t led_count = dec->led_count;
+    const uint32_t w_next = weight;
+    const uint32_t w_prev = PRISM_BLEND_ONE - weight;
+    const uint8_t *idx_prev = dec->prev_indices;
+    const uint8_t *idx_next = dec->indices;
+    for (uint32_t i = 0; i < led_count; ++i) {
+        const uint8_t *a = &palette_grb[idx_prev[i] * 3];
+        const uint8_t *b = &palette_grb[idx_next[i] * 3];
+        uint8_t g = (uint8_t)((a[0] * w_prev + b[0] * w_next) >> 8);
+        uint8_t r = (uint8_t)((a[1] * w_prev + b[1] * w_next) >> 8);
+        uint8_t bl = (uint8_t)((a[2] * w_prev + b[2] * w_next) >> 8);
+        grb_out_a[i * 3 + 0] = g; grb_out_a[i * 3 + 1] = r; grb_out_a[i * 3 + 2] = bl;
+        if (grb_out_b) {
+            grb_out_b[i * 3 + 0] = g; grb_out_b[i * 3 + 1] = r; grb_out_b[i * 3 + 2] = bl;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+/**
+ * @file prism_gamma_tables.c
+ * @brief Fixed-point log2/exp2 tables for integer gamma LUT generation
+ */
+
+#include "prism_gamma_tables.h"
+#include "esp_attr.h"
+
+// -log2(i / 255) in Q11 (generated offline); entry 0 is PRISM_GAMMA_LOG2_ZERO
+DRAM_ATTR const uint16_t prism_gamma_log2_q11[256] = {
+    65535, 16372, 14324, 13126, 12276, 11617, 11078, 10623, 10228, 9880, 9569, 9288,
+    9030, 8794, 8575, 8371, 8180, 8001, 7832, 7673, 7521, 7377, 7240, 7108,
+    6982, 6862, 6746, 6634, 6527, 6423, 6323, 6226, 6132, 6042, 5953, 5868,
+    5784, 5703, 5625, 5548, 5473, 5400, 5329, 5259, 5192, 5125, 5060, 4997,
+    4934, 4874, 4814, 4755, 4698, 4642, 4586, 4532, 4479, 4427, 4375, 4325,
+    4275, 4226, 4178, 4131, 4084, 4039, 3994, 3949, 3905, 3862, 3820, 3778,
+    3736, 3696, 3655, 3616, 3577, 3538, 3500, 3462, 3425, 3388, 3352, 3316,
+    3281, 3246, 3211, 3177, 3144, 3110, 3077, 3044, 3012, 2980, 2949, 2917,
+    2886, 2856, 2826, 2796, 2766, 2736, 2707, 2678, 2650, 2622, 2594, 2566,
+    2538, 2511, 2484, 2457, 2431, 2405, 2379, 2353, 2327, 2302, 2277, 2252,
+    2227, 2203, 2178, 2154, 2130, 2107, 2083, 2060, 2036, 2013, 1991, 1968,
+    1946, 1923, 1901, 1879, 1857, 1836, 1814, 1793, 1772, 1751, 1730, 1709,
+    1688, 1668, 1648, 1628, 1607, 1588, 1568, 1548, 1529, 1509, 1490, 1471,
+    1452, 1433, 1414, 1396, 1377, 1359, 1340, 1322, 1304, 1286, 1268, 1251,
+    1233, 1215, 1198, 1181, 1163, 1146, 1129, 1112, 1096, 1079, 1062, 1046,
+    1029, 1013, 996, 980, 964, 948, 932, 916, 901, 885, 869, 854,
+    838, 823, 808, 793, 778, 762, 748, 733, 718, 703, 688, 674,
+    659, 645, 630, 616, 602, 588, 574, 560, 546, 532, 518, 504,
+    490, 477, 463, 450, 436, 423, 409, 396, 383, 370, 357, 344,
+    331, 318, 305, 292, 279, 267, 254, 241, 229, 216, 204, 191,
+    179, 167, 155, 142, 130, 118, 106, 94, 82, 70, 59, 47,
+    35, 23, 12, 0
+};
+
+// 2^(-j / 256) in Q15 for j = 0..256 (generated offline)
+DRAM_ATTR const uint16_t prism_gamma_exp2_q15[257] = {
+    32768, 32679, 32591, 32503, 32415, 32327, 32240, 32153, 32066, 31979, 31893, 31806,
+    31720, 31635, 31549, 31464, 31379, 31294, 31209, 31125, 31041, 30957, 30873, 30790,
+    30706, 30623, 30541, 30458, 30376, 30293, 30212, 30130, 30048, 29967, 29886, 29805,
+    29725, 29644, 29564, 29484, 29405, 29325, 29246, 29167, 29088, 29009, 28931, 28852,
+    28774, 28697, 28619, 28542, 28464, 28388, 28311, 28234, 28158, 28082, 28006, 27930,
+    27855, 27779, 27704, 27629, 27554, 27480, 27406, 27332, 27258, 27184, 27110, 27037,
+    26964, 26891, 26818, 26746, 26674, 26601, 26530, 26458, 26386, 26315, 26244, 26173,
+    26102, 26031, 25961, 25891, 25821, 25751, 25681, 25612, 25543, 25474, 25405, 25336,
+    25268, 25199, 25131, 25063, 24995, 24928, 24860, 24793, 24726, 24659, 24593, 24526,
+    24460, 24394, 24328, 24262, 24196, 24131, 24066, 24001, 23936, 23871, 23806, 23742,
+    23678, 23614, 23550, 23486, 23423, 23359, 23296, 23233, 23170, 23108, 23045, 22983,
+    22921, 22859, 22797, 22735, 22674, 22613, 22552, 22491, 22430, 22369, 22309, 22248,
+    22188, 22128, 22068, 22009, 21949, 21890, 21831, 21772, 21713, 21654, 21595, 21537,
+    21479, 21421, 21363, 21305, 21247, 21190, 21133, 21076, 21019, 20962, 20905, 20849,
+    20792, 20736, 20680, 20624, 20568, 20513, 20457, 20402, 20347, 20292, 20237, 20182,
+    20127, 20073, 20019, 19965, 19911, 19857, 19803, 19750, 19696, 19643, 19590, 19537,
+    19484, 19431, 19379, 19326, 19274, 19222, 19170, 19118, 19066, 19015, 18963, 18912,
+    18861, 18810, 18759, 18708, 18658, 18607, 18557, 18507, 18457, 18407, 18357, 18308,
+    18258, 18209, 18160, 18110, 18061, 18013, 17964, 17915, 17867, 17819, 17770, 17722,
+    17674, 17627, 17579, 17531, 17484, 17437, 17390, 17343, 17296, 17249, 17202, 17156,
+    17109, 17063, 17017, 16971, 16925, 16879, 16834, 16788, 16743, 16697, 16652, 16607,
+    16562, 16518, 16473, 16428, 16384
+};
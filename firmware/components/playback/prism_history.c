@@ -0,0 +1,114 @@
+/**
+ * @file prism_history.c
+ * @brief CH1 frame history for time-shifted CH2 playback
+ */
+
+#include "prism_history.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "prism_history";
+
+static inline uint32_t history_lag(const prism_history_t *history, uint16_t delay_ms)
+{
+    return (uint32_t)(((uint64_t)delay_ms * history->frames_per_ms + (1ull << 31)) >> 32);
+}
+
+esp_err_t prism_history_init(prism_history_t *history, const prism_delay_map_t *map,
+                             uint32_t frame_period_us)
+{
+    if (!history || !map || frame_period_us == 0 || map->led_count > PRISM_TEMPORAL_MAX_LEDS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    prism_history_deinit(history);
+    history->frames_per_ms = (1000ull << 32) / frame_period_us;
+
+    uint32_t max_lag = history_lag(history, map->max_ms);
+    if (max_lag == 0) {
+        return ESP_OK;  // CH2 is CH1
+    }
+    if (max_lag > PRISM_HISTORY_MAX_DEPTH - 1) {
+        ESP_LOGW(TAG, "Delays over %u frames clamped", (unsigned)(PRISM_HISTORY_MAX_DEPTH - 1));
+        max_lag = PRISM_HISTORY_MAX_DEPTH - 1;
+    }
+
+    const uint16_t depth = (uint16_t)(max_lag + 1);
+    const size_t bytes = (size_t)depth * map->led_count;
+    uint8_t *frames = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (frames == NULL) {
+        ESP_LOGE(TAG, "No memory for %u byte history", (unsigned)bytes);
+        return ESP_ERR_NO_MEM;
+    }
+    memset(frames, PRISM_HISTORY_BLANK, bytes);
+
+    history->frames = frames;
+    history->led_count = map->led_count;
+    history->depth = depth;
+    history->head = depth - 1;  // First push lands in row 0
+    prism_history_update_lags(history, map);
+    ESP_LOGI(TAG, "History: %u frames x %u LEDs (%u bytes)",
+             (unsigned)depth, (unsigned)map->led_count, (unsigned)bytes);
+    return ESP_OK;
+}
+
+void prism_history_update_lags(prism_history_t *history, const prism_delay_map_t *map)
+{
+    if (!history || !history->frames || !map) {
+        return;
+    }
+    const uint32_t max_lag = history->depth - 1u;
+    for (uint16_t i = 0; i < history->led_count; ++i) {
+        uint32_t lag = history_lag(history, map->delay_ms[i]);
+        history->lag[i] = (uint16_t)((lag < max_lag) ? lag : max_lag);
+    }
+}
+
+void prism_history_deinit(prism_history_t *history)
+{
+    if (!history) {
+        return;
+    }
+    heap_caps_free(history->frames);
+    history->frames = NULL;
+    history->led_count = 0;
+    history->depth = 0;
+    history->head = 0;
+}
+
+void prism_history_push(prism_history_t *history, const uint8_t *indices)
+{
+    if (!history || !history->frames || !indices) {
+        return;
+    }
+    uint16_t head = history->head + 1;
+    if (head == history->depth) {
+        head = 0;
+    }
+    memcpy(&history->frames[(size_t)head * history->led_count], indices, history->led_count);
+    history->head = head;
+}
+
+void prism_history_expand(const prism_history_t *history, const uint8_t *palette_grb,
+                          uint16_t palette_count, uint8_t *grb_out)
+{
+    if (!history || !history->frames || !palette_grb || !grb_out) {
+        return;
+    }
+    static const uint8_t black[3] = {0, 0, 0};
+    const uint32_t n = history->led_count;
+    const int32_t head = history->head;
+    const int32_t depth = history->depth;
+    const uint8_t *frames = history->frames;
+
+    for (uint32_t i = 0; i < n; ++i) {
+        // Row lag[i] frames before head, wrapped without a branch
+        int32_t row = head - (int32_t)history->lag[i];
+        row += depth & (row >> 31);
+        const uint8_t idx = frames[(uint32_t)row * n + i];
+        const uint8_t *grb = (idx < palette_count) ? &palette_grb[idx * 3] : black;
+        grb_out[i * 3 + 0] = grb[0];
+        grb_out[i * 3 + 1] = grb[1];
+        grb_out[i * 3 + 2] = grb[2];
+    }
+}
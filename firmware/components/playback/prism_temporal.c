@@ -33,11 +33,14 @@ size_t prism_apply_motion_index(size_t index, size_t count, prism_motion_t direc
             return index; // 0 -> count-1
         case PRISM_MOTION_RIGHT:
             return (count - 1) - index; // reversed
-        case PRISM_MOTION_EDGE:
+        case PRISM_MOTION_EDGE: {
+            // Distance from the nearer end: edges first, center last
+            return (index < count / 2) ? index : (count - 1) - index;
+        }
         case PRISM_MOTION_CENTER: {
-            // Mirror mapping around center (simple symmetric mapping)
-            size_t mirrored = (index < count / 2) ? index : (count - 1) - index;
-            return mirrored;
+            // Distance from the middle: center first, edges last
+            size_t from_edge = (index < count / 2) ? index : (count - 1) - index;
+            return (count - 1) / 2 - from_edge;
         }
         case PRISM_MOTION_STATIC:
         default:
@@ -1,26 +1,26 @@
-// prism_temporal_runtime.c - Temporal sequencing runtime (SYNC/OFFSET)
-#include "prism_temporal_ctx.h"
+// prism_temporal_runtime.c - Temporal sequencing runtime (all sync modes)
+#include "prism_temporal_api.h"
 #include "prism_temporal.h"
 #include "prism_wave_tables.h"
-#include "led_driver.h"  // for LED_FRAME_TIME_MS
+#include "led_driver.h"  // for LED_FRAME_PERIOD_US
 #include "esp_check.h"
 #include "esp_log.h"
-#include "esp_attr.h"
+#include <stdbool.h>
 #include <string.h>
 
 #define TAG "prism_temporal"
 
-// --- WAVE mode support -----------------------------------------------------
-// Static delay table for WAVE mode (computed from params)
-static DRAM_ATTR uint16_t wave_delay_table[160] __attribute__((aligned(64)));
-static bool s_wave_table_inited = false;
+// --- Delay map compilation -------------------------------------------------
+// Every mode reduces to one delay per LED. The delay profile is built along
+// the direction of propagation (count positions, or half that for CENTER and
+// EDGE) and then gathered through the motion mapping, once per pattern.
+// A CUSTOM delay_table is already indexed by physical LED and is copied as is.
+// WAVE keeps each LED's spatial phase instead, so an animated wave only adds
+// a temporal phase and re-reads sin8_table per frame.
 
-// Calculate per-LED wave delay using sin8_table
-static inline uint16_t calculate_wave_delay(size_t led_index,
-                                            const prism_sync_params_t *params)
+// Wave delay at a phase (0..255 = one cycle) using sin8_table
+static inline uint16_t calculate_wave_delay(uint8_t phase, const prism_sync_params_t *params)
 {
-    // Map LED index 0..159 to 0..255 phase domain
-    const uint8_t phase = (uint8_t)((led_index * 256u) / 160u);
     const int16_t sine = (int16_t)sin8_table[phase] - 128;  // -128..127
     // base ± amplitude scaled by sine
     int32_t delay = (int32_t)params->delay_ms + ((int32_t)sine * (int32_t)params->wave_amplitude_ms) / 128;
@@ -29,27 +29,96 @@ static inline uint16_t calculate_wave_delay(size_t led_index,
     return (uint16_t)delay;
 }
 
-static void init_wave_table(const prism_sync_params_t *params)
+static void build_delay_profile(const prism_temporal_ctx_t *ctx, uint16_t *profile, size_t positions)
 {
-    for (size_t i = 0; i < 160; ++i) {
-        wave_delay_table[i] = calculate_wave_delay(i, params);
+    switch (ctx->sync_mode) {
+    case PRISM_SYNC_OFFSET:
+        for (size_t p = 0; p < positions; ++p) {
+            profile[p] = ctx->params.delay_ms;
+        }
+        break;
+
+    case PRISM_SYNC_PROGRESSIVE:
+        prism_build_progressive_ramp(ctx->params.progressive_start_ms, ctx->params.progressive_end_ms,
+                                     profile, positions);
+        break;
+
+    case PRISM_SYNC_CUSTOM:
+        // Only reached without a per-LED map: base delay everywhere
+        ESP_LOGW(TAG, "CUSTOM mode without delay_table; using delay_ms=%u", ctx->params.delay_ms);
+        for (size_t p = 0; p < positions; ++p) {
+            profile[p] = ctx->params.delay_ms;
+        }
+        break;
+
+    case PRISM_SYNC_SYNC:
+    default:
+        memset(profile, 0, positions * sizeof(uint16_t));
+        break;
+    }
+}
+
+// Rewrite a WAVE map's delays at its current temporal phase
+static void wave_fill(prism_delay_map_t *map, const prism_sync_params_t *params)
+{
+    const uint8_t t = (uint8_t)(map->wave_acc >> 16);
+    for (size_t i = 0; i < map->led_count; ++i) {
+        map->delay_ms[i] = calculate_wave_delay((uint8_t)(map->wave_phase[i] + t), params);
     }
-    s_wave_table_inited = true;
+}
+
+static void compile_wave(prism_temporal_ctx_t *ctx, size_t led_count, size_t positions)
+{
+    prism_delay_map_t *map = &ctx->map;
+    const prism_sync_params_t *params = &ctx->params;
+    for (size_t i = 0; i < led_count; ++i) {
+        // Map position 0..positions-1 to 0..255 phase domain
+        size_t p = prism_apply_motion_index(i, led_count, ctx->motion_direction);
+        map->wave_phase[i] = (uint8_t)((p * 256u) / positions);
+    }
+
+    // One cycle is 1 << 24; the phase offset is where it starts and the
+    // frequency sets how far it moves per frame
+    map->wave_acc = (uint32_t)(((uint64_t)(params->wave_phase_deg % 360u) << 24) / 360u);
+    map->wave_step = (uint32_t)((((uint64_t)params->wave_frequency_hz << 24) * LED_FRAME_PERIOD_US) / 1000000u);
+    map->wave_frame = ctx->frame_index;
+    map->led_count = (uint16_t)led_count;
+    wave_fill(map, params);
+
+    // Bounds over the LEDs present, or over the whole cycle when animated
+    uint16_t min_ms = UINT16_MAX;
+    uint16_t max_ms = 0;
+    if (map->wave_step == 0) {
+        for (size_t i = 0; i < led_count; ++i) {
+            if (map->delay_ms[i] < min_ms) min_ms = map->delay_ms[i];
+            if (map->delay_ms[i] > max_ms) max_ms = map->delay_ms[i];
+        }
+    } else {
+        for (int phase = 0; phase < 256; ++phase) {
+            uint16_t d = calculate_wave_delay((uint8_t)phase, params);
+            if (d < min_ms) min_ms = d;
+            if (d > max_ms) max_ms = d;
+        }
+    }
+    map->min_ms = min_ms;
+    map->max_ms = max_ms;
+}
+
+static bool delay_map_is_current(const prism_temporal_ctx_t *ctx, size_t led_count)
+{
+    const prism_delay_map_t *map = &ctx->map;
+    return map->led_count == led_count &&
+           map->sync_mode == ctx->sync_mode &&
+           map->motion_direction == ctx->motion_direction &&
+           map->delay_table == ctx->delay_table &&
+           memcmp(&map->params, &ctx->params, sizeof(map->params)) == 0;
 }
 
 // Calculate current frame time in milliseconds
 static inline uint32_t prism_frame_time_ms(const prism_temporal_ctx_t *ctx,
                                            uint16_t frame_period_ms) {
-    (void)frame_period_ms; // unused; using global LED_FRAME_TIME_MS
-    return ctx ? (ctx->frame_index * (uint32_t)LED_FRAME_TIME_MS) : 0U;
-}
-
-// Apply offset delay to LED value
-// Returns 0 if frame_time_ms < delay_ms, otherwise returns base_value
-static inline uint16_t apply_offset(uint16_t base_value,
-                                    uint16_t delay_ms,
-                                    uint32_t frame_time_ms) {
-    return (frame_time_ms < delay_ms) ? 0U : base_value;
+    (void)frame_period_ms; // unused; frames advance on the driver's frame clock
+    return ctx ? (uint32_t)(((uint64_t)ctx->frame_index * LED_FRAME_PERIOD_US) / 1000U) : 0U;
 }
 
 // Initialize temporal context with validation
@@ -72,15 +141,79 @@ esp_err_t prism_motion_init(prism_temporal_ctx_t *ctx,
     ctx->frame_index = 0;
     ctx->frame_time_ms = 0;
     ctx->delay_table = NULL;  // No delay table initially
-
-    // Reset WAVE table so it will be rebuilt on first use
-    s_wave_table_inited = false;
+    // ctx->map.led_count == 0: compiled on first use
 
     ESP_LOGI(TAG, "Temporal context initialized for %zu LEDs", led_count);
     return ESP_OK;
 }
 
-void calculate_ch2_frame(const prism_temporal_ctx_t *ctx,
+esp_err_t prism_temporal_compile(prism_temporal_ctx_t *ctx, size_t led_count) {
+    ESP_RETURN_ON_FALSE(ctx != NULL, ESP_ERR_INVALID_ARG, TAG, "ctx is NULL");
+    ESP_RETURN_ON_FALSE(led_count > 0 && led_count <= PRISM_TEMPORAL_MAX_LEDS, ESP_ERR_INVALID_ARG,
+                        TAG, "led_count %zu out of range", led_count);
+
+    const bool mirrored = (ctx->motion_direction == PRISM_MOTION_CENTER ||
+                           ctx->motion_direction == PRISM_MOTION_EDGE);
+    const size_t positions = mirrored ? (led_count + 1) / 2 : led_count;
+    prism_delay_map_t *map = &ctx->map;
+    if (ctx->sync_mode == PRISM_SYNC_WAVE) {
+        compile_wave(ctx, led_count, positions);
+    } else if (ctx->sync_mode == PRISM_SYNC_CUSTOM && ctx->delay_table != NULL) {
+        // Per-LED table: no motion gather
+        memcpy(map->delay_ms, ctx->delay_table, led_count * sizeof(uint16_t));
+        uint16_t min_ms = UINT16_MAX;
+        uint16_t max_ms = 0;
+        for (size_t i = 0; i < led_count; ++i) {
+            if (map->delay_ms[i] < min_ms) min_ms = map->delay_ms[i];
+            if (map->delay_ms[i] > max_ms) max_ms = map->delay_ms[i];
+        }
+        map->min_ms = min_ms;
+        map->max_ms = max_ms;
+        map->wave_step = 0;
+        map->led_count = (uint16_t)led_count;
+    } else {
+        uint16_t profile[PRISM_TEMPORAL_MAX_LEDS];
+        build_delay_profile(ctx, profile, positions);
+
+        uint16_t min_ms = UINT16_MAX;
+        uint16_t max_ms = 0;
+        for (size_t i = 0; i < led_count; ++i) {
+            const uint16_t d = profile[prism_apply_motion_index(i, led_count, ctx->motion_direction)];
+            map->delay_ms[i] = d;
+            if (d < min_ms) min_ms = d;
+            if (d > max_ms) max_ms = d;
+        }
+        map->min_ms = min_ms;
+        map->max_ms = max_ms;
+        map->wave_step = 0;
+        map->led_count = (uint16_t)led_count;
+    }
+    map->sync_mode = ctx->sync_mode;
+    map->motion_direction = ctx->motion_direction;
+    map->params = ctx->params;
+    map->delay_table = ctx->delay_table;
+
+    ESP_LOGD(TAG, "Delay map compiled: mode=%d motion=%d leds=%zu delay=%u..%u ms",
+             ctx->sync_mode, ctx->motion_direction, led_count, map->min_ms, map->max_ms);
+    return ESP_OK;
+}
+
+void prism_temporal_advance(prism_temporal_ctx_t *ctx) {
+    if (!ctx) {
+        return;
+    }
+    prism_delay_map_t *map = &ctx->map;
+    if (map->wave_step == 0 || map->sync_mode != PRISM_SYNC_WAVE || map->wave_frame == ctx->frame_index) {
+        return;
+    }
+    // Wrapping arithmetic: the cycle (1 << 24) divides 2^32, so this also
+    // holds when frame_index goes back
+    map->wave_acc += map->wave_step * (ctx->frame_index - map->wave_frame);
+    map->wave_frame = ctx->frame_index;
+    wave_fill(map, &ctx->params);
+}
+
+void calculate_ch2_frame(prism_temporal_ctx_t *ctx,
                          const uint16_t *restrict ch1_frame,
                          uint16_t *restrict ch2_frame,
                          size_t led_count) {
@@ -89,66 +222,34 @@ void calculate_ch2_frame(const prism_temporal_ctx_t *ctx,
         ESP_LOGE(TAG, "NULL pointer in calculate_ch2_frame");
         return;
     }
-
-    switch (ctx->sync_mode) {
-    case PRISM_SYNC_SYNC:
-        // Fast path: direct memcpy for synchronized mode
-        // Both edges illuminate simultaneously (50% CPU savings)
-        memcpy(ch2_frame, ch1_frame, led_count * sizeof(uint16_t));
-        break;
-
-    case PRISM_SYNC_OFFSET: {
-        const uint32_t now_ms = prism_frame_time_ms(ctx, LED_FRAME_TIME_MS);
-        const uint16_t delay_ms = ctx->params.delay_ms;
-
-        // Early exit optimization: if delay is zero, behave like SYNC
-        if (delay_ms == 0) {
-            memcpy(ch2_frame, ch1_frame, led_count * sizeof(uint16_t));
-            break;
-        }
-
-        // Apply per-LED offset
-        for (size_t i = 0; i < led_count; ++i) {
-            ch2_frame[i] = apply_offset(ch1_frame[i], delay_ms, now_ms);
-        }
-        break;
-    }
-
-    case PRISM_SYNC_CUSTOM: {
-        const uint32_t now_ms = ctx->frame_time_ms; // runtime provides absolute ms
-        if (ctx->delay_table == NULL) {
-            ESP_LOGW(TAG, "CUSTOM mode without delay_table; zeroing CH2");
-            memset(ch2_frame, 0, led_count * sizeof(uint16_t));
-            break;
-        }
-        for (size_t i = 0; i < led_count; ++i) {
-            const uint16_t d = ctx->delay_table[i];
-            ch2_frame[i] = apply_offset(ch1_frame[i], d, now_ms);
-        }
-        break;
+    if (!delay_map_is_current(ctx, led_count) &&
+        prism_temporal_compile(ctx, led_count) != ESP_OK) {
+        return;
     }
+    prism_temporal_advance(ctx);
 
-    case PRISM_SYNC_WAVE: {
-        // Lazy init wave table based on current params
-        if (!s_wave_table_inited) {
-            init_wave_table(&ctx->params);
-        }
+    // CUSTOM maps are authored against the runtime's absolute ms; the
+    // other modes run on the driver's frame clock
+    const uint32_t now_ms = (ctx->sync_mode == PRISM_SYNC_CUSTOM)
+                                ? ctx->frame_time_ms
+                                : prism_frame_time_ms(ctx, LED_FRAME_TIME_MS);
+    const prism_delay_map_t *map = &ctx->map;
 
-        const uint32_t now_ms = prism_frame_time_ms(ctx, LED_FRAME_TIME_MS);
-        for (size_t i = 0; i < led_count; ++i) {
-            // Apply motion mapping to pick the per-LED delay
-            size_t j = prism_apply_motion_index(i, led_count, ctx->motion_direction);
-            uint16_t delay = (j < 160) ? wave_delay_table[j] : 0;
-            ch2_frame[i] = (now_ms >= delay) ? ch1_frame[i] : 0;
-        }
-        break;
+    // Whole-strip cases: SYNC and settled delays copy, pre-delay is dark
+    if (now_ms >= map->max_ms) {
+        memcpy(ch2_frame, ch1_frame, led_count * sizeof(uint16_t));
+        return;
     }
-
-    default:
-        // Zero output for unimplemented modes
+    if (now_ms < map->min_ms) {
         memset(ch2_frame, 0, led_count * sizeof(uint16_t));
-        ESP_LOGW(TAG, "Unimplemented sync mode: %d", ctx->sync_mode);
-        break;
+        return;
+    }
+
+    // Branch-free compare/select: all ones once the LED's delay has passed
+    const uint16_t *restrict delay = map->delay_ms;
+    for (size_t i = 0; i < led_count; ++i) {
+        const uint16_t on = (uint16_t)-(uint16_t)(now_ms >= delay[i]);
+        ch2_frame[i] = ch1_frame[i] & on;
     }
 }
 
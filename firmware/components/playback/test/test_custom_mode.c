@@ -51,3 +51,31 @@ TEST_CASE("CUSTOM mode applies per-LED delays (sanity)", "[temporal][custom]") {
     }
 }
 
+
+TEST_CASE("CUSTOM mode ignores motion direction for per-LED maps", "[temporal][custom]") {
+    prism_temporal_ctx_t ctx;
+    uint16_t ch1[160], ch2[160];
+    uint16_t delay_map[160];
+
+    // Non-symmetric: a mirror or reversal gather would move these around
+    for (int i = 0; i < 160; i++) {
+        ch1[i] = 1000;
+        delay_map[i] = (uint16_t)((i * 37) % 101);
+    }
+
+    const prism_motion_t motions[] = { PRISM_MOTION_RIGHT, PRISM_MOTION_CENTER };
+    for (size_t m = 0; m < sizeof(motions) / sizeof(motions[0]); m++) {
+        prism_motion_init(&ctx, ch1, ch2, 160);
+        ctx.sync_mode = PRISM_SYNC_CUSTOM;
+        ctx.motion_direction = motions[m];
+        ctx.delay_table = delay_map;
+        TEST_ASSERT_EQUAL(ESP_OK, prism_temporal_compile(&ctx, 160));
+        TEST_ASSERT_EQUAL_UINT16_ARRAY(delay_map, ctx.map.delay_ms, 160);
+
+        ctx.frame_time_ms = 50;
+        calculate_ch2_frame(&ctx, ch1, ch2, 160);
+        for (int i = 0; i < 160; i++) {
+            TEST_ASSERT_EQUAL_UINT16(delay_map[i] <= 50 ? 1000 : 0, ch2[i]);
+        }
+    }
+}
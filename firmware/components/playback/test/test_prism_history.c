@@ -0,0 +1,82 @@
+// Unity tests for the CH1 history used by time-shifted CH2 playback
+#include "unity.h"
+#include "prism_history.h"
+#include "prism_temporal_api.h"
+#include <string.h>
+
+#define LED_COUNT 160
+#define PERIOD_US 8333  // 120 FPS
+
+static prism_temporal_ctx_t hctx;
+static prism_history_t history;
+static uint16_t hch1[LED_COUNT], hch2[LED_COUNT];
+
+// Palette entry k is (k, k, k), so the expanded colour names the frame
+static uint8_t palette[64 * 3];
+static uint8_t frame[LED_COUNT];
+static uint8_t out[LED_COUNT * 3];
+
+static void compile_offset(uint16_t delay_ms)
+{
+    prism_motion_init(&hctx, hch1, hch2, LED_COUNT);
+    hctx.sync_mode = PRISM_SYNC_OFFSET;
+    hctx.params.delay_ms = delay_ms;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_temporal_compile(&hctx, LED_COUNT));
+    for (int k = 0; k < 64 * 3; k++) {
+        palette[k] = (uint8_t)(k / 3);
+    }
+}
+
+TEST_CASE("history stays inactive without delay", "[temporal][history]") {
+    compile_offset(0);
+    memset(&history, 0, sizeof(history));
+    TEST_ASSERT_EQUAL(ESP_OK, prism_history_init(&history, &hctx.map, PERIOD_US));
+    TEST_ASSERT_FALSE(prism_history_active(&history));
+}
+
+TEST_CASE("history depth is bounded by the largest delay", "[temporal][history]") {
+    memset(&history, 0, sizeof(history));
+    compile_offset(100);    // 12 frames
+    TEST_ASSERT_EQUAL(ESP_OK, prism_history_init(&history, &hctx.map, PERIOD_US));
+    TEST_ASSERT_TRUE(prism_history_active(&history));
+    TEST_ASSERT_EQUAL_UINT16(13, history.depth);
+
+    compile_offset(5000);   // Past 1 s: clamped
+    TEST_ASSERT_EQUAL(ESP_OK, prism_history_init(&history, &hctx.map, PERIOD_US));
+    TEST_ASSERT_EQUAL_UINT16(PRISM_HISTORY_MAX_DEPTH, history.depth);
+    prism_history_deinit(&history);
+    TEST_ASSERT_FALSE(prism_history_active(&history));
+}
+
+TEST_CASE("history replays each LED from its own delay ago", "[temporal][history]") {
+    prism_motion_init(&hctx, hch1, hch2, LED_COUNT);
+    hctx.sync_mode = PRISM_SYNC_PROGRESSIVE;
+    hctx.motion_direction = PRISM_MOTION_LEFT;
+    hctx.params.progressive_start_ms = 0;
+    hctx.params.progressive_end_ms = 159 * 5;   // LED i waits i * 5ms
+    TEST_ASSERT_EQUAL(ESP_OK, prism_temporal_compile(&hctx, LED_COUNT));
+    for (int k = 0; k < 64 * 3; k++) {
+        palette[k] = (uint8_t)(k / 3);
+    }
+    memset(&history, 0, sizeof(history));
+    TEST_ASSERT_EQUAL(ESP_OK, prism_history_init(&history, &hctx.map, PERIOD_US));
+
+    // Push frames 1..40 (index = frame number), then check each LED shows
+    // the frame from lag[i] periods ago, or black before anything was there
+    const int frames = 40;
+    for (int f = 1; f <= frames; f++) {
+        memset(frame, f, sizeof(frame));
+        prism_history_push(&history, frame);
+    }
+    prism_history_expand(&history, palette, 64, out);
+
+    for (int i = 0; i < LED_COUNT; i++) {
+        uint32_t lag = ((uint32_t)i * 5 * 1000 + PERIOD_US / 2) / PERIOD_US;
+        TEST_ASSERT_EQUAL_UINT16(lag, history.lag[i]);
+        uint8_t expect = (lag < (uint32_t)frames) ? (uint8_t)(frames - lag) : 0;
+        TEST_ASSERT_EQUAL_UINT8(expect, out[i * 3 + 0]);
+        TEST_ASSERT_EQUAL_UINT8(expect, out[i * 3 + 2]);
+    }
+    TEST_ASSERT_EQUAL_UINT8(frames, out[0]);   // No delay: the newest frame
+    prism_history_deinit(&history);
+}
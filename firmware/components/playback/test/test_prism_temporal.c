@@ -1,11 +1,14 @@
 // Unity tests for temporal runtime (SYNC/OFFSET)
 #include "unity.h"
 #include "prism_temporal_api.h"
+#include "prism_wave_tables.h"
+#include "led_driver.h"  // LED_FRAME_PERIOD_US
 #include "esp_timer.h"
 #include <string.h>
 
 #define LED_COUNT 160
-#define FRAME_PERIOD_MS 16  // 60 FPS
+// First frame index at or after ms on the driver's frame clock
+#define FRAME_AT_MS(ms) ((uint32_t)(((uint64_t)(ms) * 1000u + LED_FRAME_PERIOD_US - 1) / LED_FRAME_PERIOD_US))
 
 static prism_temporal_ctx_t ctx;
 static uint16_t ch1_frame[LED_COUNT];
@@ -73,7 +76,7 @@ TEST_CASE("OFFSET mode zeros LEDs during delay window", "[temporal]") {
     prism_motion_init(&ctx, ch1_frame, ch2_frame, LED_COUNT);
     ctx.sync_mode = PRISM_SYNC_OFFSET;
     ctx.params.delay_ms = 150;  // 150ms delay
-    ctx.frame_index = 5;  // 5 frames * 16ms = 80ms < 150ms
+    ctx.frame_index = FRAME_AT_MS(80);  // < 150ms
 
     calculate_ch2_frame(&ctx, ch1_frame, ch2_frame, LED_COUNT);
 
@@ -87,7 +90,7 @@ TEST_CASE("OFFSET mode activates after delay threshold", "[temporal]") {
     prism_motion_init(&ctx, ch1_frame, ch2_frame, LED_COUNT);
     ctx.sync_mode = PRISM_SYNC_OFFSET;
     ctx.params.delay_ms = 150;
-    ctx.frame_index = 10;  // 10 * 16 = 160ms > 150ms
+    ctx.frame_index = FRAME_AT_MS(160);  // > 150ms
 
     calculate_ch2_frame(&ctx, ch1_frame, ch2_frame, LED_COUNT);
 
@@ -102,14 +105,14 @@ TEST_CASE("WAVE mode with zero amplitude behaves like OFFSET base", "[temporal][
     ctx.params.wave_amplitude_ms = 0; // zero amplitude
 
     // Before threshold
-    ctx.frame_index = 5; // 80ms
+    ctx.frame_index = FRAME_AT_MS(80);
     calculate_ch2_frame(&ctx, ch1_frame, ch2_frame, LED_COUNT);
     for (size_t i = 0; i < LED_COUNT; i++) {
         TEST_ASSERT_EQUAL_UINT16(0, ch2_frame[i]);
     }
 
     // After threshold
-    ctx.frame_index = 10; // 160ms
+    ctx.frame_index = FRAME_AT_MS(160);
     calculate_ch2_frame(&ctx, ch1_frame, ch2_frame, LED_COUNT);
     TEST_ASSERT_EQUAL_UINT16_ARRAY(ch1_frame, ch2_frame, LED_COUNT);
 }
@@ -121,7 +124,7 @@ TEST_CASE("WAVE mode amplitude creates mixed on/off at intermediate times", "[te
     ctx.params.wave_amplitude_ms = 50; // delays range ~50..150ms
 
     // Pick 96ms so some LEDs are on and some still off
-    ctx.frame_index = 6; // 6 * 16 = 96ms
+    ctx.frame_index = FRAME_AT_MS(96);
     calculate_ch2_frame(&ctx, ch1_frame, ch2_frame, LED_COUNT);
 
     bool any_on = false, any_off = false;
@@ -148,3 +151,152 @@ TEST_CASE("calculate_ch2_frame meets performance budget", "[temporal]") {
     // Must complete in <3380 microseconds (3.38ms budget)
     TEST_ASSERT_LESS_THAN(3380, elapsed_us);
 }
+
+TEST_CASE("PROGRESSIVE mode ramps delay along the motion direction", "[temporal][progressive]") {
+    prism_motion_init(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    ctx.sync_mode = PRISM_SYNC_PROGRESSIVE;
+    ctx.motion_direction = PRISM_MOTION_LEFT;
+    ctx.params.progressive_start_ms = 0;
+    ctx.params.progressive_end_ms = 159 * 10;   // LED i waits i * 10ms
+    TEST_ASSERT_EQUAL(ESP_OK, prism_temporal_compile(&ctx, LED_COUNT));
+    TEST_ASSERT_EQUAL_UINT16(0, ctx.map.delay_ms[0]);
+    TEST_ASSERT_EQUAL_UINT16(1590, ctx.map.delay_ms[159]);
+
+    ctx.frame_time_ms = 0;
+    ctx.frame_index = 25;   // 25 * 8.33ms = 208ms: LEDs 0..20 are on
+    calculate_ch2_frame(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    TEST_ASSERT_EQUAL_UINT16(ch1_frame[20], ch2_frame[20]);
+    TEST_ASSERT_EQUAL_UINT16(0, ch2_frame[21]);
+
+    // RIGHT starts from the other end; the map follows without a recompile call
+    ctx.motion_direction = PRISM_MOTION_RIGHT;
+    calculate_ch2_frame(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    TEST_ASSERT_EQUAL_UINT16(ch1_frame[159 - 20], ch2_frame[159 - 20]);
+    TEST_ASSERT_EQUAL_UINT16(0, ch2_frame[159 - 21]);
+    TEST_ASSERT_EQUAL_UINT16(0, ch2_frame[20]);
+}
+
+TEST_CASE("CENTER and EDGE motion propagate in opposite directions", "[temporal][progressive]") {
+    prism_motion_init(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    ctx.sync_mode = PRISM_SYNC_PROGRESSIVE;
+    ctx.params.progressive_start_ms = 0;
+    ctx.params.progressive_end_ms = 790;
+
+    ctx.motion_direction = PRISM_MOTION_CENTER;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_temporal_compile(&ctx, LED_COUNT));
+    TEST_ASSERT_EQUAL_UINT16(0, ctx.map.delay_ms[79]);
+    TEST_ASSERT_EQUAL_UINT16(0, ctx.map.delay_ms[80]);
+    TEST_ASSERT_EQUAL_UINT16(790, ctx.map.delay_ms[0]);
+    TEST_ASSERT_EQUAL_UINT16(790, ctx.map.delay_ms[159]);
+
+    ctx.motion_direction = PRISM_MOTION_EDGE;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_temporal_compile(&ctx, LED_COUNT));
+    TEST_ASSERT_EQUAL_UINT16(790, ctx.map.delay_ms[79]);
+    TEST_ASSERT_EQUAL_UINT16(790, ctx.map.delay_ms[80]);
+    TEST_ASSERT_EQUAL_UINT16(0, ctx.map.delay_ms[0]);
+    TEST_ASSERT_EQUAL_UINT16(0, ctx.map.delay_ms[159]);
+
+    // Both fold symmetrically
+    for (size_t i = 0; i < LED_COUNT / 2; i++) {
+        TEST_ASSERT_EQUAL_UINT16(ctx.map.delay_ms[i], ctx.map.delay_ms[LED_COUNT - 1 - i]);
+    }
+}
+
+TEST_CASE("WAVE mode map follows parameter changes", "[temporal][wave]") {
+    prism_motion_init(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    ctx.sync_mode = PRISM_SYNC_WAVE;
+    ctx.params.delay_ms = 100;
+    ctx.params.wave_amplitude_ms = 0;
+    ctx.frame_index = 14;   // ~116ms
+    calculate_ch2_frame(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(ch1_frame, ch2_frame, LED_COUNT);
+
+    // Raising the base delay must take effect on the next frame
+    ctx.params.delay_ms = 500;
+    calculate_ch2_frame(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    for (size_t i = 0; i < LED_COUNT; i++) {
+        TEST_ASSERT_EQUAL_UINT16(0, ch2_frame[i]);
+    }
+}
+
+TEST_CASE("CUSTOM mode without a delay table uses the base delay", "[temporal][custom]") {
+    prism_motion_init(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    ctx.sync_mode = PRISM_SYNC_CUSTOM;
+    ctx.params.delay_ms = 40;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_temporal_compile(&ctx, LED_COUNT));
+    TEST_ASSERT_EQUAL_UINT16(40, ctx.map.min_ms);
+    TEST_ASSERT_EQUAL_UINT16(40, ctx.map.max_ms);
+
+    ctx.frame_time_ms = 40;
+    calculate_ch2_frame(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(ch1_frame, ch2_frame, LED_COUNT);
+}
+
+TEST_CASE("WAVE phase offset shifts the static wave", "[temporal][wave]") {
+    prism_motion_init(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    ctx.sync_mode = PRISM_SYNC_WAVE;
+    ctx.params.delay_ms = 300;
+    ctx.params.wave_amplitude_ms = 200;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_temporal_compile(&ctx, LED_COUNT));
+    uint16_t base[LED_COUNT];
+    memcpy(base, ctx.map.delay_ms, sizeof(base));
+
+    // Half a cycle later along sin8_table, LED by LED
+    ctx.params.wave_phase_deg = 180;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_temporal_compile(&ctx, LED_COUNT));
+    TEST_ASSERT_TRUE(memcmp(base, ctx.map.delay_ms, sizeof(base)) != 0);
+    for (size_t i = 0; i < LED_COUNT; i++) {
+        uint8_t phase = (uint8_t)((i * 256u) / LED_COUNT + 128u);
+        int32_t expect = 300 + ((int32_t)sin8_table[phase] - 128) * 200 / 128;
+        TEST_ASSERT_EQUAL_UINT16(expect, ctx.map.delay_ms[i]);
+    }
+
+    // A full turn is no offset
+    ctx.params.wave_phase_deg = 360;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_temporal_compile(&ctx, LED_COUNT));
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(base, ctx.map.delay_ms, LED_COUNT);
+
+    // No frequency: the map never moves
+    ctx.frame_index = 500;
+    prism_temporal_advance(&ctx);
+    TEST_ASSERT_EQUAL(0, ctx.map.wave_step);
+}
+
+TEST_CASE("WAVE frequency makes the delay field travel", "[temporal][wave]") {
+    prism_motion_init(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    ctx.sync_mode = PRISM_SYNC_WAVE;
+    ctx.params.delay_ms = 300;
+    ctx.params.wave_amplitude_ms = 200;
+    ctx.params.wave_frequency_hz = 2;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_temporal_compile(&ctx, LED_COUNT));
+    TEST_ASSERT_NOT_EQUAL(0, ctx.map.wave_step);
+    // Bounds cover the whole cycle, not just the current phase
+    uint8_t lo = 255, hi = 0;
+    for (int k = 0; k < 256; k++) {
+        if (sin8_table[k] < lo) lo = sin8_table[k];
+        if (sin8_table[k] > hi) hi = sin8_table[k];
+    }
+    TEST_ASSERT_EQUAL_UINT16(300 + ((int32_t)lo - 128) * 200 / 128, ctx.map.min_ms);
+    TEST_ASSERT_EQUAL_UINT16(300 + ((int32_t)hi - 128) * 200 / 128, ctx.map.max_ms);
+
+    uint16_t start[LED_COUNT];
+    memcpy(start, ctx.map.delay_ms, sizeof(start));
+    ctx.frame_index = 15;   // A quarter cycle at 2 Hz, 120 FPS
+    prism_temporal_advance(&ctx);
+    TEST_ASSERT_TRUE(memcmp(start, ctx.map.delay_ms, sizeof(start)) != 0);
+    for (size_t i = 0; i < LED_COUNT; i++) {
+        TEST_ASSERT_TRUE(ctx.map.delay_ms[i] >= ctx.map.min_ms && ctx.map.delay_ms[i] <= ctx.map.max_ms);
+    }
+
+    // Advancing frame by frame lands on the same field as one jump
+    uint16_t jumped[LED_COUNT];
+    memcpy(jumped, ctx.map.delay_ms, sizeof(jumped));
+    ctx.frame_index = 0;
+    prism_temporal_advance(&ctx);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(start, ctx.map.delay_ms, LED_COUNT);
+    for (uint32_t f = 1; f <= 15; f++) {
+        ctx.frame_index = f;
+        calculate_ch2_frame(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    }
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(jumped, ctx.map.delay_ms, LED_COUNT);
+}
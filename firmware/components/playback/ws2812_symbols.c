@@ -0,0 +1,76 @@
+/**
+ * @file ws2812_symbols.c
+ * @brief Table-driven WS2812B byte to RMT symbol conversion
+ */
+
+#include "ws2812_symbols.h"
+#include "esp_attr.h"
+#include <string.h>
+
+uint32_t ws2812_bit_symbol(const ws2812_timing_t *timing, bool bit)
+{
+    return bit ? ws2812_symbol(timing->t1h, 1, timing->t1l, 0)
+               : ws2812_symbol(timing->t0h, 1, timing->t0l, 0);
+}
+
+uint32_t ws2812_reset_symbol(const ws2812_timing_t *timing)
+{
+    return ws2812_symbol(timing->reset, 0, timing->reset, 0);
+}
+
+void ws2812_symbol_table_build(ws2812_symbol_table_t *table, const ws2812_timing_t *timing)
+{
+    const uint32_t bit0 = ws2812_bit_symbol(timing, false);
+    const uint32_t bit1 = ws2812_bit_symbol(timing, true);
+    for (int value = 0; value < 256; ++value) {
+        for (int bit = 0; bit < WS2812_SYMBOLS_PER_BYTE; ++bit) {
+            table->symbols[value][bit] = (value & (0x80 >> bit)) ? bit1 : bit0;
+        }
+    }
+}
+
+void ws2812_output_lut_identity(ws2812_output_lut_t *lut)
+{
+    for (int c = 0; c < 3; ++c) {
+        for (int i = 0; i < 256; ++i) {
+            lut->component[c][i] = (uint8_t)i;
+        }
+    }
+}
+
+// Runs in the RMT encoder ISR
+IRAM_ATTR size_t ws2812_encode_bytes(const ws2812_symbol_table_t *table,
+                                     const ws2812_output_lut_t *lut,
+                                     const uint8_t *data, size_t pos, size_t len,
+                                     uint32_t *dst, size_t dst_symbols)
+{
+    size_t count = dst_symbols / WS2812_SYMBOLS_PER_BYTE;
+    if (pos >= len) {
+        return 0;
+    }
+    if (count > len - pos) {
+        count = len - pos;
+    }
+
+    const uint8_t *src = data + pos;
+    if (lut == NULL) {
+        for (size_t i = 0; i < count; ++i) {
+            memcpy(&dst[i * WS2812_SYMBOLS_PER_BYTE], table->symbols[src[i]],
+                   sizeof(table->symbols[0]));
+        }
+        return count;
+    }
+
+    // The last colour stage rides along with serialization: no extra pass
+    // over the frame and no second buffer
+    unsigned c = (unsigned)(pos % 3);
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t value = lut->component[c][src[i]];
+        memcpy(&dst[i * WS2812_SYMBOLS_PER_BYTE], table->symbols[value],
+               sizeof(table->symbols[0]));
+        if (++c == 3) {
+            c = 0;
+        }
+    }
+    return count;
+}
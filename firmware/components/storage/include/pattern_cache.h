@@ -1,9 +1,20 @@
 /**
  * @file pattern_cache.h
- * @brief RAM hot cache for pattern binaries with LRU eviction
+ * @brief RAM hot cache for pattern binaries with cost-aware eviction
  *
  * Provides a 256KB in-RAM cache to accelerate pattern loads and enable
- * <100ms pattern switching. Evicts least-recently-used entries when full.
+ * <100ms pattern switching. When full it evicts by Greedy-Dual-Size-
+ * Frequency: entries that are hit often and were slow to load (flash read +
+ * CRC, timed between reserve and commit) per byte are kept longest, and
+ * every entry ages against newcomers. Each class (templates, user patterns)
+ * can be capped with a quota, and the active and next pattern can be pinned.
+ *
+ * The whole capacity is allocated once at init as PATTERN_CACHE_SEGMENTS
+ * equal segments; an entry takes a contiguous run of segments, and room is
+ * made by evicting the entries occupying the least recently used run. Entry
+ * records are a fixed table found through a hash of the class and ID, so
+ * lookups are O(1) and insert/evict churn never touches the general heap.
+ * The same ID in two classes names two separate entries.
  */
 
 #ifndef PRISM_PATTERN_CACHE_H
@@ -20,34 +31,148 @@ extern "C" {
 
 #define PATTERN_CACHE_DEFAULT_CAPACITY (256 * 1024) /* 256KB */
 #define PATTERN_CACHE_ID_MAX           64
+#define PATTERN_CACHE_SEGMENTS         64  /* 4KB segments at the default capacity */
+#define PATTERN_CACHE_MAX_ENTRIES      48  /* Cached, pinned-detached and uncached handles */
+
+/* Default class caps: the 15 templates (~234KB) cannot crowd out user
+ * patterns, and user patterns always leave templates a quarter */
+#define PATTERN_CACHE_TEMPLATE_QUOTA   (PATTERN_CACHE_DEFAULT_CAPACITY / 2)
+#define PATTERN_CACHE_USER_QUOTA       (PATTERN_CACHE_DEFAULT_CAPACITY * 3 / 4)
+
+/** Entry classes with separate quotas and hit statistics */
+typedef enum {
+    PATTERN_CACHE_CLASS_USER = 0,   /**< Uploaded patterns (pattern storage) */
+    PATTERN_CACHE_CLASS_TEMPLATE,   /**< Built-in templates */
+    PATTERN_CACHE_CLASS_COUNT,
+} pattern_cache_class_t;
+
+/** Explicit pin slots, each holding at most one entry */
+typedef enum {
+    PATTERN_CACHE_PIN_ACTIVE = 0,   /**< Pattern on the LEDs */
+    PATTERN_CACHE_PIN_NEXT,         /**< Pattern expected to play next */
+    PATTERN_CACHE_PIN_COUNT,
+} pattern_cache_pin_t;
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    size_t used_bytes;          /**< Bytes in cached entries */
+    size_t held_bytes;          /**< Arena bytes held, including pinned detached/reserved entries */
+    size_t quota_bytes;
+    size_t entry_count;
+    uint32_t cost_us_per_kb;    /**< Average measured load cost */
+} pattern_cache_class_stats_t;
 
-/** Initialize cache with the given capacity (bytes). */
+/**
+ * Pinned reference to a cache entry. While held, the entry's data stays valid:
+ * eviction skips pinned entries, and invalidating/replacing a pinned entry only
+ * detaches it from the cache until the last handle is released.
+ */
+typedef struct cache_entry *pattern_cache_handle_t;
+
+/**
+ * Initialize cache with the given capacity (bytes), allocating the arena.
+ * The capacity is rounded down to a multiple of PATTERN_CACHE_SEGMENTS words.
+ */
 esp_err_t pattern_cache_init(size_t capacity_bytes);
 
-/** Deinitialize cache and free all entries. */
+/** Deinitialize cache and free the arena. Handles must be released first. */
 void pattern_cache_deinit(void);
 
 /** Clear all entries but keep cache initialized. */
 void pattern_cache_clear(void);
 
-/** Remove a single entry by ID. */
+/** Remove the entries with this ID, in every class. */
 void pattern_cache_invalidate(const char* pattern_id);
 
 /**
- * Try to get cached data pointer by ID.
- * On success, returns true and sets out_ptr/out_size.
- * The returned pointer remains valid until the entry is evicted.
+ * Test whether an ID is cached (counts as a hit/miss for cls).
+ * On success, returns true and sets out_size when non-NULL. No pointer is
+ * handed out: use pattern_cache_acquire() to read the data.
  */
-bool pattern_cache_try_get(const char* pattern_id, const uint8_t** out_ptr, size_t* out_size);
+bool pattern_cache_try_get(const char* pattern_id, pattern_cache_class_t cls, size_t* out_size);
+
+/**
+ * Test whether an ID is cached without recording a hit/miss or refreshing
+ * its priority. For housekeeping probes (e.g. preload) that should not
+ * skew the class stats.
+ */
+bool pattern_cache_contains(const char* pattern_id, pattern_cache_class_t cls);
 
 /**
  * Insert or replace an entry by copying data into cache memory.
- * If necessary, evicts LRU entries to make room. If item is larger than
- * capacity, the call is a no-op and returns ESP_OK (uncached).
+ * If necessary, evicts the lowest-priority entries to make room. If the item
+ * does not fit the capacity or its class quota, the call is a no-op and
+ * returns ESP_OK (uncached). Its load cost is estimated from the class average.
  */
-esp_err_t pattern_cache_put_copy(const char* pattern_id, const uint8_t* data, size_t size);
+esp_err_t pattern_cache_put_copy(const char* pattern_id, pattern_cache_class_t cls,
+                                 const uint8_t* data, size_t size);
+
+/**
+ * Look up an entry and pin it. Counts as a hit/miss for cls like try_get.
+ * @return ESP_OK with out_handle/out_ptr/out_size set, ESP_ERR_NOT_FOUND on miss
+ */
+esp_err_t pattern_cache_acquire(const char* pattern_id, pattern_cache_class_t cls,
+                                pattern_cache_handle_t* out_handle,
+                                const uint8_t** out_ptr, size_t* out_size);
+
+/**
+ * Reserve arena space for an entry and return it pinned but not yet visible,
+ * so a load can read straight into cache memory. Fill *out_buf, then either
+ * pattern_cache_commit() it or pattern_cache_release() to discard it.
+ * @return ESP_OK, ESP_ERR_NO_MEM if pinned entries hold the room (or size
+ *         exceeds capacity or the class quota), ESP_ERR_INVALID_STATE if not
+ *         initialized
+ */
+esp_err_t pattern_cache_reserve(const char* pattern_id, pattern_cache_class_t cls, size_t size,
+                                pattern_cache_handle_t* out_handle, uint8_t** out_buf);
+
+/**
+ * Publish a reserved entry with its final size (<= the reserved size),
+ * replacing any cached entry with the same ID. The handle stays pinned.
+ * The time since reserve is recorded as the entry's load cost.
+ */
+esp_err_t pattern_cache_commit(pattern_cache_handle_t handle, size_t size);
+
+/**
+ * Insert a heap buffer and return the entry pinned. A cacheable buffer is
+ * copied into the arena and freed; otherwise (too large, or the space is held
+ * by pinned entries) the handle keeps the buffer and frees it on release.
+ * Prefer pattern_cache_reserve() to avoid the intermediate buffer. On error
+ * the buffer is freed.
+ */
+esp_err_t pattern_cache_put_take(const char* pattern_id, pattern_cache_class_t cls,
+                                 uint8_t* data, size_t size, pattern_cache_handle_t* out_handle);
+
+/** Data pointer/size of a pinned handle. */
+const uint8_t* pattern_cache_handle_data(pattern_cache_handle_t handle, size_t* out_size);
+
+/** Unpin a handle; frees detached entries on last release. NULL is ignored. */
+void pattern_cache_release(pattern_cache_handle_t handle);
+
+/**
+ * Pin a handle's entry in a slot, replacing (and unpinning) what the slot
+ * held. Pinning the ACTIVE slot to the entry held by NEXT clears NEXT. A NULL
+ * handle just clears the slot.
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND (slot cleared) if the handle's entry is
+ *         not in the cache (uncached or detached)
+ */
+esp_err_t pattern_cache_pin(pattern_cache_pin_t slot, pattern_cache_handle_t handle);
+
+/** Clear a slot only if it still holds the handle's entry. */
+void pattern_cache_unpin(pattern_cache_pin_t slot, pattern_cache_handle_t handle);
+
+/**
+ * Cap the arena bytes a class may hold (default: whole capacity). Inserts
+ * over the cap evict that class's own entries first; the cap is applied
+ * immediately.
+ */
+esp_err_t pattern_cache_set_quota(pattern_cache_class_t cls, size_t quota_bytes);
+
+/** Per-class statistics; zeroed if not initialized. */
+void pattern_cache_class_stats(pattern_cache_class_t cls, pattern_cache_class_stats_t* out);
 
-/** Retrieve basic statistics. */
+/** Retrieve basic statistics (all classes). */
 void pattern_cache_stats(uint32_t* out_hits, uint32_t* out_misses, size_t* out_used_bytes, size_t* out_entry_count);
 
 #ifdef __cplusplus
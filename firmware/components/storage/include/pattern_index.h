@@ -0,0 +1,85 @@
+/**
+ * @file pattern_index.h
+ * @brief In-RAM index of stored patterns
+ *
+ * Built once at mount by scanning /littlefs/patterns, then kept current by
+ * the storage CRUD calls. Count, list and per-pattern lookups are served
+ * from RAM instead of readdir()/stat() over LittleFS. Entries are kept
+ * sorted by ID so paged listings are stable between calls.
+ */
+
+#ifndef PRISM_PATTERN_INDEX_H
+#define PRISM_PATTERN_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "pattern_metadata.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PATTERN_INDEX_CAPACITY  32  /* ADR-006 ceiling (25) plus headroom for strays */
+#define PATTERN_INDEX_ID_MAX    48  /* IDs up to 47 chars; storage sizes its "<id>.tmp" path buffers from this */
+#define PATTERN_INDEX_HEAD_SIZE 80  /* sizeof(prism_header_v11_t) */
+
+/** What the index knows about one pattern file */
+typedef struct {
+    char id[PATTERN_INDEX_ID_MAX];  /**< Pattern ID (file name without .bin) */
+    uint32_t size;                  /**< File size in bytes */
+    uint32_t mtime;                 /**< Modification time (seconds) */
+    bool is_prism;                  /**< Starts with a parseable .prism header */
+    bool crc_verified;              /**< Header CRC checked against the stored bytes */
+    uint16_t version;               /**< .prism header fields (valid if is_prism) */
+    uint16_t led_count;
+    uint32_t frame_count;
+    uint32_t fps;
+    uint8_t color_format;
+    uint8_t compression;
+    prism_pattern_meta_v11_t meta;
+} pattern_index_entry_t;
+
+/**
+ * Rebuild the index from a pattern directory: one readdir() pass, one stat()
+ * and one header read per .bin file. Temp files left by an interrupted write
+ * (*.tmp) are removed on the way. A missing directory yields an empty index.
+ */
+esp_err_t pattern_index_build(const char *dir);
+
+/** Drop every entry (storage unmounted) */
+void pattern_index_clear(void);
+
+/**
+ * Insert or replace an entry. Header fields are parsed from the first
+ * head_len bytes of the file (PATTERN_INDEX_HEAD_SIZE is enough).
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM if the index is full
+ */
+esp_err_t pattern_index_put(const char *id, const uint8_t *head, size_t head_len,
+                            uint32_t size, uint32_t mtime);
+
+/** Remove an entry; no-op if absent */
+void pattern_index_remove(const char *id);
+
+/** Record that a pattern's header CRC matched when it was read */
+void pattern_index_mark_verified(const char *id);
+
+/** Number of indexed patterns */
+size_t pattern_index_count(void);
+
+/** Copy one entry by ID; false if not indexed */
+bool pattern_index_get(const char *id, pattern_index_entry_t *out);
+
+/**
+ * Copy up to max entries starting at position start (ID order).
+ * @return Entries copied (0 once start reaches the count)
+ */
+size_t pattern_index_page(size_t start, pattern_index_entry_t *out, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PRISM_PATTERN_INDEX_H
@@ -14,8 +14,11 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "prism_config.h"
+#include "pattern_cache.h"
+#include "pattern_index.h"
 #include <stdint.h>
 #include <stddef.h>
+#include <stdio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,6 +27,7 @@ extern "C" {
 // ADR-005: Storage mount path
 #define STORAGE_MOUNT_PATH  "/littlefs"
 #define STORAGE_PARTITION   "littlefs"
+#define STORAGE_PATTERN_DIR STORAGE_MOUNT_PATH "/patterns"
 
 // ADR-004/ADR-006: Pattern storage bounds
 // Use canonical maximum size from CANON (256KB), minimum count from ADR-006
@@ -35,7 +39,7 @@ extern "C" {
  * @brief Initialize storage subsystem
  *
  * Mounts LittleFS at /littlefs (ADR-005) and validates partition (ADR-007).
- * Auto-formats filesystem on first boot.
+ * Auto-formats filesystem on first boot, then builds the pattern index.
  *
  * @return ESP_OK on success
  * @return ESP_ERR_NOT_FOUND if partition not found
@@ -68,7 +72,8 @@ void storage_task(void *pvParameters);
 /**
  * @brief Create a new pattern in storage
  *
- * Writes pattern binary data to filesystem. Enforces ADR-006 bounds:
+ * Writes pattern binary data to filesystem through the streaming writer, so
+ * an existing pattern with the same ID is replaced atomically. Enforces ADR-006 bounds:
  * - Pattern size: max 100KB
  * - Pattern count: max 25 patterns
  *
@@ -98,6 +103,26 @@ esp_err_t storage_pattern_create(const char *pattern_id, const uint8_t *data, si
  */
 esp_err_t storage_pattern_read(const char *pattern_id, uint8_t *buffer, size_t buffer_size, size_t *out_size);
 
+/**
+ * @brief Pin a pattern blob for in-place reading
+ *
+ * Returns the cached blob without copying when present; otherwise reads the
+ * file into an exactly-sized buffer that is inserted into the cache. The data
+ * stays valid until pattern_cache_release(*out_handle), even if the entry is
+ * evicted, replaced or deleted meanwhile.
+ *
+ * @param pattern_id Pattern identifier
+ * @param out_handle Pinned cache handle (release with pattern_cache_release)
+ * @param out_data Pattern bytes
+ * @param out_size Pattern length
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_ARG if parameters are invalid
+ * @return ESP_ERR_NOT_FOUND if pattern doesn't exist
+ * @return ESP_ERR_INVALID_CRC if the .prism header CRC is wrong
+ */
+esp_err_t storage_pattern_acquire(const char *pattern_id, pattern_cache_handle_t *out_handle,
+                                  const uint8_t **out_data, size_t *out_size);
+
 /**
  * @brief Delete a pattern from storage
  *
@@ -113,7 +138,7 @@ esp_err_t storage_pattern_delete(const char *pattern_id);
 /**
  * @brief List all stored patterns
  *
- * Enumerates pattern files in storage directory.
+ * Copies pattern IDs from the pattern index, in ID order.
  *
  * @param pattern_list Array of pattern ID strings (caller must allocate)
  * @param max_count Maximum patterns to list
@@ -126,7 +151,7 @@ esp_err_t storage_pattern_list(char **pattern_list, size_t max_count, size_t *ou
 /**
  * @brief Get total pattern count
  *
- * Returns number of patterns currently stored.
+ * Returns number of patterns currently stored (from the pattern index).
  *
  * @param out_count Pattern count (output parameter)
  * @return ESP_OK on success
@@ -134,6 +159,118 @@ esp_err_t storage_pattern_list(char **pattern_list, size_t max_count, size_t *ou
  */
 esp_err_t storage_pattern_count(size_t *out_count);
 
+/**
+ * @brief Page through index entries (size, mtime, header fields)
+ *
+ * @param start First entry to copy (ID order)
+ * @param entries Output array (caller must allocate)
+ * @param max_count Capacity of entries
+ * @param out_count Entries copied (0 once start is past the end)
+ * @param out_total Total patterns indexed (optional)
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_ARG if entries or out_count is NULL
+ */
+esp_err_t storage_pattern_list_entries(size_t start, pattern_index_entry_t *entries, size_t max_count,
+                                       size_t *out_count, size_t *out_total);
+
+// ============================================================================
+// Streaming Pattern Writes
+// ============================================================================
+
+/** Suggested staging buffer for storage_pattern_write_begin() */
+#define STORAGE_WRITE_STAGE_SIZE 4096
+
+/**
+ * @brief In-progress pattern write
+ *
+ * Bytes go to <id>.tmp and only replace <id>.bin on commit, so a reader
+ * never sees a partial pattern and an interrupted write leaves the old one.
+ * Opaque to callers; lives wherever the caller keeps it (no allocation).
+ */
+typedef struct {
+    FILE *file;                             /**< Open temp file (NULL when idle) */
+    char id[PATTERN_INDEX_ID_MAX];          /**< Pattern being written */
+    size_t expected_size;                   /**< Size announced at begin */
+    size_t written;                         /**< End of the furthest write */
+    size_t pos;                             /**< File position (SIZE_MAX: seek first) */
+    uint8_t head[PATTERN_INDEX_HEAD_SIZE];  /**< First bytes, for the index entry */
+} storage_pattern_writer_t;
+
+/**
+ * @brief Start writing a pattern of known size
+ *
+ * Checks the size and count bounds (replacing an existing pattern does not add
+ * one) and free space, then opens the temp file. If stage is given it becomes
+ * the file's stdio buffer, so appends reach LittleFS in stage_size blocks
+ * without a heap allocation.
+ *
+ * @param w Writer to initialise
+ * @param pattern_id Pattern identifier (no extension)
+ * @param size Total bytes that will be appended (max PATTERN_SIZE_MAX)
+ * @param stage Staging buffer (optional; must outlive the write)
+ * @param stage_size Size of stage
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_ARG if parameters are invalid
+ * @return ESP_ERR_INVALID_SIZE if size exceeds the pattern limit
+ * @return ESP_ERR_NO_MEM if storage is full or the file cannot be created
+ */
+esp_err_t storage_pattern_write_begin(storage_pattern_writer_t *w, const char *pattern_id, size_t size,
+                                      uint8_t *stage, size_t stage_size);
+
+/**
+ * @brief Append the next bytes of the pattern
+ *
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_STATE if no write is open
+ * @return ESP_ERR_INVALID_SIZE if this would pass the size given at begin
+ * @return ESP_FAIL if the filesystem write fails
+ */
+esp_err_t storage_pattern_write_append(storage_pattern_writer_t *w, const uint8_t *data, size_t len);
+
+/**
+ * @brief Write bytes at an offset (out-of-order arrival)
+ *
+ * Seeks only when offset differs from the end of the previous write, so
+ * in-order calls cost the same as append. Bytes skipped over read back as
+ * zero until written.
+ *
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_STATE if no write is open
+ * @return ESP_ERR_INVALID_SIZE if offset + len passes the size given at begin
+ * @return ESP_FAIL if the filesystem seek or write fails
+ */
+esp_err_t storage_pattern_write_at(storage_pattern_writer_t *w, size_t offset,
+                                   const uint8_t *data, size_t len);
+
+/**
+ * @brief Read back bytes already written (e.g. to CRC them late)
+ *
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_STATE if no write is open
+ * @return ESP_ERR_INVALID_SIZE if the range is past the furthest write
+ * @return ESP_FAIL if the filesystem read fails
+ */
+esp_err_t storage_pattern_write_read_back(storage_pattern_writer_t *w, size_t offset,
+                                          uint8_t *out, size_t len);
+
+/**
+ * @brief Finish the write: flush, fsync, rename over <id>.bin
+ *
+ * Updates the index and drops any cached copy of the old pattern. The temp
+ * file is removed on any failure.
+ *
+ * @return ESP_OK on success
+ * @return ESP_ERR_INVALID_STATE if no write is open
+ * @return ESP_ERR_INVALID_SIZE if the file is shorter than announced
+ * @return ESP_FAIL if flush/sync/rename fails
+ */
+esp_err_t storage_pattern_write_commit(storage_pattern_writer_t *w);
+
+/**
+ * @brief Abandon the write and remove the temp file (no-op if idle)
+ */
+void storage_pattern_write_abort(storage_pattern_writer_t *w);
+
 // ============================================================================
 // Template Storage API (Atomic Write Semantics)
 // ============================================================================
@@ -1,70 +1,372 @@
 /**
  * @file pattern_cache.c
- * @brief RAM hot cache for pattern binaries with LRU eviction
+ * @brief RAM hot cache for pattern binaries with cost-aware (GDSF) eviction
+ *
+ * One arena of PATTERN_CACHE_SEGMENTS equal segments is allocated at init;
+ * each entry occupies a contiguous run of them. Entry records live in a
+ * static table and are found through an open-addressed (linear probing)
+ * hash of the ID, so nothing is allocated or freed per entry.
+ *
+ * Each entry carries a Greedy-Dual-Size-Frequency priority
+ *     H = L + freq * load_cost_us / size_kb
+ * where L is the priority of the last entry evicted, so resident entries
+ * age relative to newcomers. Eviction takes the run whose most valuable
+ * occupant has the lowest H (recency breaks ties).
  */
 
 #include "pattern_cache.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include <string.h>
 #include <stdlib.h>
 
+#define HASH_SLOTS  128         // Power of two, > 2x PATTERN_CACHE_MAX_ENTRIES
+#define HASH_MASK   (HASH_SLOTS - 1)
+#define NONE        0xFF        // Empty hash slot / free segment
+#define FREQ_MAX    255
+#define DEFAULT_COST_US_PER_KB  250     // Until a reserve/commit load has been timed
+
+_Static_assert(PATTERN_CACHE_MAX_ENTRIES < NONE, "entry index must fit a uint8_t");
+_Static_assert(HASH_SLOTS > PATTERN_CACHE_MAX_ENTRIES, "hash must keep an empty slot");
+
 typedef struct cache_entry {
     char id[PATTERN_CACHE_ID_MAX];
-    uint8_t* data;
+    uint32_t hash;
+    uint8_t* data;          // Arena run, or a heap buffer when seg_count == 0
     size_t size;
-    struct cache_entry* prev;
-    struct cache_entry* next;
+    uint32_t last_used;     // s_clock at last access
+    uint32_t refcount;      // Outstanding pattern_cache_handle_t and slot pins
+    uint64_t priority;      // GDSF H value
+    uint32_t cost_us;       // Measured or estimated load cost (flash read + CRC)
+    int64_t load_start_us;  // Reservation time, for timing the load
+    uint16_t seg_first;
+    uint16_t seg_count;
+    uint8_t cls;            // pattern_cache_class_t
+    uint8_t freq;           // Accesses while resident (saturating)
+    bool in_use;            // Table slot taken
+    bool linked;            // In the hash; otherwise detached and freed on last release
 } cache_entry_t;
 
 static const char* TAG = "pattern_cache";
 
 static SemaphoreHandle_t s_mutex = NULL;
 static bool s_inited = false;
-static size_t s_capacity = PATTERN_CACHE_DEFAULT_CAPACITY;
+static uint8_t* s_arena = NULL;
+static size_t s_seg_size = 0;
+static size_t s_arena_size = 0;
+static cache_entry_t s_entries[PATTERN_CACHE_MAX_ENTRIES];
+static uint8_t s_slots[HASH_SLOTS];                     // Entry index or NONE
+static uint8_t s_seg_owner[PATTERN_CACHE_SEGMENTS];     // Entry index or NONE
+static uint32_t s_clock = 0;
 static size_t s_used = 0;
-static cache_entry_t* s_head = NULL; // MRU
-static cache_entry_t* s_tail = NULL; // LRU
+static size_t s_count = 0;
 static uint32_t s_hits = 0;
 static uint32_t s_misses = 0;
-static size_t s_count = 0;
+static uint64_t s_inflation = 0;                        // GDSF L
+static cache_entry_t* s_pins[PATTERN_CACHE_PIN_COUNT];
+
+typedef struct {
+    size_t quota;
+    size_t held;            // Arena bytes held by this class (cached, reserved or detached)
+    size_t used;            // Bytes in linked entries
+    size_t count;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t cost_us_per_kb;    // Running average of timed loads
+} class_state_t;
+
+static class_state_t s_class[PATTERN_CACHE_CLASS_COUNT];
 
 static void lock(void) { if (s_mutex) xSemaphoreTake(s_mutex, portMAX_DELAY); }
 static void unlock(void) { if (s_mutex) xSemaphoreGive(s_mutex); }
 
-static void list_remove(cache_entry_t* e) {
-    if (!e) return;
-    if (e->prev) e->prev->next = e->next; else s_head = e->next;
-    if (e->next) e->next->prev = e->prev; else s_tail = e->prev;
-    e->prev = e->next = NULL;
-}
+static inline uint8_t entry_index(const cache_entry_t* e) { return (uint8_t)(e - s_entries); }
 
-static void list_push_front(cache_entry_t* e) {
-    e->prev = NULL;
-    e->next = s_head;
-    if (s_head) s_head->prev = e;
-    s_head = e;
-    if (!s_tail) s_tail = e;
+// FNV-1a
+// Entries are keyed by (class, ID): a template and a user pattern may share an ID
+static uint32_t hash_id(const char* id, pattern_cache_class_t cls) {
+    uint32_t h = (2166136261u ^ (uint8_t)cls) * 16777619u;
+    for (size_t i = 0; i < PATTERN_CACHE_ID_MAX && id[i]; ++i) {
+        h = (h ^ (uint8_t)id[i]) * 16777619u;
+    }
+    return h;
 }
 
-static cache_entry_t* find_entry(const char* id) {
-    for (cache_entry_t* it = s_head; it; it = it->next) {
-        if (strncmp(it->id, id, PATTERN_CACHE_ID_MAX) == 0) {
-            return it;
+static cache_entry_t* find_entry(const char* id, pattern_cache_class_t cls) {
+    uint32_t h = hash_id(id, cls);
+    for (size_t i = h & HASH_MASK; s_slots[i] != NONE; i = (i + 1) & HASH_MASK) {
+        cache_entry_t* e = &s_entries[s_slots[i]];
+        if (e->hash == h && e->cls == cls && strncmp(e->id, id, PATTERN_CACHE_ID_MAX) == 0) {
+            return e;
         }
     }
     return NULL;
 }
 
-static void evict_until_free(size_t needed) {
-    while (s_tail && (s_capacity - s_used) < needed) {
-        cache_entry_t* victim = s_tail;
-        list_remove(victim);
-        if (victim->data) free(victim->data);
-        s_used -= victim->size;
+static void hash_insert(cache_entry_t* e) {
+    size_t i = e->hash & HASH_MASK;
+    while (s_slots[i] != NONE) {
+        i = (i + 1) & HASH_MASK;
+    }
+    s_slots[i] = entry_index(e);
+}
+
+// Backward-shift deletion keeps probe chains intact without tombstones
+static void hash_remove(cache_entry_t* e) {
+    const uint8_t idx = entry_index(e);
+    size_t i = e->hash & HASH_MASK;
+    while (s_slots[i] != idx) {
+        i = (i + 1) & HASH_MASK;
+    }
+    for (size_t j = (i + 1) & HASH_MASK; s_slots[j] != NONE; j = (j + 1) & HASH_MASK) {
+        size_t home = s_entries[s_slots[j]].hash & HASH_MASK;
+        bool home_in_gap = (i < j) ? (home > i && home <= j) : (home > i || home <= j);
+        if (!home_in_gap) {
+            s_slots[i] = s_slots[j];
+            i = j;
+        }
+    }
+    s_slots[i] = NONE;
+}
+
+static inline size_t size_kb(size_t size) { return (size + 1023) / 1024; }
+
+static void entry_reprioritize(cache_entry_t* e) {
+    e->priority = s_inflation + (uint64_t)e->freq * e->cost_us / size_kb(e->size);
+}
+
+// Return an entry's storage (segments or heap buffer) and its table slot
+static void entry_free(cache_entry_t* e) {
+    if (e->seg_count > 0) {
+        memset(&s_seg_owner[e->seg_first], NONE, e->seg_count);
+        s_class[e->cls].held -= e->size;
+    } else {
+        free(e->data);
+    }
+    memset(e, 0, sizeof(*e));
+}
+
+// Unlink an entry from the cache. Pinned entries are detached instead of
+// freed so outstanding handles stay valid.
+static void entry_drop(cache_entry_t* e) {
+    if (e->linked) {
+        hash_remove(e);
+        e->linked = false;
+        s_used -= e->size;
         s_count--;
-        free(victim);
+        s_class[e->cls].used -= e->size;
+        s_class[e->cls].count--;
+    }
+    if (e->refcount == 0) {
+        entry_free(e);
+    }
+}
+
+// Count an access and raise the entry's priority accordingly
+static void entry_touch(cache_entry_t* e) {
+    e->last_used = ++s_clock;
+    if (e->freq < FREQ_MAX) e->freq++;
+    entry_reprioritize(e);
+}
+
+// Lower (priority, last_used) is evicted first
+static bool evicts_before(const cache_entry_t* a, const cache_entry_t* b) {
+    if (a->priority != b->priority) return a->priority < b->priority;
+    return a->last_used < b->last_used;
+}
+
+// Eviction (not invalidation) advances L to the victim's priority
+static void entry_evict(cache_entry_t* e) {
+    if (e->priority > s_inflation) s_inflation = e->priority;
+    entry_drop(e);
+}
+
+static bool evictable(const cache_entry_t* e) {
+    return e->linked && e->refcount == 0;
+}
+
+// Lowest-priority evictable entry, optionally of one class
+static cache_entry_t* find_victim(int cls) {
+    cache_entry_t* victim = NULL;
+    for (size_t i = 0; i < PATTERN_CACHE_MAX_ENTRIES; ++i) {
+        cache_entry_t* e = &s_entries[i];
+        if (!evictable(e) || (cls >= 0 && e->cls != cls)) continue;
+        if (!victim || evicts_before(e, victim)) victim = e;
+    }
+    return victim;
+}
+
+// A free table slot, evicting the lowest-priority unpinned entry if the
+// table is full
+static cache_entry_t* alloc_slot(void) {
+    for (size_t i = 0; i < PATTERN_CACHE_MAX_ENTRIES; ++i) {
+        if (!s_entries[i].in_use) {
+            s_entries[i].in_use = true;
+            return &s_entries[i];
+        }
+    }
+    cache_entry_t* victim = find_victim(-1);
+    if (!victim) {
+        return NULL;
+    }
+    entry_evict(victim);
+    victim->in_use = true;
+    return victim;
+}
+
+// Claim `count` contiguous segments. Picks the window whose most valuable
+// occupant is cheapest to lose (a fully free window costs nothing) and
+// evicts every entry touching it; windows overlapping a pinned entry are
+// skipped.
+static bool alloc_run(size_t count, uint16_t* out_first) {
+    size_t best = SIZE_MAX;
+    const cache_entry_t* best_cost = NULL;     // NULL = free window
+    size_t s = 0;
+    while (s + count <= PATTERN_CACHE_SEGMENTS) {
+        const cache_entry_t* cost = NULL;
+        size_t pinned_at = SIZE_MAX;
+        for (size_t i = s; i < s + count; ++i) {
+            if (s_seg_owner[i] == NONE) continue;
+            const cache_entry_t* o = &s_entries[s_seg_owner[i]];
+            if (!evictable(o)) {
+                pinned_at = i;
+                break;
+            }
+            if (!cost || evicts_before(cost, o)) cost = o;
+        }
+        if (pinned_at != SIZE_MAX) {
+            s = pinned_at + 1;
+            continue;
+        }
+        if (best == SIZE_MAX || !cost || evicts_before(cost, best_cost)) {
+            best = s;
+            best_cost = cost;
+            if (!cost) break;
+        }
+        s++;
+    }
+    if (best == SIZE_MAX) {
+        return false;
+    }
+    for (size_t i = best; i < best + count; ++i) {
+        if (s_seg_owner[i] != NONE) {
+            entry_evict(&s_entries[s_seg_owner[i]]);
+        }
+    }
+    *out_first = (uint16_t)best;
+    return true;
+}
+
+// Evict the class's own lowest-priority entries until `size` more bytes fit
+// its quota. Quotas are caps, so one class filling up never pushes out the
+// other class's share.
+static bool make_quota_room(pattern_cache_class_t cls, size_t size) {
+    class_state_t* c = &s_class[cls];
+    if (size > c->quota) {
+        return false;
+    }
+    while (c->held + size > c->quota) {
+        cache_entry_t* victim = find_victim((int)cls);
+        if (!victim) {
+            return false;
+        }
+        entry_evict(victim);
+    }
+    return true;
+}
+
+// Estimated load cost for inserts that were not timed through reserve/commit
+static uint32_t estimate_cost_us(pattern_cache_class_t cls, size_t size) {
+    return (uint32_t)(s_class[cls].cost_us_per_kb * size_kb(size));
+}
+
+// Table slot plus arena run for `size` bytes, not yet linked. NULL if the
+// class quota or the room is held by pinned entries.
+static cache_entry_t* entry_alloc(const char* id, pattern_cache_class_t cls, size_t size) {
+    // A stale copy being replaced should not count against the quota
+    cache_entry_t* existing = find_entry(id, cls);
+    if (existing && evictable(existing)) {
+        entry_drop(existing);
+    }
+    if (!make_quota_room(cls, size)) {
+        return NULL;
+    }
+    cache_entry_t* e = alloc_slot();
+    if (!e) {
+        return NULL;
+    }
+    size_t count = (size + s_seg_size - 1) / s_seg_size;
+    uint16_t first = 0;
+    if (!alloc_run(count, &first)) {
+        memset(e, 0, sizeof(*e));
+        return NULL;
+    }
+    strlcpy(e->id, id, sizeof(e->id));
+    e->hash = hash_id(e->id, cls);
+    e->data = s_arena + (size_t)first * s_seg_size;
+    e->size = size;
+    e->seg_first = first;
+    e->seg_count = (uint16_t)count;
+    e->cls = (uint8_t)cls;
+    e->cost_us = estimate_cost_us(cls, size);
+    memset(&s_seg_owner[first], entry_index(e), count);
+    s_class[cls].held += size;
+    return e;
+}
+
+// Make an entry visible, replacing any cached entry with the same ID
+static void entry_link(cache_entry_t* e) {
+    cache_entry_t* existing = find_entry(e->id, (pattern_cache_class_t)e->cls);
+    if (existing) {
+        entry_drop(existing);
+    }
+    hash_insert(e);
+    e->linked = true;
+    s_used += e->size;
+    s_count++;
+    s_class[e->cls].used += e->size;
+    s_class[e->cls].count++;
+    entry_touch(e);
+}
+
+// Drop one pin; frees detached entries on the last one. Caller holds the lock.
+static void release_locked(cache_entry_t* e) {
+    if (e->refcount > 0) {
+        e->refcount--;
+    }
+    if (e->refcount == 0 && !e->linked) {
+        entry_free(e);
+    }
+}
+
+static void record_lookup(pattern_cache_class_t cls, bool hit) {
+    if (hit) {
+        s_hits++;
+        s_class[cls].hits++;
+    } else {
+        s_misses++;
+        s_class[cls].misses++;
+    }
+}
+
+static bool class_valid(pattern_cache_class_t cls) {
+    return (unsigned)cls < PATTERN_CACHE_CLASS_COUNT;
+}
+
+static void drop_all(void) {
+    for (size_t i = 0; i < PATTERN_CACHE_MAX_ENTRIES; ++i) {
+        if (s_entries[i].in_use) {
+            entry_drop(&s_entries[i]);
+        }
+    }
+    memset(s_slots, NONE, sizeof(s_slots));
+    s_used = 0;
+    s_count = 0;
+    for (size_t c = 0; c < PATTERN_CACHE_CLASS_COUNT; ++c) {
+        s_class[c].used = 0;
+        s_class[c].count = 0;
     }
 }
 
@@ -73,28 +375,57 @@ esp_err_t pattern_cache_init(size_t capacity_bytes) {
         ESP_LOGW(TAG, "already initialized");
         return ESP_OK;
     }
+    size_t capacity = capacity_bytes > 0 ? capacity_bytes : PATTERN_CACHE_DEFAULT_CAPACITY;
+    s_seg_size = (capacity / PATTERN_CACHE_SEGMENTS) & ~(size_t)3;   // Word-aligned runs
+    if (s_seg_size == 0) s_seg_size = 4;
+    s_arena_size = s_seg_size * PATTERN_CACHE_SEGMENTS;
+
     s_mutex = xSemaphoreCreateMutex();
     if (!s_mutex) return ESP_ERR_NO_MEM;
-    s_capacity = capacity_bytes > 0 ? capacity_bytes : PATTERN_CACHE_DEFAULT_CAPACITY;
-    s_used = 0; s_head = s_tail = NULL; s_hits = s_misses = 0; s_count = 0;
+    s_arena = (uint8_t*)malloc(s_arena_size);
+    if (!s_arena) {
+        vSemaphoreDelete(s_mutex);
+        s_mutex = NULL;
+        ESP_LOGE(TAG, "arena allocation failed (%u bytes)", (unsigned)s_arena_size);
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(s_entries, 0, sizeof(s_entries));
+    memset(s_slots, NONE, sizeof(s_slots));
+    memset(s_seg_owner, NONE, sizeof(s_seg_owner));
+    memset(s_pins, 0, sizeof(s_pins));
+    memset(s_class, 0, sizeof(s_class));
+    for (size_t c = 0; c < PATTERN_CACHE_CLASS_COUNT; ++c) {
+        s_class[c].quota = s_arena_size;
+        s_class[c].cost_us_per_kb = DEFAULT_COST_US_PER_KB;
+    }
+    s_clock = 0; s_used = 0; s_count = 0; s_hits = s_misses = 0; s_inflation = 0;
     s_inited = true;
-    ESP_LOGI(TAG, "initialized (capacity=%u KB)", (unsigned)(s_capacity/1024));
+    ESP_LOGI(TAG, "initialized (capacity=%u KB, %d x %u B segments)",
+             (unsigned)(s_arena_size / 1024), PATTERN_CACHE_SEGMENTS, (unsigned)s_seg_size);
     return ESP_OK;
 }
 
 void pattern_cache_deinit(void) {
     if (!s_inited) return;
     lock();
-    while (s_head) {
-        cache_entry_t* next = s_head->next;
-        if (s_head->data) free(s_head->data);
-        free(s_head);
-        s_head = next;
+    for (size_t i = 0; i < PATTERN_CACHE_PIN_COUNT; ++i) {
+        if (s_pins[i]) release_locked(s_pins[i]);
+        s_pins[i] = NULL;
+    }
+    drop_all();
+    size_t pinned = 0;
+    for (size_t i = 0; i < PATTERN_CACHE_MAX_ENTRIES; ++i) {
+        if (s_entries[i].in_use && s_entries[i].seg_count > 0) pinned++;
     }
-    s_tail = NULL;
-    s_used = 0;
-    s_count = 0;
     unlock();
+    if (pinned == 0) {
+        free(s_arena);
+    } else {
+        // Outstanding handles point into the arena; leak it rather than free under them
+        ESP_LOGW(TAG, "deinit with %u pinned entries; arena not freed", (unsigned)pinned);
+    }
+    s_arena = NULL;
     vSemaphoreDelete(s_mutex);
     s_mutex = NULL;
     s_inited = false;
@@ -103,88 +434,256 @@ void pattern_cache_deinit(void) {
 void pattern_cache_clear(void) {
     if (!s_inited) return;
     lock();
-    while (s_head) {
-        cache_entry_t* next = s_head->next;
-        if (s_head->data) free(s_head->data);
-        free(s_head);
-        s_head = next;
-    }
-    s_tail = NULL;
-    s_used = 0;
-    s_count = 0;
+    drop_all();
     unlock();
 }
 
 void pattern_cache_invalidate(const char* pattern_id) {
     if (!s_inited || !pattern_id) return;
     lock();
-    cache_entry_t* e = find_entry(pattern_id);
-    if (e) {
-        list_remove(e);
-        if (e->data) free(e->data);
-        s_used -= e->size;
-        s_count--;
-        free(e);
+    for (int cls = 0; cls < PATTERN_CACHE_CLASS_COUNT; ++cls) {
+        cache_entry_t* e = find_entry(pattern_id, (pattern_cache_class_t)cls);
+        if (e) {
+            entry_drop(e);
+        }
     }
     unlock();
 }
 
-bool pattern_cache_try_get(const char* pattern_id, const uint8_t** out_ptr, size_t* out_size) {
-    if (!s_inited || !pattern_id) return false;
-    bool found = false;
+bool pattern_cache_try_get(const char* pattern_id, pattern_cache_class_t cls, size_t* out_size) {
+    if (!s_inited || !pattern_id || !class_valid(cls)) return false;
     lock();
-    cache_entry_t* e = find_entry(pattern_id);
+    cache_entry_t* e = find_entry(pattern_id, cls);
     if (e) {
-        // Move to MRU
-        list_remove(e);
-        list_push_front(e);
-        if (out_ptr) *out_ptr = e->data;
+        entry_touch(e);
         if (out_size) *out_size = e->size;
-        s_hits++;
-        found = true;
-    } else {
-        s_misses++;
     }
+    record_lookup(cls, e != NULL);
+    unlock();
+    return e != NULL;
+}
+
+bool pattern_cache_contains(const char* pattern_id, pattern_cache_class_t cls) {
+    if (!s_inited || !pattern_id || !class_valid(cls)) return false;
+    lock();
+    bool found = find_entry(pattern_id, cls) != NULL;
     unlock();
     return found;
 }
 
-esp_err_t pattern_cache_put_copy(const char* pattern_id, const uint8_t* data, size_t size) {
-    if (!s_inited || !pattern_id || !data || size == 0) return ESP_ERR_INVALID_ARG;
-    if (size > s_capacity) {
+esp_err_t pattern_cache_put_copy(const char* pattern_id, pattern_cache_class_t cls,
+                                 const uint8_t* data, size_t size) {
+    if (!s_inited || !pattern_id || !class_valid(cls) || !data || size == 0) return ESP_ERR_INVALID_ARG;
+    if (size > s_arena_size) {
         // Too large to cache; treat as no-op
-        ESP_LOGD(TAG, "skip caching '%s' (%zu > capacity %u)", pattern_id, size, (unsigned)s_capacity);
+        ESP_LOGD(TAG, "skip caching '%s' (%zu > capacity %u)", pattern_id, size, (unsigned)s_arena_size);
         return ESP_OK;
     }
 
     lock();
+    cache_entry_t* e = entry_alloc(pattern_id, cls, size);
+    if (!e) {
+        // Over quota or remaining space is pinned; treat as uncached
+        unlock();
+        ESP_LOGD(TAG, "skip caching '%s' (quota or pinned entries hold the space)", pattern_id);
+        return ESP_OK;
+    }
+    memcpy(e->data, data, size);
+    entry_link(e);
+    unlock();
+    return ESP_OK;
+}
 
-    // Replace if exists
-    cache_entry_t* existing = find_entry(pattern_id);
-    if (existing) {
-        list_remove(existing);
-        if (existing->data) free(existing->data);
-        s_used -= existing->size;
-        s_count--;
-        free(existing);
+esp_err_t pattern_cache_acquire(const char* pattern_id, pattern_cache_class_t cls,
+                                pattern_cache_handle_t* out_handle,
+                                const uint8_t** out_ptr, size_t* out_size) {
+    if (!s_inited || !pattern_id || !class_valid(cls) || !out_handle) return ESP_ERR_INVALID_ARG;
+    lock();
+    cache_entry_t* e = find_entry(pattern_id, cls);
+    if (e) {
+        entry_touch(e);
+        e->refcount++;
+        *out_handle = e;
+        if (out_ptr) *out_ptr = e->data;
+        if (out_size) *out_size = e->size;
     }
+    record_lookup(cls, e != NULL);
+    unlock();
+    return e ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
 
-    evict_until_free(size);
+esp_err_t pattern_cache_reserve(const char* pattern_id, pattern_cache_class_t cls, size_t size,
+                                pattern_cache_handle_t* out_handle, uint8_t** out_buf) {
+    if (!pattern_id || !class_valid(cls) || size == 0 || !out_handle || !out_buf) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_inited) return ESP_ERR_INVALID_STATE;
+    if (size > s_arena_size) return ESP_ERR_NO_MEM;
 
-    cache_entry_t* e = (cache_entry_t*)calloc(1, sizeof(cache_entry_t));
-    if (!e) { unlock(); return ESP_ERR_NO_MEM; }
-    strlcpy(e->id, pattern_id, sizeof(e->id));
-    e->data = (uint8_t*)malloc(size);
-    if (!e->data) { free(e); unlock(); return ESP_ERR_NO_MEM; }
-    memcpy(e->data, data, size);
-    e->size = size;
-    list_push_front(e);
-    s_used += size;
-    s_count++;
+    lock();
+    cache_entry_t* e = entry_alloc(pattern_id, cls, size);
+    if (e) {
+        e->refcount = 1;
+        e->load_start_us = esp_timer_get_time();
+    }
+    unlock();
+    if (!e) {
+        return ESP_ERR_NO_MEM;
+    }
+    *out_handle = e;
+    *out_buf = e->data;
+    return ESP_OK;
+}
+
+esp_err_t pattern_cache_commit(pattern_cache_handle_t handle, size_t size) {
+    if (!handle || size == 0 || size > handle->size || handle->seg_count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int64_t elapsed_us = esp_timer_get_time() - handle->load_start_us;
+    lock();
+    if (handle->linked) {
+        unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+    // Hand back segments past the bytes actually written
+    size_t count = (size + s_seg_size - 1) / s_seg_size;
+    if (count < handle->seg_count) {
+        memset(&s_seg_owner[handle->seg_first + count], NONE, handle->seg_count - count);
+        handle->seg_count = (uint16_t)count;
+    }
+    class_state_t* c = &s_class[handle->cls];
+    c->held -= handle->size - size;
+    handle->size = size;
+
+    // The reserve -> commit span is the real load cost; fold it into the
+    // class average used to estimate untimed inserts
+    if (elapsed_us > 0) {
+        handle->cost_us = (elapsed_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)elapsed_us;
+        uint32_t per_kb = (uint32_t)(handle->cost_us / size_kb(size));
+        c->cost_us_per_kb = (c->cost_us_per_kb * 7 + per_kb) / 8;
+    }
+    entry_link(handle);
+    unlock();
+    return ESP_OK;
+}
+
+esp_err_t pattern_cache_put_take(const char* pattern_id, pattern_cache_class_t cls,
+                                 uint8_t* data, size_t size, pattern_cache_handle_t* out_handle) {
+    if (!pattern_id || !class_valid(cls) || !data || size == 0 || !out_handle) {
+        free(data);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    lock();
+    cache_entry_t* e = NULL;
+    if (s_inited && size <= s_arena_size) {
+        e = entry_alloc(pattern_id, cls, size);
+    }
+    if (e) {
+        memcpy(e->data, data, size);
+        free(data);
+        entry_link(e);
+    } else {
+        // Not cacheable right now; the handle alone owns the buffer. A stale
+        // cached copy must not outlive the newer data.
+        cache_entry_t* existing = s_inited ? find_entry(pattern_id, cls) : NULL;
+        if (existing) {
+            entry_drop(existing);
+        }
+        e = alloc_slot();
+        if (!e) {
+            unlock();
+            free(data);
+            return ESP_ERR_NO_MEM;
+        }
+        strlcpy(e->id, pattern_id, sizeof(e->id));
+        e->data = data;
+        e->size = size;
+        e->cls = (uint8_t)cls;
+    }
+    e->refcount = 1;
     unlock();
+
+    *out_handle = e;
     return ESP_OK;
 }
 
+const uint8_t* pattern_cache_handle_data(pattern_cache_handle_t handle, size_t* out_size) {
+    if (!handle) {
+        if (out_size) *out_size = 0;
+        return NULL;
+    }
+    if (out_size) *out_size = handle->size;
+    return handle->data;
+}
+
+void pattern_cache_release(pattern_cache_handle_t handle) {
+    if (!handle) return;
+    lock();
+    release_locked(handle);
+    unlock();
+}
+
+esp_err_t pattern_cache_pin(pattern_cache_pin_t slot, pattern_cache_handle_t handle) {
+    if ((unsigned)slot >= PATTERN_CACHE_PIN_COUNT) return ESP_ERR_INVALID_ARG;
+    if (!s_inited) return ESP_ERR_INVALID_STATE;
+    lock();
+    // Only entries still in the cache can be pinned; detached and uncached
+    // handles go away with their last release
+    cache_entry_t* e = (handle && handle->linked) ? handle : NULL;
+    if (e) {
+        e->refcount++;
+    }
+    if (s_pins[slot]) {
+        release_locked(s_pins[slot]);
+    }
+    s_pins[slot] = e;
+    // The next pattern becoming active frees its NEXT slot
+    if (e && slot == PATTERN_CACHE_PIN_ACTIVE && s_pins[PATTERN_CACHE_PIN_NEXT] == e) {
+        release_locked(e);
+        s_pins[PATTERN_CACHE_PIN_NEXT] = NULL;
+    }
+    unlock();
+    return (e || !handle) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+void pattern_cache_unpin(pattern_cache_pin_t slot, pattern_cache_handle_t handle) {
+    if ((unsigned)slot >= PATTERN_CACHE_PIN_COUNT || !handle || !s_inited) return;
+    lock();
+    if (s_pins[slot] == handle) {
+        release_locked(handle);
+        s_pins[slot] = NULL;
+    }
+    unlock();
+}
+
+esp_err_t pattern_cache_set_quota(pattern_cache_class_t cls, size_t quota_bytes) {
+    if (!class_valid(cls)) return ESP_ERR_INVALID_ARG;
+    if (!s_inited) return ESP_ERR_INVALID_STATE;
+    lock();
+    s_class[cls].quota = quota_bytes < s_arena_size ? quota_bytes : s_arena_size;
+    // Shrink to the new cap now rather than on the next insert
+    (void)make_quota_room(cls, 0);
+    unlock();
+    return ESP_OK;
+}
+
+void pattern_cache_class_stats(pattern_cache_class_t cls, pattern_cache_class_stats_t* out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!s_inited || !class_valid(cls)) return;
+    lock();
+    const class_state_t* c = &s_class[cls];
+    out->hits = c->hits;
+    out->misses = c->misses;
+    out->used_bytes = c->used;
+    out->held_bytes = c->held;
+    out->quota_bytes = c->quota;
+    out->entry_count = c->count;
+    out->cost_us_per_kb = c->cost_us_per_kb;
+    unlock();
+}
+
 void pattern_cache_stats(uint32_t* out_hits, uint32_t* out_misses, size_t* out_used_bytes, size_t* out_entry_count) {
     if (!s_inited) {
         if (out_hits) *out_hits = 0;
@@ -200,4 +699,3 @@ void pattern_cache_stats(uint32_t* out_hits, uint32_t* out_misses, size_t* out_u
     if (out_entry_count) *out_entry_count = s_count;
     unlock();
 }
-
@@ -0,0 +1,229 @@
+/**
+ * @file pattern_index.c
+ * @brief In-RAM index of stored patterns
+ */
+
+#include "pattern_index.h"
+#include "prism_parser.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <sys/stat.h>
+#include <dirent.h>
+#include <string.h>
+#include <stdio.h>
+
+static const char *TAG = "pattern_index";
+
+static SemaphoreHandle_t s_mutex = NULL;
+static pattern_index_entry_t s_entries[PATTERN_INDEX_CAPACITY];    // Sorted by id
+static size_t s_count = 0;
+
+static void lock(void) { if (s_mutex) xSemaphoreTake(s_mutex, portMAX_DELAY); }
+static void unlock(void) { if (s_mutex) xSemaphoreGive(s_mutex); }
+
+// Position of id, or where it would be inserted; *found tells which
+static size_t find_slot(const char *id, bool *found) {
+    size_t lo = 0, hi = s_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int cmp = strncmp(s_entries[mid].id, id, PATTERN_INDEX_ID_MAX);
+        if (cmp == 0) {
+            *found = true;
+            return mid;
+        }
+        if (cmp < 0) lo = mid + 1; else hi = mid;
+    }
+    *found = false;
+    return lo;
+}
+
+// Header fields from the start of a pattern file
+static void fill_header(pattern_index_entry_t *e, const uint8_t *data, size_t len) {
+    e->is_prism = false;
+    e->crc_verified = false;
+    if (len < sizeof(prism_header_v10_t) || memcmp(data, PRISM_MAGIC, 4) != 0) {
+        return;
+    }
+    prism_header_v11_t hdr;
+    if (parse_prism_header(data, len, &hdr) != ESP_OK) {
+        return;
+    }
+    e->is_prism = true;
+    e->crc_verified = (calculate_header_crc(&hdr) == hdr.base.crc32);
+    e->version = hdr.base.version;
+    e->led_count = hdr.base.led_count;
+    e->frame_count = hdr.base.frame_count;
+    e->fps = hdr.base.fps;
+    e->color_format = hdr.base.color_format;
+    e->compression = hdr.base.compression;
+    e->meta = hdr.meta;
+}
+
+// Caller holds the lock
+static esp_err_t put_locked(const pattern_index_entry_t *entry) {
+    bool found = false;
+    size_t pos = find_slot(entry->id, &found);
+    if (!found) {
+        if (s_count >= PATTERN_INDEX_CAPACITY) {
+            return ESP_ERR_NO_MEM;
+        }
+        memmove(&s_entries[pos + 1], &s_entries[pos], (s_count - pos) * sizeof(s_entries[0]));
+        s_count++;
+    }
+    s_entries[pos] = *entry;
+    return ESP_OK;
+}
+
+static bool make_entry(pattern_index_entry_t *e, const char *id, size_t id_len) {
+    if (id_len == 0 || id_len >= PATTERN_INDEX_ID_MAX) {
+        return false;
+    }
+    memset(e, 0, sizeof(*e));
+    memcpy(e->id, id, id_len);
+    e->id[id_len] = '\0';
+    return true;
+}
+
+esp_err_t pattern_index_build(const char *dir_path) {
+    if (!dir_path) return ESP_ERR_INVALID_ARG;
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) return ESP_ERR_NO_MEM;
+    }
+
+    lock();
+    s_count = 0;
+    DIR *dir = opendir(dir_path);
+    if (!dir) {
+        unlock();
+        ESP_LOGI(TAG, "No pattern directory yet: index empty");
+        return ESP_OK;
+    }
+
+    _Static_assert(PATTERN_INDEX_HEAD_SIZE == sizeof(prism_header_v11_t), "head size");
+    uint8_t head[PATTERN_INDEX_HEAD_SIZE];
+    char path[PATTERN_INDEX_ID_MAX + 64];
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        const char *dot = strrchr(ent->d_name, '.');
+        if (dot && strcmp(dot, ".tmp") == 0) {
+            // A write that never reached its rename: nothing refers to it
+            snprintf(path, sizeof(path), "%s/%s", dir_path, ent->d_name);
+            ESP_LOGW(TAG, "Removing stale %s", ent->d_name);
+            remove(path);
+            continue;
+        }
+        if (!dot || strcmp(dot, ".bin") != 0) {
+            continue;
+        }
+        pattern_index_entry_t e;
+        if (!make_entry(&e, ent->d_name, (size_t)(dot - ent->d_name))) {
+            ESP_LOGW(TAG, "Skipping %s: ID too long", ent->d_name);
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s", dir_path, ent->d_name);
+        struct stat st;
+        if (stat(path, &st) != 0) {
+            continue;
+        }
+        e.size = (uint32_t)st.st_size;
+        e.mtime = (uint32_t)st.st_mtime;
+
+        FILE *f = fopen(path, "rb");
+        if (f) {
+            size_t n = fread(head, 1, sizeof(head), f);
+            fclose(f);
+            fill_header(&e, head, n);
+        }
+
+        if (put_locked(&e) != ESP_OK) {
+            ESP_LOGW(TAG, "Index full (%d): %s not indexed", PATTERN_INDEX_CAPACITY, e.id);
+        }
+    }
+    closedir(dir);
+    size_t count = s_count;
+    unlock();
+
+    ESP_LOGI(TAG, "Indexed %zu patterns", count);
+    return ESP_OK;
+}
+
+void pattern_index_clear(void) {
+    lock();
+    s_count = 0;
+    unlock();
+}
+
+esp_err_t pattern_index_put(const char *id, const uint8_t *head, size_t head_len,
+                            uint32_t size, uint32_t mtime) {
+    if (!id || (!head && head_len > 0)) return ESP_ERR_INVALID_ARG;
+    pattern_index_entry_t e;
+    if (!make_entry(&e, id, strlen(id))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    e.size = size;
+    e.mtime = mtime;
+    fill_header(&e, head, head_len);
+
+    lock();
+    esp_err_t ret = put_locked(&e);
+    unlock();
+    return ret;
+}
+
+void pattern_index_remove(const char *id) {
+    if (!id) return;
+    lock();
+    bool found = false;
+    size_t pos = find_slot(id, &found);
+    if (found) {
+        memmove(&s_entries[pos], &s_entries[pos + 1], (s_count - pos - 1) * sizeof(s_entries[0]));
+        s_count--;
+    }
+    unlock();
+}
+
+void pattern_index_mark_verified(const char *id) {
+    if (!id) return;
+    lock();
+    bool found = false;
+    size_t pos = find_slot(id, &found);
+    if (found) {
+        s_entries[pos].crc_verified = true;
+    }
+    unlock();
+}
+
+size_t pattern_index_count(void) {
+    lock();
+    size_t count = s_count;
+    unlock();
+    return count;
+}
+
+bool pattern_index_get(const char *id, pattern_index_entry_t *out) {
+    if (!id || !out) return false;
+    lock();
+    bool found = false;
+    size_t pos = find_slot(id, &found);
+    if (found) {
+        *out = s_entries[pos];
+    }
+    unlock();
+    return found;
+}
+
+size_t pattern_index_page(size_t start, pattern_index_entry_t *out, size_t max) {
+    if (!out) return 0;
+    lock();
+    size_t n = 0;
+    if (start < s_count) {
+        n = s_count - start;
+        if (n > max) n = max;
+        memcpy(out, &s_entries[start], n * sizeof(s_entries[0]));
+    }
+    unlock();
+    return n;
+}
@@ -9,6 +9,7 @@
 #include "pattern_storage.h"
 #include "esp_littlefs.h"
 #include "pattern_cache.h"
+#include "pattern_index.h"
 #include "esp_log.h"
 #include "esp_partition.h"
 
@@ -85,6 +86,12 @@ esp_err_t storage_init(void) {
         ESP_LOGW(TAG, "Could not get filesystem info: %s", esp_err_to_name(ret));
     }
 
+    // One directory scan per boot; CRUD keeps the index current after this
+    ret = pattern_index_build(STORAGE_PATTERN_DIR);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Pattern index build failed: %s", esp_err_to_name(ret));
+    }
+
     storage_initialized = true;
     ESP_LOGI(TAG, "Storage subsystem initialized successfully");
 
@@ -92,6 +99,9 @@ esp_err_t storage_init(void) {
     esp_err_t crec = pattern_cache_init(PATTERN_CACHE_DEFAULT_CAPACITY);
     if (crec != ESP_OK) {
         ESP_LOGW(TAG, "Pattern cache init failed: %s", esp_err_to_name(crec));
+    } else {
+        (void)pattern_cache_set_quota(PATTERN_CACHE_CLASS_TEMPLATE, PATTERN_CACHE_TEMPLATE_QUOTA);
+        (void)pattern_cache_set_quota(PATTERN_CACHE_CLASS_USER, PATTERN_CACHE_USER_QUOTA);
     }
     return ESP_OK;
 }
@@ -125,8 +135,9 @@ esp_err_t storage_deinit(void) {
     storage_initialized = false;
     ESP_LOGI(TAG, "Storage subsystem deinitialized");
 
-    // Deinitialize cache
+    // Deinitialize cache and index
     pattern_cache_deinit();
+    pattern_index_clear();
     return ESP_OK;
 }
 
@@ -8,6 +8,7 @@
 
 #include "pattern_storage.h"
 #include "pattern_cache.h"
+#include "pattern_index.h"
 #include "esp_log.h"
 #include "prism_parser.h"
 
@@ -17,82 +18,332 @@
 #include <sys/stat.h>
 #include <dirent.h>
 #include <string.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
 
 static const char *TAG = "storage_crud";
 
 // Storage directories
-#define PATTERN_DIR     "/littlefs/patterns"
+#define PATTERN_DIR     STORAGE_PATTERN_DIR
 #define TEMPLATE_DIR    "/littlefs/templates"
 #define MAX_FILENAME    64
 #define TEMP_SUFFIX     ".tmp"
+// "<dir>/<id>.tmp" for the longest ID the index accepts (sizeof counts the NUL)
+#define PATTERN_PATH_MAX (sizeof(PATTERN_DIR "/" TEMP_SUFFIX) + PATTERN_INDEX_ID_MAX - 1)
 
 /**
  * @brief Helper: Build pattern file path
  * @param pattern_id Pattern identifier
  * @param path Output path buffer
  * @param len Buffer length
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if the path would be truncated
  */
-static void build_pattern_path(const char *pattern_id, char *path, size_t len) {
-    snprintf(path, len, "%s/%s.bin", PATTERN_DIR, pattern_id);
+static esp_err_t build_pattern_path(const char *pattern_id, char *path, size_t len) {
+    int n = snprintf(path, len, "%s/%s.bin", PATTERN_DIR, pattern_id);
+    return (n > 0 && (size_t)n < len) ? ESP_OK : ESP_ERR_INVALID_ARG;
 }
 
-esp_err_t storage_pattern_create(const char *pattern_id, const uint8_t *data, size_t len) {
-    if (!pattern_id || !data || len == 0) {
-        ESP_LOGE(TAG, "Invalid arguments: pattern_id=%p, data=%p, len=%zu",
-                 (void*)pattern_id, (void*)data, len);
+/**
+ * @brief Helper: Build temporary pattern file path
+ *
+ * Same length as the .bin name, so any ID that fits LittleFS's name limit
+ * as a pattern also fits while it is being written. A truncated name could
+ * collide with the live .bin file, so it is an error rather than clipped.
+ */
+static esp_err_t build_pattern_temp_path(const char *pattern_id, char *path, size_t len) {
+    int n = snprintf(path, len, "%s/%s%s", PATTERN_DIR, pattern_id, TEMP_SUFFIX);
+    return (n > 0 && (size_t)n < len) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+/**
+ * @brief Helper: Ensure the patterns directory exists
+ */
+static esp_err_t ensure_pattern_dir(void) {
+    struct stat st;
+    if (stat(PATTERN_DIR, &st) == 0) {
+        return ESP_OK;
+    }
+    ESP_LOGI(TAG, "Creating patterns directory: %s", PATTERN_DIR);
+    if (mkdir(PATTERN_DIR, 0755) != 0) {
+        ESP_LOGE(TAG, "Failed to create patterns directory");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t storage_pattern_write_begin(storage_pattern_writer_t *w, const char *pattern_id, size_t size,
+                                      uint8_t *stage, size_t stage_size) {
+    if (!w || !pattern_id || size == 0 || (stage && stage_size == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t id_len = strlen(pattern_id);
+    if (id_len == 0 || id_len >= PATTERN_INDEX_ID_MAX) {
+        ESP_LOGE(TAG, "Invalid pattern id length: %zu", id_len);
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Enforce pattern size limit (ADR-006: 100KB)
-    if (len > PATTERN_SIZE_MAX) {
-        ESP_LOGE(TAG, "Pattern too large: %zu bytes (max %d)", len, PATTERN_SIZE_MAX);
+    // Enforce pattern size limit (ADR-006)
+    if (size > PATTERN_SIZE_MAX) {
+        ESP_LOGE(TAG, "Pattern too large: %zu bytes (max %d)", size, PATTERN_SIZE_MAX);
         return ESP_ERR_INVALID_SIZE;
     }
 
-    // Ensure patterns directory exists
-    struct stat st;
-    if (stat(PATTERN_DIR, &st) != 0) {
-        ESP_LOGI(TAG, "Creating patterns directory: %s", PATTERN_DIR);
-        if (mkdir(PATTERN_DIR, 0755) != 0) {
-            ESP_LOGE(TAG, "Failed to create patterns directory");
-            return ESP_ERR_NO_MEM;
-        }
+    esp_err_t ret = ensure_pattern_dir();
+    if (ret != ESP_OK) {
+        return ret;
     }
 
-    // Check storage bounds (ADR-006: 15-25 patterns)
-    size_t count = 0;
-    storage_pattern_count(&count);
-    if (count >= PATTERN_IDEAL_COUNT) {
+    // Check storage bounds (ADR-006: 15-25 patterns); replacing doesn't add one
+    pattern_index_entry_t existing;
+    size_t count = pattern_index_count();
+    if (count >= PATTERN_IDEAL_COUNT && !pattern_index_get(pattern_id, &existing)) {
         ESP_LOGW(TAG, "Pattern storage full (%zu/%d patterns)", count, PATTERN_IDEAL_COUNT);
         return ESP_ERR_NO_MEM;
     }
 
-    // Build file path
-    char path[MAX_FILENAME];
-    build_pattern_path(pattern_id, path, sizeof(path));
+    // The old file stays until the rename, so the new one needs its own room
+    size_t total = 0, used = 0;
+    if (storage_get_space(&total, &used) == ESP_OK && total >= used && total - used < size) {
+        ESP_LOGW(TAG, "Not enough space for %s: need %zu, free %zu", pattern_id, size, total - used);
+        return ESP_ERR_NO_MEM;
+    }
 
-    // Write pattern to file
-    FILE *f = fopen(path, "wb");
+    char path[PATTERN_PATH_MAX];
+    if (build_pattern_temp_path(pattern_id, path, sizeof(path)) != ESP_OK) {
+        ESP_LOGE(TAG, "Pattern id too long for a path: %s", pattern_id);
+        return ESP_ERR_INVALID_ARG;
+    }
+    FILE *f = fopen(path, "w+b");
     if (!f) {
-        ESP_LOGE(TAG, "Failed to create pattern file: %s", path);
+        ESP_LOGE(TAG, "Failed to create temp file: %s", path);
         return ESP_ERR_NO_MEM;
     }
+    if (stage) {
+        setvbuf(f, (char *)stage, _IOFBF, stage_size);
+    }
 
-    size_t written = fwrite(data, 1, len, f);
-    fclose(f);
+    memset(w, 0, sizeof(*w));
+    w->file = f;
+    w->pos = 0;
+    memcpy(w->id, pattern_id, id_len + 1);
+    w->expected_size = size;
+    return ESP_OK;
+}
 
-    if (written != len) {
-        ESP_LOGE(TAG, "Failed to write pattern data: wrote %zu/%zu bytes", written, len);
-        remove(path);  // Clean up partial write
+esp_err_t storage_pattern_write_at(storage_pattern_writer_t *w, size_t offset,
+                                   const uint8_t *data, size_t len) {
+    if (!w || !w->file) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (len == 0) {
+        return ESP_OK;
+    }
+    if (!data) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset > w->expected_size || len > w->expected_size - offset) {
+        ESP_LOGE(TAG, "Write past announced size: %zu + %zu > %zu", offset, len, w->expected_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if (offset < sizeof(w->head)) {
+        size_t n = sizeof(w->head) - offset;
+        if (n > len) n = len;
+        memcpy(&w->head[offset], data, n);
+    }
+
+    if (offset != w->pos && fseek(w->file, (long)offset, SEEK_SET) != 0) {
+        ESP_LOGE(TAG, "Failed to seek pattern file to %zu", offset);
+        w->pos = SIZE_MAX;
+        return ESP_FAIL;
+    }
+    if (fwrite(data, 1, len, w->file) != len) {
+        ESP_LOGE(TAG, "Failed to write pattern data at %zu (%zu bytes)", offset, len);
+        w->pos = SIZE_MAX;
+        return ESP_FAIL;
+    }
+    w->pos = offset + len;
+    if (w->pos > w->written) {
+        w->written = w->pos;
+    }
+    return ESP_OK;
+}
+
+esp_err_t storage_pattern_write_append(storage_pattern_writer_t *w, const uint8_t *data, size_t len) {
+    if (!w || !w->file) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return storage_pattern_write_at(w, w->written, data, len);
+}
+
+esp_err_t storage_pattern_write_read_back(storage_pattern_writer_t *w, size_t offset,
+                                          uint8_t *out, size_t len) {
+    if (!w || !w->file) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!out || offset > w->written || len > w->written - offset) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    // stdio needs a seek between a write and a read in either direction
+    w->pos = SIZE_MAX;
+    if (fseek(w->file, (long)offset, SEEK_SET) != 0 || fread(out, 1, len, w->file) != len) {
+        ESP_LOGE(TAG, "Failed to read back pattern data at %zu (%zu bytes)", offset, len);
         return ESP_FAIL;
     }
+    return ESP_OK;
+}
+
+void storage_pattern_write_abort(storage_pattern_writer_t *w) {
+    if (!w || !w->file) {
+        return;
+    }
+    fclose(w->file);
+    w->file = NULL;
+
+    char path[PATTERN_PATH_MAX];
+    if (build_pattern_temp_path(w->id, path, sizeof(path)) == ESP_OK) {
+        remove(path);
+    }
+}
+
+esp_err_t storage_pattern_write_commit(storage_pattern_writer_t *w) {
+    if (!w || !w->file) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (w->written != w->expected_size) {
+        ESP_LOGE(TAG, "Incomplete pattern write: %zu/%zu bytes", w->written, w->expected_size);
+        storage_pattern_write_abort(w);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // Flush the staging buffer and sync before the rename makes it visible
+    if (fflush(w->file) != 0) {
+        ESP_LOGE(TAG, "Failed to flush pattern: %s", w->id);
+        storage_pattern_write_abort(w);
+        return ESP_FAIL;
+    }
+    int fd = fileno(w->file);
+    if (fd >= 0) {
+        fsync(fd);
+    }
+    fclose(w->file);
+    w->file = NULL;
+
+    // write_begin already checked that both paths fit
+    char temp_path[PATTERN_PATH_MAX];
+    char path[PATTERN_PATH_MAX];
+    (void)build_pattern_temp_path(w->id, temp_path, sizeof(temp_path));
+    (void)build_pattern_path(w->id, path, sizeof(path));
+    if (rename(temp_path, path) != 0) {
+        ESP_LOGE(TAG, "Failed to rename temp file to final: %s -> %s", temp_path, path);
+        remove(temp_path);
+        return ESP_FAIL;
+    }
+
+    // Old bytes may still be cached under this ID
+    pattern_cache_invalidate(w->id);
+
+    uint32_t mtime = 0;
+    struct stat st;
+    if (stat(path, &st) == 0) {
+        mtime = (uint32_t)st.st_mtime;
+    }
+    size_t head_len = w->written < sizeof(w->head) ? w->written : sizeof(w->head);
+    if (pattern_index_put(w->id, w->head, head_len, (uint32_t)w->written, mtime) != ESP_OK) {
+        ESP_LOGW(TAG, "Pattern %s not indexed", w->id);
+    }
+
+    ESP_LOGI(TAG, "Pattern written atomically: %s (%zu bytes)", w->id, w->written);
+    return ESP_OK;
+}
+
+esp_err_t storage_pattern_create(const char *pattern_id, const uint8_t *data, size_t len) {
+    if (!pattern_id || !data || len == 0) {
+        ESP_LOGE(TAG, "Invalid arguments: pattern_id=%p, data=%p, len=%zu",
+                 (void*)pattern_id, (void*)data, len);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    storage_pattern_writer_t w;
+    esp_err_t ret = storage_pattern_write_begin(&w, pattern_id, len, NULL, 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = storage_pattern_write_append(&w, data, len);
+    if (ret != ESP_OK) {
+        storage_pattern_write_abort(&w);
+        return ret;
+    }
+    ret = storage_pattern_write_commit(&w);
+    if (ret != ESP_OK) {
+        return ret;
+    }
 
     ESP_LOGI(TAG, "Pattern created: %s (%zu bytes)", pattern_id, len);
 
     // Warm cache with newly created pattern (best-effort)
-    (void)pattern_cache_put_copy(pattern_id, data, len);
+    (void)pattern_cache_put_copy(pattern_id, PATTERN_CACHE_CLASS_USER, data, len);
+    return ESP_OK;
+}
+
+/**
+ * @brief Helper: Verify the header CRC if data looks like a .prism file
+ * @param data Pattern bytes
+ * @param len Length of data
+ * @return ESP_OK if valid or not a .prism file, error otherwise
+ */
+static esp_err_t verify_prism_header(const uint8_t *data, size_t len) {
+    if (len < sizeof(prism_header_v10_t)) {
+        return ESP_OK;
+    }
+    const prism_header_v10_t *hdr10 = (const prism_header_v10_t *)data;
+    if (memcmp(hdr10->magic, PRISM_MAGIC, 4) != 0) {
+        return ESP_OK;
+    }
+    prism_header_v11_t parsed;
+    esp_err_t perr = parse_prism_header(data, len, &parsed);
+    if (perr == ESP_OK) {
+        uint32_t calc = calculate_header_crc(&parsed);
+        if (calc != parsed.base.crc32) {
+            ESP_LOGE(TAG, "Header CRC mismatch: calc=0x%08lX stored=0x%08lX",
+                     (unsigned long)calc, (unsigned long)parsed.base.crc32);
+            return ESP_ERR_INVALID_CRC;
+        }
+    } else {
+        #if PRISM_STRICT_PRISM_VALIDATION
+        ESP_LOGE(TAG, ".prism header parse failed (%s)", esp_err_to_name(perr));
+        return perr;
+        #else
+        ESP_LOGW(TAG, ".prism header parse failed (%s), continuing without CRC validation",
+                 esp_err_to_name(perr));
+        #endif
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Helper: Size of a stored pattern, from the index when it is there
+ * @param pattern_id Pattern identifier
+ * @param path Pattern file path (stat fallback)
+ * @param out_size File size
+ * @param out_verified True if the header CRC was already verified
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND
+ */
+static esp_err_t pattern_size(const char *pattern_id, const char *path,
+                              size_t *out_size, bool *out_verified) {
+    pattern_index_entry_t entry;
+    if (pattern_index_get(pattern_id, &entry)) {
+        *out_size = entry.size;
+        *out_verified = entry.crc_verified;
+        return ESP_OK;
+    }
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *out_size = (size_t)st.st_size;
+    *out_verified = false;
     return ESP_OK;
 }
 
@@ -103,33 +354,39 @@ esp_err_t storage_pattern_read(const char *pattern_id, uint8_t *buffer, size_t b
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Fast path: try RAM cache
+    // Fast path: try RAM cache, pinned so eviction cannot reuse it mid-copy
+    pattern_cache_handle_t handle = NULL;
     const uint8_t* cptr = NULL;
     size_t csize = 0;
-    if (pattern_cache_try_get(pattern_id, &cptr, &csize)) {
+    if (pattern_cache_acquire(pattern_id, PATTERN_CACHE_CLASS_USER, &handle, &cptr, &csize) == ESP_OK) {
         if (csize > buffer_size) {
+            pattern_cache_release(handle);
             ESP_LOGE(TAG, "Buffer too small for cached pattern: need %zu, have %zu", csize, buffer_size);
             return ESP_ERR_INVALID_SIZE;
         }
         memcpy(buffer, cptr, csize);
+        pattern_cache_release(handle);
         *out_size = csize;
         ESP_LOGD(TAG, "Cache hit: %s (%zu bytes)", pattern_id, csize);
         return ESP_OK;
     }
 
-    char path[MAX_FILENAME];
-    build_pattern_path(pattern_id, path, sizeof(path));
+    char path[PATTERN_PATH_MAX];
+    if (build_pattern_path(pattern_id, path, sizeof(path)) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
 
     // Check if file exists and get size
-    struct stat st;
-    if (stat(path, &st) != 0) {
+    size_t size = 0;
+    bool verified = false;
+    if (pattern_size(pattern_id, path, &size, &verified) != ESP_OK) {
         ESP_LOGW(TAG, "Pattern not found: %s", pattern_id);
         return ESP_ERR_NOT_FOUND;
     }
 
     // Validate buffer size
-    if ((size_t)st.st_size > buffer_size) {
-        ESP_LOGE(TAG, "Buffer too small: need %ld bytes, have %zu", st.st_size, buffer_size);
+    if (size > buffer_size) {
+        ESP_LOGE(TAG, "Buffer too small: need %zu bytes, have %zu", size, buffer_size);
         return ESP_ERR_INVALID_SIZE;
     }
 
@@ -143,42 +400,109 @@ esp_err_t storage_pattern_read(const char *pattern_id, uint8_t *buffer, size_t b
     size_t bytes_read = fread(buffer, 1, buffer_size, f);
     fclose(f);
 
-    if (bytes_read != (size_t)st.st_size) {
-        ESP_LOGE(TAG, "Failed to read complete pattern: read %zu/%ld bytes",
-                 bytes_read, st.st_size);
+    if (bytes_read != size) {
+        ESP_LOGE(TAG, "Failed to read complete pattern: read %zu/%zu bytes",
+                 bytes_read, size);
         return ESP_FAIL;
     }
-    // If this appears to be a .prism file, verify header CRC
-    if (bytes_read >= sizeof(prism_header_v10_t)) {
-        const uint8_t *data = buffer;
-        const prism_header_v10_t *hdr10 = (const prism_header_v10_t *)data;
-        if (memcmp(hdr10->magic, PRISM_MAGIC, 4) == 0) {
-            prism_header_v11_t parsed;
-            esp_err_t perr = parse_prism_header(data, bytes_read, &parsed);
-            if (perr == ESP_OK) {
-                uint32_t calc = calculate_header_crc(&parsed);
-                if (calc != parsed.base.crc32) {
-                    ESP_LOGE(TAG, "Header CRC mismatch: calc=0x%08lX stored=0x%08lX",
-                             (unsigned long)calc, (unsigned long)parsed.base.crc32);
-                    return ESP_ERR_INVALID_CRC;
-                }
-            } else {
-                #if PRISM_STRICT_PRISM_VALIDATION
-                ESP_LOGE(TAG, ".prism header parse failed (%s)", esp_err_to_name(perr));
-                return perr;
-                #else
-                ESP_LOGW(TAG, ".prism header parse failed (%s), continuing without CRC validation",
-                         esp_err_to_name(perr));
-                #endif
-            }
+    // If this appears to be a .prism file, verify header CRC (once)
+    if (!verified) {
+        esp_err_t verr = verify_prism_header(buffer, bytes_read);
+        if (verr != ESP_OK) {
+            return verr;
         }
+        pattern_index_mark_verified(pattern_id);
     }
 
     *out_size = bytes_read;
     ESP_LOGI(TAG, "Pattern read: %s (%zu bytes)", pattern_id, bytes_read);
 
     // Insert into cache (best-effort)
-    (void)pattern_cache_put_copy(pattern_id, buffer, bytes_read);
+    (void)pattern_cache_put_copy(pattern_id, PATTERN_CACHE_CLASS_USER, buffer, bytes_read);
+    return ESP_OK;
+}
+
+esp_err_t storage_pattern_acquire(const char *pattern_id, pattern_cache_handle_t *out_handle,
+                                  const uint8_t **out_data, size_t *out_size) {
+    if (!pattern_id || !out_handle || !out_data || !out_size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Fast path: pin the cached blob in place
+    if (pattern_cache_acquire(pattern_id, PATTERN_CACHE_CLASS_USER, out_handle, out_data, out_size) == ESP_OK) {
+        ESP_LOGD(TAG, "Cache hit (pinned): %s (%zu bytes)", pattern_id, *out_size);
+        return ESP_OK;
+    }
+
+    char path[PATTERN_PATH_MAX];
+    if (build_pattern_path(pattern_id, path, sizeof(path)) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    size_t size = 0;
+    bool verified = false;
+    if (pattern_size(pattern_id, path, &size, &verified) != ESP_OK) {
+        ESP_LOGW(TAG, "Pattern not found: %s", pattern_id);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (size == 0 || size > PATTERN_SIZE_MAX) {
+        ESP_LOGE(TAG, "Invalid pattern size: %zu bytes", size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // Read straight into cache memory; fall back to a heap buffer the handle
+    // owns when pinned entries hold the room
+    pattern_cache_handle_t handle = NULL;
+    uint8_t *buf = NULL;
+    bool reserved = (pattern_cache_reserve(pattern_id, PATTERN_CACHE_CLASS_USER, size, &handle, &buf) == ESP_OK);
+    if (!reserved) {
+        buf = (uint8_t *)malloc(size);
+        if (!buf) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    esp_err_t ret = ESP_OK;
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        ESP_LOGE(TAG, "Failed to open pattern: %s", path);
+        ret = ESP_ERR_NOT_FOUND;
+    } else {
+        size_t bytes_read = fread(buf, 1, size, f);
+        fclose(f);
+        if (bytes_read != size) {
+            ESP_LOGE(TAG, "Failed to read complete pattern: read %zu/%zu bytes", bytes_read, size);
+            ret = ESP_FAIL;
+        }
+    }
+    if (ret == ESP_OK && !verified) {
+        ret = verify_prism_header(buf, size);
+        if (ret == ESP_OK) {
+            pattern_index_mark_verified(pattern_id);
+        }
+    }
+
+    if (reserved) {
+        if (ret == ESP_OK) {
+            ret = pattern_cache_commit(handle, size);
+        }
+        if (ret != ESP_OK) {
+            pattern_cache_release(handle);
+            return ret;
+        }
+    } else {
+        if (ret != ESP_OK) {
+            free(buf);
+            return ret;
+        }
+        ret = pattern_cache_put_take(pattern_id, PATTERN_CACHE_CLASS_USER, buf, size, &handle);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    *out_handle = handle;
+    *out_data = pattern_cache_handle_data(handle, out_size);
+    ESP_LOGI(TAG, "Pattern read (pinned): %s (%zu bytes)", pattern_id, size);
     return ESP_OK;
 }
 
@@ -188,8 +512,11 @@ esp_err_t storage_pattern_delete(const char *pattern_id) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    char path[MAX_FILENAME];
-    build_pattern_path(pattern_id, path, sizeof(path));
+    char path[PATTERN_PATH_MAX];
+    if (build_pattern_path(pattern_id, path, sizeof(path)) != ESP_OK) {
+        ESP_LOGW(TAG, "Pattern not found for delete: %s", pattern_id);
+        return ESP_ERR_NOT_FOUND;
+    }
 
     // Check if file exists before attempting delete
     struct stat st;
@@ -204,8 +531,9 @@ esp_err_t storage_pattern_delete(const char *pattern_id) {
         return ESP_FAIL;
     }
 
-    // Invalidate RAM cache entry
+    // Invalidate RAM cache and index entries
     pattern_cache_invalidate(pattern_id);
+    pattern_index_remove(pattern_id);
 
     ESP_LOGI(TAG, "Pattern deleted: %s", pattern_id);
     return ESP_OK;
@@ -218,72 +546,39 @@ esp_err_t storage_pattern_list(char **pattern_list, size_t max_count, size_t *ou
         return ESP_ERR_INVALID_ARG;
     }
 
-    *out_count = 0;  // Initialize output
-
-    DIR *dir = opendir(PATTERN_DIR);
-    if (!dir) {
-        ESP_LOGW(TAG, "Patterns directory not found: %s", PATTERN_DIR);
-        return ESP_OK;  // Empty list is valid
-    }
-
+    // Served from the index: IDs come back in sorted order
+    pattern_index_entry_t entry;
     size_t count = 0;
-    struct dirent *entry;
-
-    while ((entry = readdir(dir)) != NULL && count < max_count) {
-        // Skip . and ..
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
-        }
-
-        // Extract pattern ID (remove .bin extension)
-        char *dot = strrchr(entry->d_name, '.');
-        if (dot && strcmp(dot, ".bin") == 0) {
-            size_t id_len = dot - entry->d_name;
-            if (id_len > 0 && id_len < MAX_FILENAME) {
-                strncpy(pattern_list[count], entry->d_name, id_len);
-                pattern_list[count][id_len] = '\0';
-                count++;
-            }
-        }
+    while (count < max_count && pattern_index_page(count, &entry, 1) == 1) {
+        strlcpy(pattern_list[count], entry.id, MAX_FILENAME);
+        count++;
     }
-
-    closedir(dir);
     *out_count = count;
 
     ESP_LOGI(TAG, "Pattern list: %zu patterns found", count);
     return ESP_OK;
 }
 
-esp_err_t storage_pattern_count(size_t *out_count) {
-    if (!out_count) {
-        ESP_LOGE(TAG, "Invalid argument: out_count is NULL");
+esp_err_t storage_pattern_list_entries(size_t start, pattern_index_entry_t *entries, size_t max_count,
+                                       size_t *out_count, size_t *out_total) {
+    if (!entries || !out_count) {
         return ESP_ERR_INVALID_ARG;
     }
-
-    *out_count = 0;  // Initialize output
-
-    DIR *dir = opendir(PATTERN_DIR);
-    if (!dir) {
-        // Directory doesn't exist yet - return 0 count
-        return ESP_OK;
+    *out_count = pattern_index_page(start, entries, max_count);
+    if (out_total) {
+        *out_total = pattern_index_count();
     }
+    return ESP_OK;
+}
 
-    size_t count = 0;
-    struct dirent *entry;
-
-    while ((entry = readdir(dir)) != NULL) {
-        // Skip . and ..
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
-        }
-        // Count all files (assume they're all patterns)
-        count++;
+esp_err_t storage_pattern_count(size_t *out_count) {
+    if (!out_count) {
+        ESP_LOGE(TAG, "Invalid argument: out_count is NULL");
+        return ESP_ERR_INVALID_ARG;
     }
 
-    closedir(dir);
-    *out_count = count;
-
-    ESP_LOGD(TAG, "Pattern count: %zu", count);
+    *out_count = pattern_index_count();
+    ESP_LOGD(TAG, "Pattern count: %zu", *out_count);
     return ESP_OK;
 }
 
@@ -142,6 +142,17 @@ int cmd_prism_template_cache_stats(int argc, char **argv)
     pattern_cache_stats(&hits, &misses, &used, &entries);
     printf("cache: entries=%zu used_bytes=%zu hits=%lu misses=%lu\n",
            entries, used, (unsigned long)hits, (unsigned long)misses);
+    static const char* const class_names[PATTERN_CACHE_CLASS_COUNT] = { "user", "template" };
+    for (int c = 0; c < PATTERN_CACHE_CLASS_COUNT; ++c) {
+        pattern_cache_class_stats_t cs;
+        pattern_cache_class_stats((pattern_cache_class_t)c, &cs);
+        uint32_t lookups = cs.hits + cs.misses;
+        printf("  %-8s entries=%zu used=%zu/%zu hits=%lu misses=%lu hit_ratio=%.1f%% cost=%luus/KB\n",
+               class_names[c], cs.entry_count, cs.held_bytes, cs.quota_bytes,
+               (unsigned long)cs.hits, (unsigned long)cs.misses,
+               lookups ? 100.0f * (float)cs.hits / (float)lookups : 0.0f,
+               (unsigned long)cs.cost_us_per_kb);
+    }
     return 0;
 }
 
@@ -192,23 +203,29 @@ esp_err_t templates_init(void) {
     size_t cached = 0;
     for (size_t i = 0; i < catalog_count; ++i) {
         const char* id = catalog[i].id;
-        const uint8_t* cptr = NULL; size_t csz = 0;
-        if (pattern_cache_try_get(id, &cptr, &csz)) {
+        if (pattern_cache_contains(id, PATTERN_CACHE_CLASS_TEMPLATE)) {
             continue; // already cached
         }
-        // Read from storage and cache copy
-        uint8_t* buf = (uint8_t*)malloc(catalog[i].size);
-        if (!buf) {
-            ESP_LOGW(TAG, "Cache skip (OOM): %s", id);
+        // Stop short of the template quota rather than evict earlier preloads
+        pattern_cache_class_stats_t cs;
+        pattern_cache_class_stats(PATTERN_CACHE_CLASS_TEMPLATE, &cs);
+        if (cs.held_bytes + catalog[i].size > cs.quota_bytes) {
+            ESP_LOGD(TAG, "Cache skip (quota): %s", id);
+            continue;
+        }
+        // Read from storage straight into cache memory; drop the pin right away
+        pattern_cache_handle_t handle = NULL;
+        uint8_t* buf = NULL;
+        if (pattern_cache_reserve(id, PATTERN_CACHE_CLASS_TEMPLATE, catalog[i].size, &handle, &buf) != ESP_OK) {
+            ESP_LOGW(TAG, "Cache skip (no room): %s", id);
             continue;
         }
         size_t read_sz = 0;
         esp_err_t r = template_storage_read(id, buf, catalog[i].size, &read_sz);
-        if (r == ESP_OK) {
-            (void)pattern_cache_put_copy(id, buf, read_sz);
+        if (r == ESP_OK && read_sz > 0 && pattern_cache_commit(handle, read_sz) == ESP_OK) {
             cached++;
         }
-        free(buf);
+        pattern_cache_release(handle);
     }
 
     // Cache stats after preload
@@ -291,9 +308,13 @@ esp_err_t templates_deploy(const char* template_id)
 
     uint32_t start_ms = (xTaskGetTickCount() * portTICK_PERIOD_MS);
 
+    // Cache hit: pin the entry and play it in place (no copy); playback drops
+    // the pin when the pattern is replaced or stopped.
+    pattern_cache_handle_t handle = NULL;
     const uint8_t* cptr = NULL; size_t csz = 0;
-    if (pattern_cache_try_get(template_id, &cptr, &csz)) {
-        esp_err_t ret = playback_play_prism_blob(template_id, cptr, csz);
+    if (pattern_cache_acquire(template_id, PATTERN_CACHE_CLASS_TEMPLATE, &handle, &cptr, &csz) == ESP_OK) {
+        esp_err_t ret = playback_play_prism_borrowed(template_id, cptr, csz,
+                                                     playback_release_cache_handle, handle);
         uint32_t dt = (xTaskGetTickCount() * portTICK_PERIOD_MS) - start_ms;
         ESP_LOGI(TAG, "Deploy(template:%s) cache-hit size=%zu in %lu ms -> %s",
                  template_id, csz, (unsigned long)dt, esp_err_to_name(ret));
@@ -309,17 +330,40 @@ esp_err_t templates_deploy(const char* template_id)
         // Unknown template id
         return ESP_ERR_NOT_FOUND;
     }
-    uint8_t* buf = (uint8_t*)malloc(max_sz);
-    if (!buf) return ESP_ERR_NO_MEM;
+    // Read into reserved cache memory (or a heap buffer if pinned entries
+    // hold the room); the entry stays pinned while playing
+    uint8_t* buf = NULL;
+    bool reserved = (pattern_cache_reserve(template_id, PATTERN_CACHE_CLASS_TEMPLATE, max_sz, &handle, &buf) == ESP_OK);
+    if (!reserved) {
+        buf = (uint8_t*)malloc(max_sz);
+        if (!buf) return ESP_ERR_NO_MEM;
+    }
     size_t read_sz = 0;
     esp_err_t r = template_storage_read(template_id, buf, max_sz, &read_sz);
-    if (r != ESP_OK) {
-        free(buf);
-        return r;
+    if (r == ESP_OK && read_sz == 0) {
+        r = ESP_ERR_INVALID_SIZE;
+    }
+    if (reserved) {
+        if (r == ESP_OK) {
+            r = pattern_cache_commit(handle, read_sz);
+        }
+        if (r != ESP_OK) {
+            pattern_cache_release(handle);
+            return r;
+        }
+    } else {
+        if (r != ESP_OK) {
+            free(buf);
+            return r;
+        }
+        r = pattern_cache_put_take(template_id, PATTERN_CACHE_CLASS_TEMPLATE, buf, read_sz, &handle);
+        if (r != ESP_OK) {
+            return r;
+        }
     }
-    (void)pattern_cache_put_copy(template_id, buf, read_sz);
-    esp_err_t ret = playback_play_prism_blob(template_id, buf, read_sz);
-    free(buf);
+    cptr = pattern_cache_handle_data(handle, NULL);
+    esp_err_t ret = playback_play_prism_borrowed(template_id, cptr, read_sz,
+                                                 playback_release_cache_handle, handle);
     uint32_t dt = (xTaskGetTickCount() * portTICK_PERIOD_MS) - start_ms;
     ESP_LOGI(TAG, "Deploy(template:%s) cache-miss size=%zu in %lu ms -> %s",
              template_id, read_sz, (unsigned long)dt, esp_err_to_name(ret));
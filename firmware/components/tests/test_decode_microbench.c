@@ -24,9 +24,16 @@
 #include "prism_decode_hooks.h"
 #include "bench_generators.h"
 #include "decode_stub.h"
+#include "prism_decoder.h"
+#include "prism_history.h"
+#include "prism_temporal_api.h"
 
 static const char *TAG = "decode_bench";
 
+// R1.1 envelope (docs/research/R1.1_decode_budget.md)
+#define R11_BUDGET_AVG_US  500
+#define R11_BUDGET_P99_US  1000
+
 // --- Placeholder decode Adapter ------------------------------------------------
 // When #30 lands, wire this to the real decode API. For now, we simulate a
 // single-pass O(N) walk over a byte buffer to validate the harness plumbing.
@@ -223,3 +230,115 @@ TEST_CASE("Decode stub produces deterministic output", "[decode][bench][stub]")
     produced = bench_decode_apply(&state, &desc, out, sizeof(out));
     TEST_ASSERT_EQUAL(16u * 3u, produced);
 }
+
+TEST_CASE("Interpolation blend fits R1.1 budget", "[decode][bench][interp]") {
+    // 160 LEDs, full 64-entry palette, two raw frames where every index changes
+    const uint16_t leds = 160;
+    const uint16_t pal = PRISM_DECODER_MAX_PALETTE;
+    size_t len = 2 + (size_t)pal * 3 + 2 * (3 + (size_t)leds);
+    uint8_t *payload = (uint8_t*)heap_caps_malloc(len, MALLOC_CAP_8BIT);
+    prism_decoder_t *dec = (prism_decoder_t*)heap_caps_malloc(sizeof(*dec), MALLOC_CAP_8BIT);
+    uint8_t *ch1 = (uint8_t*)heap_caps_malloc((size_t)leds * 3, MALLOC_CAP_8BIT);
+    uint8_t *ch2 = (uint8_t*)heap_caps_malloc((size_t)leds * 3, MALLOC_CAP_8BIT);
+    TEST_ASSERT_NOT_NULL(payload);
+    TEST_ASSERT_NOT_NULL(dec);
+    TEST_ASSERT_NOT_NULL(ch1);
+    TEST_ASSERT_NOT_NULL(ch2);
+
+    size_t n = 0;
+    payload[n++] = (uint8_t)pal; payload[n++] = 0;
+    for (size_t i = 0; i < (size_t)pal * 3; ++i) payload[n++] = (uint8_t)(i * 37u);
+    for (int f = 0; f < 2; ++f) {
+        payload[n++] = 0x00; payload[n++] = (uint8_t)(leds & 0xFF); payload[n++] = (uint8_t)(leds >> 8);
+        for (uint16_t i = 0; i < leds; ++i) payload[n++] = (uint8_t)((i * 7u + f * 31u) % pal);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_init(dec, payload, len, 2, leds));
+    dec->keep_prev = true;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_next(dec));
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_next(dec));
+    TEST_ASSERT_TRUE(dec->prev_valid);
+
+    const size_t frames = 256;
+    stats_t st = {0};
+    stats_init(&st, frames);
+    size_t free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+    for (size_t i = 0; i < frames; ++i) {
+        prism_decode_hook_ctx_t ctx = {0};
+        prism_decode_begin(&ctx);
+        prism_decoder_expand_interp(dec, dec->palette_grb, (uint16_t)(i & 0xFF), ch1, ch2);
+        uint32_t cycles = 0, us = 0;
+        prism_decode_end(&ctx, &cycles, &us);
+        stats_add(&st, cycles, us);
+    }
+
+    size_t free_after = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    stats_finalize(&st);
+    uint32_t p99_us = (st.count && st.p99_index < st.count) ? st.samples[st.p99_index].us : 0;
+    ESP_LOGI(TAG, "Interp blend: frames=%u avg=%u us p99=%u us max=%u us",
+             (unsigned)st.count, (unsigned)st.avg_us, (unsigned)p99_us, (unsigned)st.max_us);
+
+    TEST_ASSERT_EQUAL_UINT32(free_before, free_after);
+    TEST_ASSERT_TRUE(st.avg_us <= R11_BUDGET_AVG_US);
+    TEST_ASSERT_TRUE(p99_us <= R11_BUDGET_P99_US);
+
+    stats_free(&st);
+    free(ch2);
+    free(ch1);
+    free(dec);
+    free(payload);
+}
+
+TEST_CASE("History gather fits R1.1 budget", "[decode][bench][history]") {
+    // 160 LEDs with WAVE delays spread across the deepest 1 s history
+    const uint16_t leds = 160;
+    static prism_temporal_ctx_t tctx;
+    static uint16_t ch1_u16[160], ch2_u16[160];
+    TEST_ASSERT_EQUAL(ESP_OK, prism_motion_init(&tctx, ch1_u16, ch2_u16, leds));
+    tctx.sync_mode = PRISM_SYNC_WAVE;
+    tctx.params.delay_ms = 500;
+    tctx.params.wave_amplitude_ms = 480;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_temporal_compile(&tctx, leds));
+
+    prism_history_t history = {0};
+    TEST_ASSERT_EQUAL(ESP_OK, prism_history_init(&history, &tctx.map, 1000000 / 120));
+    uint8_t *indices = (uint8_t*)heap_caps_malloc(leds, MALLOC_CAP_8BIT);
+    uint8_t *ch2 = (uint8_t*)heap_caps_malloc((size_t)leds * 3, MALLOC_CAP_8BIT);
+    uint8_t palette[PRISM_DECODER_MAX_PALETTE * 3];
+    TEST_ASSERT_NOT_NULL(indices);
+    TEST_ASSERT_NOT_NULL(ch2);
+    for (size_t i = 0; i < sizeof(palette); ++i) palette[i] = (uint8_t)(i * 37u);
+
+    const size_t frames = 256;
+    stats_t st = {0};
+    stats_init(&st, frames);
+    size_t free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+    for (size_t f = 0; f < frames; ++f) {
+        for (uint16_t i = 0; i < leds; ++i) indices[i] = (uint8_t)((i * 7u + f) % PRISM_DECODER_MAX_PALETTE);
+        prism_decode_hook_ctx_t ctx = {0};
+        prism_decode_begin(&ctx);
+        prism_history_push(&history, indices);
+        prism_history_expand(&history, palette, PRISM_DECODER_MAX_PALETTE, ch2);
+        uint32_t cycles = 0, us = 0;
+        prism_decode_end(&ctx, &cycles, &us);
+        stats_add(&st, cycles, us);
+    }
+
+    size_t free_after = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    stats_finalize(&st);
+    uint32_t p99_us = (st.count && st.p99_index < st.count) ? st.samples[st.p99_index].us : 0;
+    ESP_LOGI(TAG, "History gather: depth=%u frames=%u avg=%u us p99=%u us max=%u us",
+             (unsigned)history.depth, (unsigned)st.count, (unsigned)st.avg_us,
+             (unsigned)p99_us, (unsigned)st.max_us);
+
+    TEST_ASSERT_EQUAL_UINT32(free_before, free_after);
+    TEST_ASSERT_TRUE(st.avg_us <= R11_BUDGET_AVG_US);
+    TEST_ASSERT_TRUE(p99_us <= R11_BUDGET_P99_US);
+
+    stats_free(&st);
+    prism_history_deinit(&history);
+    free(ch2);
+    free(indices);
+}
@@ -5,7 +5,23 @@
 
 #include "unity.h"
 #include "effect_engine.h"
+#include "esp_log.h"
+#include "esp_timer.h"
 #include <string.h>
+#include <math.h>
+
+static const char *TAG = "test_effects";
+
+// Float reference matching the original powf-based LUT build
+static void gamma_lut_powf(uint16_t gamma_x100, uint8_t lut[256])
+{
+    float g = (gamma_x100 > 0) ? (gamma_x100 / 100.0f) : 1.0f;
+    for (int i = 0; i < 256; ++i) {
+        float y = 255.0f * powf((float)i / 255.0f, g) + 0.5f;
+        if (y > 255.0f) y = 255.0f;
+        lut[i] = (uint8_t)y;
+    }
+}
 
 TEST_CASE("effect_engine brightness ramp", "[effects]")
 {
@@ -51,3 +67,137 @@ TEST_CASE("effect_engine gamma lut updates", "[effects]")
     TEST_ASSERT_TRUE(tmp[1] <= pixel[1]);
 }
 
+
+TEST_CASE("effect_engine compiled LUT matches staged gamma, brightness and white balance", "[effects]")
+{
+    effect_engine_init();
+    effect_chain_clear();
+    effect_add_gamma(220);
+    effect_add_brightness(128);
+    effect_set_white_balance(255, 200, 100);   // r, g, b
+
+    // One GRB pixel per input level
+    uint8_t buf[256 * 3];
+    for (int i = 0; i < 256; ++i) {
+        buf[i * 3 + 0] = (uint8_t)i;
+        buf[i * 3 + 1] = (uint8_t)i;
+        buf[i * 3 + 2] = (uint8_t)i;
+    }
+    effect_chain_apply(buf, 256);
+
+    // Reference: gamma, then x*scale/255 rounded, per stage
+    static const uint8_t gain_grb[3] = {200, 255, 100};
+    uint8_t gamma[256];
+    effect_gamma_build_lut(220, gamma);
+    for (int i = 0; i < 256; ++i) {
+        uint32_t v = gamma[i];
+        v = (v * 128u + 127u) / 255u;
+        for (int c = 0; c < 3; ++c) {
+            uint32_t e = (v * gain_grb[c] + 127u) / 255u;
+            TEST_ASSERT_EQUAL_UINT8((uint8_t)e, buf[i * 3 + c]);
+        }
+    }
+
+    // Unity gains and full brightness with gamma 1.0 leave the buffer alone
+    effect_chain_clear();
+    effect_add_brightness(255);
+    effect_set_white_balance(255, 255, 255);
+    uint8_t px[3] = {1, 128, 254};
+    uint8_t tmp[3]; memcpy(tmp, px, sizeof(px));
+    effect_chain_apply(tmp, 1);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(px, tmp, sizeof(px));
+}
+
+TEST_CASE("effect_engine integer gamma LUT within 1 of powf", "[effects]")
+{
+    uint8_t lut[256];
+    uint8_t ref[256];
+    for (uint16_t g = 20; g <= 400; ++g) {
+        effect_gamma_build_lut(g, lut);
+        gamma_lut_powf(g, ref);
+        for (int i = 0; i < 256; ++i) {
+            int d = (int)lut[i] - (int)ref[i];
+            TEST_ASSERT_TRUE(d >= -1 && d <= 1);
+        }
+    }
+    // Gamma 1.0 is exact so the compiled chain can skip it
+    effect_gamma_build_lut(100, lut);
+    for (int i = 0; i < 256; ++i) {
+        TEST_ASSERT_EQUAL_UINT8((uint8_t)i, lut[i]);
+    }
+}
+
+TEST_CASE("effect_engine gamma ramp frame build bench", "[effects][bench]")
+{
+    // 1 s gamma ramp 1.0 -> 2.5 at 120 FPS over two 160-LED channels
+    enum { FRAMES = 120, LEDS = 160, TICK_MS = 8 };
+    static uint8_t ch1[LEDS * 3];
+    static uint8_t ch2[LEDS * 3];
+    for (int i = 0; i < LEDS * 3; ++i) {
+        ch1[i] = (uint8_t)(i * 7);
+        ch2[i] = (uint8_t)(i * 13);
+    }
+
+    // Before: float LUT rebuild, then gamma and brightness passes per channel
+    uint32_t before_max = 0;
+    uint64_t before_sum = 0;
+    uint8_t lut[256];
+    for (int f = 0; f < FRAMES; ++f) {
+        uint16_t g = (uint16_t)(100 + (150 * f) / FRAMES);
+        int64_t t0 = esp_timer_get_time();
+        gamma_lut_powf(g, lut);
+        uint8_t *bufs[2] = {ch1, ch2};
+        for (int b = 0; b < 2; ++b) {
+            for (int i = 0; i < LEDS * 3; ++i) bufs[b][i] = lut[bufs[b][i]];
+            for (int i = 0; i < LEDS * 3; ++i) bufs[b][i] = (uint8_t)((bufs[b][i] * 200) >> 8);
+        }
+        uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+        before_sum += dt;
+        if (dt > before_max) before_max = dt;
+    }
+
+    // After: integer LUT bank folded into the compiled chain
+    effect_engine_init();
+    effect_chain_clear();
+    effect_add_gamma(100);
+    effect_add_brightness(200);
+    effect_gamma_set_target(250, FRAMES * TICK_MS);
+    uint32_t after_max = 0;
+    uint64_t after_sum = 0;
+    for (int f = 0; f < FRAMES; ++f) {
+        int64_t t0 = esp_timer_get_time();
+        effect_engine_tick(TICK_MS);
+        effect_chain_apply(ch1, LEDS);
+        effect_chain_apply(ch2, LEDS);
+        uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+        after_sum += dt;
+        if (dt > after_max) after_max = dt;
+    }
+
+    ESP_LOGI(TAG, "{\"bench\":\"gamma_ramp\",\"frames\":%d,\"before_max_us\":%u,\"before_avg_us\":%u,"
+             "\"after_max_us\":%u,\"after_avg_us\":%u}",
+             FRAMES, (unsigned)before_max, (unsigned)(before_sum / FRAMES),
+             (unsigned)after_max, (unsigned)(after_sum / FRAMES));
+    // Compare totals over the ramp; a single preempted frame can swing the
+    // max, so it is only reported above
+    TEST_ASSERT_TRUE(after_sum < before_sum);
+}
+
+// Integer LUT build target on a 240 MHz ESP32-S3 (~12 cycles per entry)
+#define GAMMA_LUT_BUILD_BUDGET_US 15
+
+TEST_CASE("effect_engine gamma LUT build within budget", "[effects][bench]")
+{
+    enum { BUILDS = 256 };
+    uint8_t lut[256];
+    // Warm caches so the first build's misses don't count
+    effect_gamma_build_lut(220, lut);
+    int64_t t0 = esp_timer_get_time();
+    for (int n = 0; n < BUILDS; ++n) {
+        effect_gamma_build_lut((uint16_t)(100 + (n % 150)), lut);
+    }
+    uint32_t avg_us = (uint32_t)((esp_timer_get_time() - t0) / BUILDS);
+    ESP_LOGI(TAG, "{\"bench\":\"gamma_lut_build\",\"builds\":%d,\"avg_us\":%u,\"budget_us\":%d}",
+             BUILDS, (unsigned)avg_us, GAMMA_LUT_BUILD_BUDGET_US);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(GAMMA_LUT_BUILD_BUDGET_US, avg_us);
+}
@@ -0,0 +1,329 @@
+/**
+ * @file test_led_driver.c
+ * @brief LED driver scheduling and buffer tests against a mock backend
+ *
+ * The driver is brought up with a recording led_hal_ops_t instead of RMT
+ * and stepped with led_driver_refresh_once() on a synthetic clock, so no
+ * timers, tasks or LEDs are involved.
+ */
+
+#include "unity.h"
+#include <string.h>
+#include "led_driver.h"
+
+#define MOCK_MAX_EVENTS 64
+
+typedef enum {
+    MOCK_TRANSMIT,
+    MOCK_WAIT,
+} mock_event_type_t;
+
+typedef struct {
+    mock_event_type_t type;
+    uint8_t channel;
+    size_t len;
+    uint8_t first;      // First byte sent (transmit only)
+    const ws2812_output_lut_t *lut;
+} mock_event_t;
+
+typedef struct {
+    uint8_t channel;
+    int gpio;
+    uint16_t led_count;
+    bool busy;
+} mock_channel_t;
+
+typedef struct {
+    mock_channel_t channels[LED_MAX_CHANNELS];
+    mock_event_t events[MOCK_MAX_EVENTS];
+    size_t event_count;
+    int live_channels;
+    bool overlap;       // A transmit was started on a busy channel
+} mock_hal_t;
+
+static mock_hal_t s_mock;
+
+static void mock_record(mock_event_type_t type, uint8_t channel, size_t len, uint8_t first,
+                        const ws2812_output_lut_t *lut)
+{
+    if (s_mock.event_count < MOCK_MAX_EVENTS) {
+        s_mock.events[s_mock.event_count++] = (mock_event_t){type, channel, len, first, lut};
+    }
+}
+
+static esp_err_t mock_channel_init(void *ctx, const led_hal_channel_config_t *config, void **out_handle)
+{
+    mock_hal_t *mock = (mock_hal_t *)ctx;
+    mock_channel_t *channel = &mock->channels[config->channel];
+    channel->channel = config->channel;
+    channel->gpio = config->gpio;
+    channel->led_count = config->led_count;
+    channel->busy = false;
+    mock->live_channels++;
+    *out_handle = channel;
+    return ESP_OK;
+}
+
+static esp_err_t mock_transmit(void *ctx, void *handle, const uint8_t *grb, size_t len,
+                               const ws2812_output_lut_t *lut)
+{
+    mock_hal_t *mock = (mock_hal_t *)ctx;
+    mock_channel_t *channel = (mock_channel_t *)handle;
+    if (channel->busy) {
+        mock->overlap = true;
+    }
+    channel->busy = true;
+    mock_record(MOCK_TRANSMIT, channel->channel, len, grb[0], lut);
+    return ESP_OK;
+}
+
+static esp_err_t mock_wait_done(void *ctx, void *handle, int32_t timeout_ms)
+{
+    (void)ctx;
+    (void)timeout_ms;
+    mock_channel_t *channel = (mock_channel_t *)handle;
+    channel->busy = false;
+    mock_record(MOCK_WAIT, channel->channel, 0, 0, NULL);
+    return ESP_OK;
+}
+
+static void mock_channel_deinit(void *ctx, void *handle)
+{
+    (void)handle;
+    ((mock_hal_t *)ctx)->live_channels--;
+}
+
+static const led_hal_ops_t s_mock_ops = {
+    .channel_init = mock_channel_init,
+    .transmit = mock_transmit,
+    .wait_done = mock_wait_done,
+    .channel_deinit = mock_channel_deinit,
+};
+
+static const led_hal_ops_t s_mock_lut_ops = {
+    .channel_init = mock_channel_init,
+    .transmit = mock_transmit,
+    .wait_done = mock_wait_done,
+    .channel_deinit = mock_channel_deinit,
+    .caps = LED_HAL_CAP_OUTPUT_LUT,
+};
+
+static void mock_driver_init(uint8_t channel_count, uint16_t leds)
+{
+    memset(&s_mock, 0, sizeof(s_mock));
+    led_driver_config_t config = {
+        .channel_count = channel_count,
+        .leds_per_channel = leds,
+        .gpio = {4, 5, 6, 7},
+        .hal = &s_mock_ops,
+        .hal_ctx = &s_mock,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_init_with_config(&config));
+}
+
+static void mock_driver_deinit(void)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_deinit());
+    TEST_ASSERT_EQUAL(0, s_mock.live_channels);
+}
+
+// Fill every acquired channel with (base + channel) and commit
+static void commit_frame(uint8_t base)
+{
+    led_frame_t frame;
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_acquire_frames(&frame));
+    for (uint8_t ch = 0; ch < frame.channel_count; ++ch) {
+        memset(frame.ch[ch], base + ch, (size_t)frame.leds_per_channel * LED_BYTES_PER_LED);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_commit_frames());
+}
+
+TEST_CASE("led_driver rejects out-of-range layouts", "[led_driver]")
+{
+    led_driver_config_t config = LED_DRIVER_CONFIG_DEFAULT();
+    config.hal = &s_mock_ops;
+    config.hal_ctx = &s_mock;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_driver_init_with_config(NULL));
+    config.channel_count = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_driver_init_with_config(&config));
+    config.channel_count = LED_MAX_CHANNELS + 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_driver_init_with_config(&config));
+    config.channel_count = 2;
+    config.leds_per_channel = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_driver_init_with_config(&config));
+    config.leds_per_channel = LED_MAX_LEDS_PER_CH + 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_driver_init_with_config(&config));
+}
+
+TEST_CASE("led_driver brings up a runtime channel layout", "[led_driver]")
+{
+    mock_driver_init(4, LED_MAX_LEDS_PER_CH);
+
+    TEST_ASSERT_EQUAL(4, s_mock.live_channels);
+    TEST_ASSERT_EQUAL_UINT8(4, led_driver_get_channel_count());
+    TEST_ASSERT_EQUAL_UINT16(LED_MAX_LEDS_PER_CH, led_driver_get_leds_per_channel());
+    for (uint8_t ch = 0; ch < 4; ++ch) {
+        TEST_ASSERT_EQUAL(4 + ch, s_mock.channels[ch].gpio);
+        TEST_ASSERT_EQUAL_UINT16(LED_MAX_LEDS_PER_CH, s_mock.channels[ch].led_count);
+    }
+
+    led_frame_t frame;
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_acquire_frames(&frame));
+    TEST_ASSERT_EQUAL_UINT8(4, frame.channel_count);
+    TEST_ASSERT_EQUAL_UINT16(LED_MAX_LEDS_PER_CH, frame.leds_per_channel);
+    for (uint8_t ch = 0; ch < 4; ++ch) {
+        TEST_ASSERT_NOT_NULL(frame.ch[ch]);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_cancel_frames());
+
+    mock_driver_deinit();
+    TEST_ASSERT_EQUAL_UINT8(2, led_driver_get_channel_count());
+}
+
+TEST_CASE("led_driver starts every channel before waiting on any", "[led_driver]")
+{
+    mock_driver_init(3, 20);
+    commit_frame(0x10);
+    commit_frame(0x20);
+
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_refresh_once(1 * LED_FRAME_PERIOD_US));
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_refresh_once(2 * LED_FRAME_PERIOD_US));
+
+    // Slot 1: T0 T1 T2. Slot 2: W0 W1 W2, then T0 T1 T2
+    static const mock_event_type_t expect[9] = {
+        MOCK_TRANSMIT, MOCK_TRANSMIT, MOCK_TRANSMIT,
+        MOCK_WAIT, MOCK_WAIT, MOCK_WAIT,
+        MOCK_TRANSMIT, MOCK_TRANSMIT, MOCK_TRANSMIT,
+    };
+    TEST_ASSERT_EQUAL(9, s_mock.event_count);
+    for (size_t i = 0; i < 9; ++i) {
+        const mock_event_t *ev = &s_mock.events[i];
+        TEST_ASSERT_EQUAL(expect[i], ev->type);
+        TEST_ASSERT_EQUAL_UINT8(i % 3, ev->channel);
+        if (ev->type == MOCK_TRANSMIT) {
+            uint8_t base = (i < 3) ? 0x10 : 0x20;
+            TEST_ASSERT_EQUAL(20 * LED_BYTES_PER_LED, ev->len);
+            TEST_ASSERT_EQUAL_HEX8(base + ev->channel, ev->first);
+        }
+    }
+    TEST_ASSERT_FALSE(s_mock.overlap);
+
+    led_driver_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_get_stats(&stats));
+    TEST_ASSERT_EQUAL_UINT8(3, stats.channel_count);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.channels[2].frames_transmitted);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.total_buffer_swaps);
+
+    mock_driver_deinit();
+}
+
+TEST_CASE("led_driver single-channel commit repeats the other channels", "[led_driver]")
+{
+    mock_driver_init(4, 8);
+    commit_frame(0x40);
+
+    uint8_t *buf = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_acquire_frame(LED_CHANNEL_3, &buf));
+    memset(buf, 0x77, 8 * LED_BYTES_PER_LED);
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_commit_frame(LED_CHANNEL_3));
+
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_refresh_once(1 * LED_FRAME_PERIOD_US));
+    s_mock.event_count = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_refresh_once(2 * LED_FRAME_PERIOD_US));
+
+    static const uint8_t expect_first[4] = {0x40, 0x41, 0x77, 0x43};
+    size_t transmits = 0;
+    for (size_t i = 0; i < s_mock.event_count; ++i) {
+        const mock_event_t *ev = &s_mock.events[i];
+        if (ev->type == MOCK_TRANSMIT) {
+            TEST_ASSERT_EQUAL_HEX8(expect_first[ev->channel], ev->first);
+            transmits++;
+        }
+    }
+    TEST_ASSERT_EQUAL(4, transmits);
+
+    // Channels past the configured count are rejected
+    mock_driver_deinit();
+    mock_driver_init(2, 8);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, led_driver_acquire_frame(LED_CHANNEL_3, &buf));
+    mock_driver_deinit();
+}
+
+TEST_CASE("led_driver queue bounds render-ahead and drops late frames", "[led_driver]")
+{
+    mock_driver_init(1, 4);
+
+    for (int i = 0; i < LED_RENDER_AHEAD_FRAMES; ++i) {
+        commit_frame((uint8_t)(0x80 + i));
+    }
+    led_frame_t frame;
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, led_driver_acquire_frames(&frame));
+
+    // Wake several slots late: every queued frame is overdue, only the
+    // newest is shown and the rest are counted as dropped
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_refresh_once(10 * LED_FRAME_PERIOD_US));
+    const mock_event_t *ev = &s_mock.events[s_mock.event_count - 1];
+    TEST_ASSERT_EQUAL(MOCK_TRANSMIT, ev->type);
+    TEST_ASSERT_EQUAL_HEX8(0x80 + LED_RENDER_AHEAD_FRAMES - 1, ev->first);
+
+    // Nothing queued for the next slot: the frame repeats
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_refresh_once(11 * LED_FRAME_PERIOD_US));
+
+    led_driver_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_get_stats(&stats));
+    TEST_ASSERT_EQUAL_UINT32(LED_RENDER_AHEAD_FRAMES - 1, stats.frames_dropped);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.frames_duplicated);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.queue_underruns);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.queue_depth);
+
+    mock_driver_deinit();
+}
+
+TEST_CASE("led_driver hands each frame's output LUT to the backend", "[led_driver]")
+{
+    memset(&s_mock, 0, sizeof(s_mock));
+    led_driver_config_t config = {
+        .channel_count = 2,
+        .leds_per_channel = 4,
+        .gpio = {4, 5, -1, -1},
+        .hal = &s_mock_ops,
+        .hal_ctx = &s_mock,
+        .output_lut = true,
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, led_driver_init_with_config(&config));
+    config.hal = &s_mock_lut_ops;
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_init_with_config(&config));
+
+    // Frame 1 inverts, then a single-channel commit must keep that LUT
+    led_frame_t frame;
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_acquire_frames(&frame));
+    TEST_ASSERT_NOT_NULL(frame.output_lut);
+    for (int c = 0; c < 3; ++c) {
+        for (int i = 0; i < 256; ++i) {
+            frame.output_lut->component[c][i] = (uint8_t)(255 - i);
+        }
+    }
+    memset(frame.ch[0], 0x11, 4 * LED_BYTES_PER_LED);
+    memset(frame.ch[1], 0x22, 4 * LED_BYTES_PER_LED);
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_commit_frames());
+    uint8_t ch2[4 * LED_BYTES_PER_LED];
+    memset(ch2, 0x33, sizeof(ch2));
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_submit_frame(LED_CHANNEL_2, ch2));
+
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_refresh_once(1 * LED_FRAME_PERIOD_US));
+    TEST_ASSERT_EQUAL(ESP_OK, led_driver_refresh_once(2 * LED_FRAME_PERIOD_US));
+    size_t transmits = 0;
+    for (size_t i = 0; i < s_mock.event_count; ++i) {
+        const mock_event_t *ev = &s_mock.events[i];
+        if (ev->type == MOCK_TRANSMIT) {
+            TEST_ASSERT_NOT_NULL(ev->lut);
+            TEST_ASSERT_EQUAL_HEX8(0xFF, ev->lut->component[0][0]);
+            TEST_ASSERT_EQUAL_HEX8(0x00, ev->lut->component[2][255]);
+            transmits++;
+        }
+    }
+    TEST_ASSERT_EQUAL(4, transmits);
+
+    mock_driver_deinit();
+}
@@ -5,7 +5,10 @@
 
 #include "unity.h"
 #include "pattern_cache.h"
+#include "esp_timer.h"
 #include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
 
 TEST_CASE("pattern cache basic put/get and eviction", "[cache][storage]") {
     // Use small capacity to force eviction logic
@@ -15,27 +18,30 @@ TEST_CASE("pattern cache basic put/get and eviction", "[cache][storage]") {
     uint8_t b[400]; memset(b, 0xBB, sizeof(b));
     uint8_t c[400]; memset(c, 0xCC, sizeof(c));
 
-    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("a", a, sizeof(a)));
-    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("b", b, sizeof(b)));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("a", PATTERN_CACHE_CLASS_USER, a, sizeof(a)));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("b", PATTERN_CACHE_CLASS_USER, b, sizeof(b)));
 
     // Both a and b should be present (used=800)
+    pattern_cache_handle_t h = NULL;
     const uint8_t* ptr = NULL; size_t sz = 0;
-    TEST_ASSERT_TRUE(pattern_cache_try_get("a", &ptr, &sz));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_acquire("a", PATTERN_CACHE_CLASS_USER, &h, &ptr, &sz));
     TEST_ASSERT_EQUAL_UINT32(sizeof(a), sz);
     TEST_ASSERT_EQUAL_HEX8(0xAA, ptr[0]);
+    pattern_cache_release(h);
 
-    TEST_ASSERT_TRUE(pattern_cache_try_get("b", &ptr, &sz));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_acquire("b", PATTERN_CACHE_CLASS_USER, &h, &ptr, &sz));
     TEST_ASSERT_EQUAL_UINT32(sizeof(b), sz);
     TEST_ASSERT_EQUAL_HEX8(0xBB, ptr[0]);
+    pattern_cache_release(h);
 
     // Insert c (400). Capacity=1024. Need 400, free=224 -> evict LRU until enough room.
-    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("c", c, sizeof(c)));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("c", PATTERN_CACHE_CLASS_USER, c, sizeof(c)));
 
     // After eviction, only most recent entries should remain (depending on LRU order)
     // Access pattern b before inserting c moved b to MRU, so a should be evicted first.
-    TEST_ASSERT_FALSE(pattern_cache_try_get("a", &ptr, &sz));
-    TEST_ASSERT_TRUE(pattern_cache_try_get("b", &ptr, &sz));
-    TEST_ASSERT_TRUE(pattern_cache_try_get("c", &ptr, &sz));
+    TEST_ASSERT_FALSE(pattern_cache_try_get("a", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("b", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("c", PATTERN_CACHE_CLASS_USER, &sz));
 
     pattern_cache_deinit();
 }
@@ -43,11 +49,11 @@ TEST_CASE("pattern cache basic put/get and eviction", "[cache][storage]") {
 TEST_CASE("pattern cache stats track hits/misses", "[cache][storage]") {
     TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_init(512));
     uint8_t d[200]; memset(d, 0xDD, sizeof(d));
-    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("d", d, sizeof(d)));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("d", PATTERN_CACHE_CLASS_USER, d, sizeof(d)));
 
-    const uint8_t* ptr = NULL; size_t sz = 0;
-    (void)pattern_cache_try_get("x", &ptr, &sz); // miss
-    (void)pattern_cache_try_get("d", &ptr, &sz); // hit
+    size_t sz = 0;
+    (void)pattern_cache_try_get("x", PATTERN_CACHE_CLASS_USER, &sz); // miss
+    (void)pattern_cache_try_get("d", PATTERN_CACHE_CLASS_USER, &sz); // hit
 
     uint32_t h=0,m=0; size_t used=0, cnt=0;
     pattern_cache_stats(&h, &m, &used, &cnt);
@@ -59,3 +65,346 @@ TEST_CASE("pattern cache stats track hits/misses", "[cache][storage]") {
     pattern_cache_deinit();
 }
 
+TEST_CASE("pattern cache contains does not count lookups", "[cache][storage]") {
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_init(512));
+    uint8_t d[200]; memset(d, 0xDD, sizeof(d));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("d", PATTERN_CACHE_CLASS_TEMPLATE, d, sizeof(d)));
+
+    TEST_ASSERT_TRUE(pattern_cache_contains("d", PATTERN_CACHE_CLASS_TEMPLATE));
+    TEST_ASSERT_FALSE(pattern_cache_contains("x", PATTERN_CACHE_CLASS_TEMPLATE));
+    TEST_ASSERT_FALSE(pattern_cache_contains("d", PATTERN_CACHE_CLASS_USER));
+
+    pattern_cache_class_stats_t cs;
+    pattern_cache_class_stats(PATTERN_CACHE_CLASS_TEMPLATE, &cs);
+    TEST_ASSERT_EQUAL_UINT32(0, cs.hits);
+    TEST_ASSERT_EQUAL_UINT32(0, cs.misses);
+    pattern_cache_class_stats(PATTERN_CACHE_CLASS_USER, &cs);
+    TEST_ASSERT_EQUAL_UINT32(0, cs.misses);
+
+    pattern_cache_deinit();
+}
+
+TEST_CASE("pattern cache pinned entries survive eviction and invalidation", "[cache][storage]") {
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_init(1024));
+
+    uint8_t a[400]; memset(a, 0xAA, sizeof(a));
+    uint8_t b[400]; memset(b, 0xBB, sizeof(b));
+    uint8_t c[400]; memset(c, 0xCC, sizeof(c));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("a", PATTERN_CACHE_CLASS_USER, a, sizeof(a)));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("b", PATTERN_CACHE_CLASS_USER, b, sizeof(b)));
+
+    // Pin a, then touch b so a is the LRU entry
+    pattern_cache_handle_t ha = NULL;
+    const uint8_t* pa = NULL; size_t sa = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_acquire("a", PATTERN_CACHE_CLASS_USER, &ha, &pa, &sa));
+    size_t sz = 0;
+    TEST_ASSERT_TRUE(pattern_cache_try_get("b", PATTERN_CACHE_CLASS_USER, &sz));
+
+    // Inserting c must evict unpinned b rather than pinned a
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("c", PATTERN_CACHE_CLASS_USER, c, sizeof(c)));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("a", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_FALSE(pattern_cache_try_get("b", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("c", PATTERN_CACHE_CLASS_USER, &sz));
+
+    // Invalidating a pinned entry detaches it; the data stays readable
+    pattern_cache_invalidate("a");
+    TEST_ASSERT_FALSE(pattern_cache_try_get("a", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_EQUAL_HEX8(0xAA, pa[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, pa[sa - 1]);
+    pattern_cache_release(ha);
+
+    size_t used = 0, cnt = 0;
+    pattern_cache_stats(NULL, NULL, &used, &cnt);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(c), used);
+    TEST_ASSERT_EQUAL_UINT32(1, cnt);
+
+    pattern_cache_deinit();
+}
+
+TEST_CASE("pattern cache put_take pins the cached entry", "[cache][storage]") {
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_init(512));
+
+    uint8_t* buf = (uint8_t*)malloc(300);
+    TEST_ASSERT_NOT_NULL(buf);
+    memset(buf, 0x5A, 300);
+    pattern_cache_handle_t h = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_take("t", PATTERN_CACHE_CLASS_USER, buf, 300, &h));   // Copied into the arena
+    size_t sz = 0;
+    const uint8_t* ht = pattern_cache_handle_data(h, &sz);
+    TEST_ASSERT_EQUAL_UINT32(300, sz);
+    TEST_ASSERT_EQUAL_HEX8(0x5A, ht[299]);
+
+    // Too large to cache alongside the pinned entry: handle owns the buffer
+    uint8_t* big = (uint8_t*)malloc(400);
+    TEST_ASSERT_NOT_NULL(big);
+    pattern_cache_handle_t hb = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_take("big", PATTERN_CACHE_CLASS_USER, big, 400, &hb));
+    TEST_ASSERT_FALSE(pattern_cache_try_get("big", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_TRUE(pattern_cache_handle_data(hb, NULL) == big);
+    pattern_cache_release(hb);
+
+    // Released entries remain cached for later hits
+    pattern_cache_release(h);
+    const uint8_t* ptr = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_acquire("t", PATTERN_CACHE_CLASS_USER, &h, &ptr, &sz));
+    TEST_ASSERT_EQUAL_HEX8(0x5A, ptr[0]);
+    pattern_cache_release(h);
+
+    pattern_cache_deinit();
+}
+
+TEST_CASE("pattern cache reserve/commit reads in place", "[cache][storage]") {
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_init(1024));
+
+    pattern_cache_handle_t h = NULL;
+    uint8_t* buf = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_reserve("r", PATTERN_CACHE_CLASS_USER, 600, &h, &buf));
+    memset(buf, 0x3C, 500);
+    TEST_ASSERT_FALSE(pattern_cache_try_get("r", PATTERN_CACHE_CLASS_USER, NULL));     // Not visible until committed
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_commit(h, 500));
+    pattern_cache_handle_t hr = NULL;
+    const uint8_t* ptr = NULL; size_t sz = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_acquire("r", PATTERN_CACHE_CLASS_USER, &hr, &ptr, &sz));
+    TEST_ASSERT_TRUE(ptr == buf);
+    TEST_ASSERT_EQUAL_UINT32(500, sz);
+    pattern_cache_release(hr);
+
+    // The pinned reservation holds its room: a second one cannot fit
+    pattern_cache_handle_t h2 = NULL;
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, pattern_cache_reserve("s", PATTERN_CACHE_CLASS_USER, 600, &h2, &buf));
+    pattern_cache_release(h);
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_reserve("s", PATTERN_CACHE_CLASS_USER, 600, &h2, &buf));
+    pattern_cache_release(h2);                                     // Discarded uncommitted
+    TEST_ASSERT_FALSE(pattern_cache_try_get("s", PATTERN_CACHE_CLASS_USER, &sz));
+
+    pattern_cache_deinit();
+}
+
+TEST_CASE("pattern cache survives insert/evict churn", "[cache][storage]") {
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_init(64 * 1024));
+
+    // Mixed sizes force runs to be evicted and reused at shifting offsets;
+    // every surviving entry must still hold its own bytes.
+    static uint8_t data[20 * 1024];
+    char id[16];
+    uint32_t seed = 1;
+    for (int i = 0; i < 2000; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        size_t size = 1 + (seed >> 8) % sizeof(data);
+        snprintf(id, sizeof(id), "p%d", (int)((seed >> 4) % 60));
+        memset(data, (uint8_t)size, size);
+        TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy(id, PATTERN_CACHE_CLASS_USER, data, size));
+    }
+
+    size_t used = 0, cnt = 0;
+    pattern_cache_stats(NULL, NULL, &used, &cnt);
+    TEST_ASSERT_TRUE(cnt > 0 && cnt <= PATTERN_CACHE_MAX_ENTRIES);
+    TEST_ASSERT_TRUE(used <= 64 * 1024);
+
+    size_t seen = 0;
+    for (int k = 0; k < 60; ++k) {
+        snprintf(id, sizeof(id), "p%d", k);
+        pattern_cache_handle_t h = NULL;
+        const uint8_t* ptr = NULL; size_t sz = 0;
+        if (pattern_cache_acquire(id, PATTERN_CACHE_CLASS_USER, &h, &ptr, &sz) != ESP_OK) continue;
+        seen++;
+        TEST_ASSERT_EQUAL_HEX8((uint8_t)sz, ptr[0]);
+        TEST_ASSERT_EQUAL_HEX8((uint8_t)sz, ptr[sz - 1]);
+        pattern_cache_release(h);
+    }
+    TEST_ASSERT_EQUAL_UINT32(cnt, seen);
+
+    pattern_cache_deinit();
+}
+
+TEST_CASE("pattern cache lookups survive hash removals", "[cache][storage]") {
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_init(PATTERN_CACHE_DEFAULT_CAPACITY));
+
+    uint8_t v[8];
+    char id[16];
+    for (int i = 0; i < 40; ++i) {
+        snprintf(id, sizeof(id), "id%d", i);
+        memset(v, i, sizeof(v));
+        TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy(id, PATTERN_CACHE_CLASS_USER, v, sizeof(v)));
+    }
+    for (int i = 0; i < 40; i += 3) {
+        snprintf(id, sizeof(id), "id%d", i);
+        pattern_cache_invalidate(id);
+    }
+    for (int i = 0; i < 40; ++i) {
+        snprintf(id, sizeof(id), "id%d", i);
+        pattern_cache_handle_t h = NULL;
+        const uint8_t* ptr = NULL; size_t sz = 0;
+        bool hit = pattern_cache_acquire(id, PATTERN_CACHE_CLASS_USER, &h, &ptr, &sz) == ESP_OK;
+        TEST_ASSERT_EQUAL(i % 3 != 0, hit);
+        if (hit) {
+            TEST_ASSERT_EQUAL_HEX8(i, ptr[7]);
+            pattern_cache_release(h);
+        }
+    }
+
+    pattern_cache_deinit();
+}
+
+TEST_CASE("pattern cache weighs frequency and load cost over recency", "[cache][storage]") {
+    // 64-byte segments: each 2KB entry is exactly half the arena
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_init(4096));
+    uint8_t v[2048]; memset(v, 0x77, sizeof(v));
+    size_t sz = 0;
+
+    // "slow" takes 10ms between reserve and commit; "fast" is a cheap copy
+    // hit more recently and more often
+    pattern_cache_handle_t h = NULL;
+    uint8_t* buf = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_reserve("slow", PATTERN_CACHE_CLASS_USER, sizeof(v), &h, &buf));
+    int64_t until = esp_timer_get_time() + 10000;
+    while (esp_timer_get_time() < until) { }
+    memcpy(buf, v, sizeof(v));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_commit(h, sizeof(v)));
+    pattern_cache_release(h);
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("fast", PATTERN_CACHE_CLASS_USER, v, sizeof(v)));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("fast", PATTERN_CACHE_CLASS_USER, &sz));
+
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("x", PATTERN_CACHE_CLASS_USER, v, sizeof(v)));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("slow", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_FALSE(pattern_cache_try_get("fast", PATTERN_CACHE_CLASS_USER, &sz));
+
+    // Equal cost: the more frequently hit entry stays even when it is the LRU
+    for (int i = 0; i < 3; ++i) {
+        TEST_ASSERT_TRUE(pattern_cache_try_get("x", PATTERN_CACHE_CLASS_USER, &sz));
+    }
+    pattern_cache_clear();
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("often", PATTERN_CACHE_CLASS_USER, v, sizeof(v)));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("once", PATTERN_CACHE_CLASS_USER, v, sizeof(v)));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("often", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("often", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("once", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("new", PATTERN_CACHE_CLASS_USER, v, sizeof(v)));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("often", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_FALSE(pattern_cache_try_get("once", PATTERN_CACHE_CLASS_USER, &sz));
+
+    pattern_cache_deinit();
+}
+
+TEST_CASE("pattern cache enforces class quotas and counts hits per class", "[cache][storage]") {
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_init(1024));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_set_quota(PATTERN_CACHE_CLASS_TEMPLATE, 500));
+    uint8_t v[600]; memset(v, 0x42, sizeof(v));
+    size_t sz = 0;
+
+    // The second template evicts the first (its own class), not the older user entry
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("t1", PATTERN_CACHE_CLASS_TEMPLATE, v, 400));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("u", PATTERN_CACHE_CLASS_USER, v, 400));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("t2", PATTERN_CACHE_CLASS_TEMPLATE, v, 400));
+    TEST_ASSERT_FALSE(pattern_cache_try_get("t1", PATTERN_CACHE_CLASS_TEMPLATE, &sz));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("t2", PATTERN_CACHE_CLASS_TEMPLATE, &sz));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("u", PATTERN_CACHE_CLASS_USER, &sz));
+
+    // Larger than the quota: not cached
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("t3", PATTERN_CACHE_CLASS_TEMPLATE, v, 600));
+    TEST_ASSERT_FALSE(pattern_cache_try_get("t3", PATTERN_CACHE_CLASS_TEMPLATE, &sz));
+
+    pattern_cache_class_stats_t ts, us;
+    pattern_cache_class_stats(PATTERN_CACHE_CLASS_TEMPLATE, &ts);
+    pattern_cache_class_stats(PATTERN_CACHE_CLASS_USER, &us);
+    TEST_ASSERT_EQUAL_UINT32(1, ts.entry_count);
+    TEST_ASSERT_EQUAL_UINT32(400, ts.held_bytes);
+    TEST_ASSERT_EQUAL_UINT32(500, ts.quota_bytes);
+    TEST_ASSERT_EQUAL_UINT32(1, ts.hits);
+    TEST_ASSERT_EQUAL_UINT32(2, ts.misses);
+    TEST_ASSERT_EQUAL_UINT32(1, us.hits);
+    TEST_ASSERT_EQUAL_UINT32(0, us.misses);
+
+    pattern_cache_deinit();
+}
+
+TEST_CASE("pattern cache pin slots hold the active and next pattern", "[cache][storage]") {
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_init(1024));
+    uint8_t v[400]; memset(v, 0x24, sizeof(v));
+    pattern_cache_handle_t h = NULL;
+    const uint8_t* ptr = NULL; size_t sz = 0;
+
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("a", PATTERN_CACHE_CLASS_USER, v, sizeof(v)));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("b", PATTERN_CACHE_CLASS_USER, v, sizeof(v)));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_acquire("a", PATTERN_CACHE_CLASS_USER, &h, &ptr, &sz));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_pin(PATTERN_CACHE_PIN_ACTIVE, h));
+    pattern_cache_handle_t ha = h;
+    pattern_cache_release(h);
+    TEST_ASSERT_TRUE(pattern_cache_try_get("b", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("b", PATTERN_CACHE_CLASS_USER, &sz));
+
+    // a is the cheaper entry but pinned, so b goes
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("c", PATTERN_CACHE_CLASS_USER, v, sizeof(v)));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("a", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_FALSE(pattern_cache_try_get("b", PATTERN_CACHE_CLASS_USER, &sz));
+
+    // c moves from NEXT to ACTIVE; a is unpinned and becomes the victim
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_acquire("c", PATTERN_CACHE_CLASS_USER, &h, &ptr, &sz));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_pin(PATTERN_CACHE_PIN_NEXT, h));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_pin(PATTERN_CACHE_PIN_ACTIVE, h));
+    pattern_cache_release(h);
+    TEST_ASSERT_TRUE(pattern_cache_try_get("a", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("d", PATTERN_CACHE_CLASS_USER, v, sizeof(v)));
+    TEST_ASSERT_FALSE(pattern_cache_try_get("a", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("c", PATTERN_CACHE_CLASS_USER, &sz));
+
+    // Unpinning a slot that moved on to another entry leaves it alone
+    pattern_cache_unpin(PATTERN_CACHE_PIN_ACTIVE, ha);
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("e", PATTERN_CACHE_CLASS_USER, v, sizeof(v)));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("c", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_FALSE(pattern_cache_try_get("d", PATTERN_CACHE_CLASS_USER, &sz));
+
+    // Uncached handles cannot be pinned and clear the slot
+    uint8_t* big = (uint8_t*)malloc(2048);
+    TEST_ASSERT_NOT_NULL(big);
+    pattern_cache_handle_t hb = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_take("big", PATTERN_CACHE_CLASS_USER, big, 2048, &hb));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, pattern_cache_pin(PATTERN_CACHE_PIN_NEXT, hb));
+    pattern_cache_release(hb);
+
+    // Unpinned (cleared) c can be evicted again
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_acquire("c", PATTERN_CACHE_CLASS_USER, &h, &ptr, &sz));
+    pattern_cache_unpin(PATTERN_CACHE_PIN_ACTIVE, h);
+    pattern_cache_release(h);
+    uint8_t w[1024]; memset(w, 0x42, sizeof(w));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("w", PATTERN_CACHE_CLASS_USER, w, sizeof(w)));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("w", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_FALSE(pattern_cache_try_get("c", PATTERN_CACHE_CLASS_USER, &sz));
+
+    pattern_cache_deinit();
+}
+
+TEST_CASE("pattern cache keys entries by class and ID", "[cache][storage]") {
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_init(1024));
+    uint8_t u[100]; memset(u, 0x11, sizeof(u));
+    uint8_t t[200]; memset(t, 0x22, sizeof(t));
+
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("same", PATTERN_CACHE_CLASS_USER, u, sizeof(u)));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("same", PATTERN_CACHE_CLASS_TEMPLATE, t, sizeof(t)));
+    size_t cnt = 0;
+    pattern_cache_stats(NULL, NULL, NULL, &cnt);
+    TEST_ASSERT_EQUAL_UINT32(2, cnt);
+
+    pattern_cache_handle_t h = NULL;
+    const uint8_t* ptr = NULL; size_t sz = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_acquire("same", PATTERN_CACHE_CLASS_USER, &h, &ptr, &sz));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(u), sz);
+    TEST_ASSERT_EQUAL_HEX8(0x11, ptr[0]);
+    pattern_cache_release(h);
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_acquire("same", PATTERN_CACHE_CLASS_TEMPLATE, &h, &ptr, &sz));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(t), sz);
+    TEST_ASSERT_EQUAL_HEX8(0x22, ptr[0]);
+    pattern_cache_release(h);
+
+    // Only the template class holds "only"
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_cache_put_copy("only", PATTERN_CACHE_CLASS_TEMPLATE, t, sizeof(t)));
+    TEST_ASSERT_FALSE(pattern_cache_try_get("only", PATTERN_CACHE_CLASS_USER, &sz));
+
+    // Invalidation has no class and drops both
+    pattern_cache_invalidate("same");
+    TEST_ASSERT_FALSE(pattern_cache_try_get("same", PATTERN_CACHE_CLASS_USER, &sz));
+    TEST_ASSERT_FALSE(pattern_cache_try_get("same", PATTERN_CACHE_CLASS_TEMPLATE, &sz));
+    TEST_ASSERT_TRUE(pattern_cache_try_get("only", PATTERN_CACHE_CLASS_TEMPLATE, &sz));
+
+    pattern_cache_deinit();
+}
@@ -0,0 +1,96 @@
+/**
+ * @file test_pattern_index.c
+ * @brief Unity tests for the in-RAM pattern index
+ */
+
+#include "unity.h"
+#include "pattern_index.h"
+#include "prism_parser.h"
+#include <string.h>
+#include <stdio.h>
+
+static void make_prism(uint8_t *buf, size_t len, uint32_t frames, bool good_crc) {
+    memset(buf, 0, len);
+    prism_header_v11_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.base.magic, PRISM_MAGIC, 4);
+    hdr.base.version = 0x0100;
+    hdr.base.led_count = 160;
+    hdr.base.frame_count = frames;
+    hdr.base.fps = 120;
+    hdr.base.crc32 = calculate_header_crc(&hdr) ^ (good_crc ? 0 : 1);
+    memcpy(buf, &hdr.base, sizeof(hdr.base));
+}
+
+TEST_CASE("pattern index keeps entries sorted and pages through them", "[index][storage]") {
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_index_build("/nonexistent"));
+    TEST_ASSERT_EQUAL_UINT32(0, pattern_index_count());
+
+    const uint8_t raw[16] = {0};
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_index_put("charlie", raw, sizeof(raw), sizeof(raw), 3));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_index_put("alpha", raw, sizeof(raw), sizeof(raw), 1));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_index_put("bravo", raw, 8, 8, 2));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_index_put("bravo", raw, sizeof(raw), sizeof(raw), 4));  // Replace
+    TEST_ASSERT_EQUAL_UINT32(3, pattern_index_count());
+
+    pattern_index_entry_t page[2];
+    TEST_ASSERT_EQUAL_UINT32(2, pattern_index_page(0, page, 2));
+    TEST_ASSERT_EQUAL_STRING("alpha", page[0].id);
+    TEST_ASSERT_EQUAL_STRING("bravo", page[1].id);
+    TEST_ASSERT_EQUAL_UINT32(16, page[1].size);
+    TEST_ASSERT_EQUAL_UINT32(4, page[1].mtime);
+    TEST_ASSERT_EQUAL_UINT32(1, pattern_index_page(2, page, 2));
+    TEST_ASSERT_EQUAL_STRING("charlie", page[0].id);
+    TEST_ASSERT_EQUAL_UINT32(0, pattern_index_page(3, page, 2));
+
+    pattern_index_remove("bravo");
+    pattern_index_remove("missing");
+    TEST_ASSERT_EQUAL_UINT32(2, pattern_index_count());
+    TEST_ASSERT_FALSE(pattern_index_get("bravo", &page[0]));
+    TEST_ASSERT_TRUE(pattern_index_get("charlie", &page[0]));
+    TEST_ASSERT_FALSE(page[0].is_prism);
+    pattern_index_clear();
+}
+
+TEST_CASE("pattern index caches .prism header fields and CRC state", "[index][storage]") {
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_index_build("/nonexistent"));
+    uint8_t buf[128];
+    pattern_index_entry_t e;
+
+    make_prism(buf, sizeof(buf), 240, true);
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_index_put("good", buf, sizeof(buf), sizeof(buf), 0));
+    TEST_ASSERT_TRUE(pattern_index_get("good", &e));
+    TEST_ASSERT_TRUE(e.is_prism);
+    TEST_ASSERT_TRUE(e.crc_verified);
+    TEST_ASSERT_EQUAL_UINT16(160, e.led_count);
+    TEST_ASSERT_EQUAL_UINT32(240, e.frame_count);
+    TEST_ASSERT_EQUAL_UINT32(120, e.fps);
+
+    make_prism(buf, sizeof(buf), 240, false);
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_index_put("bad", buf, sizeof(buf), sizeof(buf), 0));
+    TEST_ASSERT_TRUE(pattern_index_get("bad", &e));
+    TEST_ASSERT_TRUE(e.is_prism);
+    TEST_ASSERT_FALSE(e.crc_verified);
+    pattern_index_mark_verified("bad");
+    TEST_ASSERT_TRUE(pattern_index_get("bad", &e));
+    TEST_ASSERT_TRUE(e.crc_verified);
+    pattern_index_clear();
+}
+
+TEST_CASE("pattern index rejects overflow and long IDs", "[index][storage]") {
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_index_build("/nonexistent"));
+    const uint8_t raw[4] = {0};
+    char id[16];
+    for (int i = 0; i < PATTERN_INDEX_CAPACITY; ++i) {
+        snprintf(id, sizeof(id), "p%02d", i);
+        TEST_ASSERT_EQUAL(ESP_OK, pattern_index_put(id, raw, sizeof(raw), sizeof(raw), 0));
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, pattern_index_put("zz", raw, sizeof(raw), sizeof(raw), 0));
+    TEST_ASSERT_EQUAL(ESP_OK, pattern_index_put("p00", raw, sizeof(raw), sizeof(raw), 9));   // Replace still fits
+
+    char long_id[PATTERN_INDEX_ID_MAX + 1];
+    memset(long_id, 'x', sizeof(long_id) - 1);
+    long_id[sizeof(long_id) - 1] = '\0';
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, pattern_index_put(long_id, raw, sizeof(raw), sizeof(raw), 0));
+    pattern_index_clear();
+}
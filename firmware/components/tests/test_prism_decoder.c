@@ -0,0 +1,259 @@
+/**
+ * @file test_prism_decoder.c
+ * @brief Unit tests for the streaming .prism payload decoder
+ */
+
+#include "unity.h"
+#include <string.h>
+#include "prism_decoder.h"
+
+#define TEST_LEDS 8
+
+// Payload: 3-entry palette, then frames raw / delta / RLE / RLE+delta
+static size_t build_payload(uint8_t *buf)
+{
+    size_t n = 0;
+    buf[n++] = 3; buf[n++] = 0;                 // palette_count
+    buf[n++] = 0;   buf[n++] = 0;   buf[n++] = 0;    // 0: black
+    buf[n++] = 255; buf[n++] = 0;   buf[n++] = 0;    // 1: red
+    buf[n++] = 0;   buf[n++] = 255; buf[n++] = 0;    // 2: green
+
+    // Frame 0: raw [0 1 2 0 1 2 0 1]
+    static const uint8_t f0[TEST_LEDS] = {0, 1, 2, 0, 1, 2, 0, 1};
+    buf[n++] = 0x00; buf[n++] = TEST_LEDS; buf[n++] = 0;
+    memcpy(&buf[n], f0, TEST_LEDS); n += TEST_LEDS;
+
+    // Frame 1: delta, flips LED 0 to 1 -> [1 1 2 0 1 2 0 1]
+    buf[n++] = PRISM_FLAG_DELTA; buf[n++] = TEST_LEDS; buf[n++] = 0;
+    memset(&buf[n], 0, TEST_LEDS); buf[n] = 1; n += TEST_LEDS;
+
+    // Frame 2: RLE, all LEDs = 2
+    buf[n++] = PRISM_FLAG_RLE; buf[n++] = 2; buf[n++] = 0;
+    buf[n++] = PRISM_RLE_MARK | TEST_LEDS; buf[n++] = 2;
+
+    // Frame 3: RLE delta, XOR 3 on the first four -> [1 1 1 1 2 2 2 2]
+    buf[n++] = PRISM_FLAG_RLE | PRISM_FLAG_DELTA; buf[n++] = 4; buf[n++] = 0;
+    buf[n++] = PRISM_RLE_MARK | 4; buf[n++] = 3;
+    buf[n++] = PRISM_RLE_MARK | 4; buf[n++] = 0;
+    return n;
+}
+
+TEST_CASE("prism_decoder streams raw, delta and RLE frames", "[decoder]")
+{
+    uint8_t payload[96];
+    size_t len = build_payload(payload);
+
+    prism_decoder_t dec;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_init(&dec, payload, len, 4, TEST_LEDS));
+    TEST_ASSERT_EQUAL_UINT16(3, dec.palette_count);
+
+    static const uint8_t expect[4][TEST_LEDS] = {
+        {0, 1, 2, 0, 1, 2, 0, 1},
+        {1, 1, 2, 0, 1, 2, 0, 1},
+        {2, 2, 2, 2, 2, 2, 2, 2},
+        {1, 1, 1, 1, 2, 2, 2, 2},
+    };
+
+    // Two passes to cover wrap-around back to frame 0
+    for (int pass = 0; pass < 2; ++pass) {
+        for (uint32_t f = 0; f < 4; ++f) {
+            TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_next(&dec));
+            TEST_ASSERT_EQUAL_UINT32(f, dec.frame_index);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(expect[f], dec.indices, TEST_LEDS);
+        }
+    }
+
+    // Palette is expanded in GRB wire order
+    uint8_t grb[TEST_LEDS * 3];
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_next(&dec));
+    prism_decoder_expand_grb(&dec, grb);
+    TEST_ASSERT_EQUAL_UINT8(0, grb[0]);
+    TEST_ASSERT_EQUAL_UINT8(0, grb[1]);
+    TEST_ASSERT_EQUAL_UINT8(0, grb[3]);
+    TEST_ASSERT_EQUAL_UINT8(255, grb[4]);  // red lands in the R slot
+    TEST_ASSERT_EQUAL_UINT8(255, grb[6]);  // green lands in the G slot
+}
+
+TEST_CASE("prism_decoder rejects malformed payloads", "[decoder]")
+{
+    uint8_t payload[96];
+    size_t len = build_payload(payload);
+    prism_decoder_t dec;
+
+    // Truncated frame data surfaces as an error and rewinds
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_init(&dec, payload, 20, 4, TEST_LEDS));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, prism_decoder_next(&dec));
+    TEST_ASSERT_FALSE(dec.frame_valid);
+
+    // Palette index out of range in frame 0 (its LED data starts at offset 14)
+    payload[14 + 1] = 5;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_init(&dec, payload, len, 4, TEST_LEDS));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, prism_decoder_next(&dec));
+
+    // Empty palette and oversize LED counts are refused up front
+    payload[0] = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, prism_decoder_init(&dec, payload, len, 4, TEST_LEDS));
+    payload[0] = 3;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      prism_decoder_init(&dec, payload, len, 4, PRISM_DECODER_MAX_LEDS + 1));
+}
+
+TEST_CASE("prism_decoder seeks via keyframe index", "[decoder]")
+{
+    uint8_t payload[96];
+    size_t len = build_payload(payload);
+    prism_decoder_t dec;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_init(&dec, payload, len, 4, TEST_LEDS));
+
+    // Frames 0 and 2 are non-delta keyframes at payload offsets 11 and 33
+    static const char extra[] =
+        "{\"palette_id\": \"palette-3\", \"seek_index\": {\"interval\": 2, \"offsets\": [11, 33]}}";
+    prism_seek_index_t index;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_seek_index_parse(extra, sizeof(extra) - 1, 4, &index));
+    TEST_ASSERT_EQUAL_UINT32(2, index.interval);
+    TEST_ASSERT_EQUAL_UINT32(2, index.count);
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_set_seek_index(&dec, &index));
+
+    static const uint8_t frame1[TEST_LEDS] = {1, 1, 2, 0, 1, 2, 0, 1};
+    static const uint8_t frame3[TEST_LEDS] = {1, 1, 1, 1, 2, 2, 2, 2};
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_seek(&dec, 3));
+    TEST_ASSERT_EQUAL_UINT32(3, dec.frame_index);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame3, dec.indices, TEST_LEDS);
+
+    // Backwards seek lands on keyframe 0 and replays one delta
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_seek(&dec, 1));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame1, dec.indices, TEST_LEDS);
+
+    // Playback continues in order after a seek
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_next(&dec));
+    TEST_ASSERT_EQUAL_UINT32(2, dec.frame_index);
+
+    // An index pointing at a delta frame is rejected
+    uint32_t bad_offsets[2] = {11, 22};
+    prism_seek_index_t bad = { .interval = 2, .count = 2, .offsets = bad_offsets };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, prism_decoder_set_seek_index(&dec, &bad));
+    TEST_ASSERT_EQUAL_UINT32(0, dec.seek.interval);
+
+    // Without an index, seeking replays from frame 0
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_seek(&dec, 3));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame3, dec.indices, TEST_LEDS);
+
+    prism_seek_index_free(&index);
+}
+
+TEST_CASE("prism_seek_index_parse handles absent and malformed entries", "[decoder]")
+{
+    prism_seek_index_t index;
+    static const char none[] = "{\"ramp_space\": \"hsluv\"}";
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, prism_seek_index_parse(none, sizeof(none) - 1, 4, &index));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, prism_seek_index_parse(NULL, 0, 4, &index));
+
+    // Offset count must cover every keyframe
+    static const char short_list[] = "{\"seek_index\": {\"interval\": 2, \"offsets\": [11]}}";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      prism_seek_index_parse(short_list, sizeof(short_list) - 1, 4, &index));
+
+    static const char zero_interval[] = "{\"seek_index\": {\"interval\": 0, \"offsets\": []}}";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      prism_seek_index_parse(zero_interval, sizeof(zero_interval) - 1, 4, &index));
+
+    // A header frame count the extra data cannot hold is rejected before
+    // allocating (interval 1: 0x40000000 * 4 bytes wraps a 32-bit size_t)
+    static const char huge[] = "{\"seek_index\": {\"interval\": 1, \"offsets\": [0]}}";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      prism_seek_index_parse(huge, sizeof(huge) - 1, 0x40000000u, &index));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      prism_seek_index_parse(huge, sizeof(huge) - 1, UINT32_MAX, &index));
+}
+
+TEST_CASE("prism_decoder expands through an adjusted palette into both channels", "[decoder]")
+{
+    uint8_t payload[96];
+    size_t len = build_payload(payload);
+    prism_decoder_t dec;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_init(&dec, payload, len, 4, TEST_LEDS));
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_next(&dec));
+
+    // Halve the palette as an effect pass would, then expand
+    uint8_t palette_fx[PRISM_DECODER_MAX_PALETTE * 3];
+    for (int i = 0; i < dec.palette_count * 3; ++i) {
+        palette_fx[i] = dec.palette_grb[i] >> 1;
+    }
+    uint8_t ch1[TEST_LEDS * 3];
+    uint8_t ch2[TEST_LEDS * 3];
+    prism_decoder_expand_palette(&dec, palette_fx, ch1, ch2);
+
+    uint8_t ref[TEST_LEDS * 3];
+    prism_decoder_expand_grb(&dec, ref);
+    for (int i = 0; i < TEST_LEDS * 3; ++i) {
+        TEST_ASSERT_EQUAL_UINT8(ref[i] >> 1, ch1[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ch1, ch2, sizeof(ch1));
+}
+
+TEST_CASE("prism_decoder crossfades two decoders with fixed-point weights", "[decoder]")
+{
+    uint8_t payload[96];
+    size_t len = build_payload(payload);
+    prism_decoder_t from, to;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_init(&from, payload, len, 4, TEST_LEDS));
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_init(&to, payload, len, 4, TEST_LEDS));
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_next(&from));      // [0 1 2 0 1 2 0 1]
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_seek(&to, 2));     // all green
+
+    uint8_t ch1[TEST_LEDS * 3];
+    uint8_t ch2[TEST_LEDS * 3];
+    uint8_t ref[TEST_LEDS * 3];
+
+    // Endpoints reproduce each source exactly
+    prism_decoder_expand_blend(&from, from.palette_grb, &to, to.palette_grb, 0, ch1, NULL);
+    prism_decoder_expand_grb(&from, ref);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref, ch1, sizeof(ch1));
+    prism_decoder_expand_blend(&from, from.palette_grb, &to, to.palette_grb, PRISM_BLEND_ONE, ch1, NULL);
+    prism_decoder_expand_grb(&to, ref);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref, ch1, sizeof(ch1));
+
+    // Midpoint: LED 1 is red -> green, so both G and R land at half
+    prism_decoder_expand_blend(&from, from.palette_grb, &to, to.palette_grb, PRISM_BLEND_ONE / 2, ch1, ch2);
+    TEST_ASSERT_EQUAL_UINT8(127, ch1[3 + 0]);
+    TEST_ASSERT_EQUAL_UINT8(127, ch1[3 + 1]);
+    TEST_ASSERT_EQUAL_UINT8(0, ch1[3 + 2]);
+    // LED 2 is green in both
+    TEST_ASSERT_EQUAL_UINT8(255, ch1[6 + 0]);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ch1, ch2, sizeof(ch1));
+}
+
+TEST_CASE("prism_decoder interpolates between consecutive frames", "[decoder]")
+{
+    uint8_t payload[96];
+    size_t len = build_payload(payload);
+    prism_decoder_t dec;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_init(&dec, payload, len, 4, TEST_LEDS));
+    dec.keep_prev = true;
+
+    // First frame has no predecessor: output is frame 0 at any phase
+    uint8_t out[TEST_LEDS * 3];
+    uint8_t ref[TEST_LEDS * 3];
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_next(&dec));
+    TEST_ASSERT_FALSE(dec.prev_valid);
+    prism_decoder_expand_interp(&dec, dec.palette_grb, 64, out, NULL);
+    prism_decoder_expand_grb(&dec, ref);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ref, out, sizeof(out));
+
+    // Frame 1 flips LED 0 from black to red; a quarter phase is 1/4 red
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_next(&dec));
+    TEST_ASSERT_TRUE(dec.prev_valid);
+    prism_decoder_expand_interp(&dec, dec.palette_grb, PRISM_BLEND_ONE / 4, out, NULL);
+    TEST_ASSERT_EQUAL_UINT8(0, out[0]);
+    TEST_ASSERT_EQUAL_UINT8(63, out[1]);
+    TEST_ASSERT_EQUAL_UINT8(255, out[4]);   // LED 1 red in both frames
+
+    // Wrap from the last frame back to frame 0 keeps the predecessor
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_next(&dec));
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_next(&dec));
+    TEST_ASSERT_EQUAL(ESP_OK, prism_decoder_next(&dec));
+    TEST_ASSERT_EQUAL_UINT32(0, dec.frame_index);
+    TEST_ASSERT_TRUE(dec.prev_valid);
+    prism_decoder_expand_interp(&dec, dec.palette_grb, 0, out, NULL);
+    TEST_ASSERT_EQUAL_UINT8(255, out[1]);   // LED 0 still red from frame 3
+}
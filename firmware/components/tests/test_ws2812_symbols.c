@@ -0,0 +1,190 @@
+/**
+ * @file test_ws2812_symbols.c
+ * @brief Bit-exact checks of the table-driven WS2812B symbol generator
+ */
+
+#include "unity.h"
+#include "ws2812_symbols.h"
+#include "effect_engine.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <string.h>
+#include <stdlib.h>
+
+static const char *TAG = "test_ws2812";
+
+// Reference: what the bytes encoder emits for one byte, built bit by bit
+// from the proven timings (0.4/0.6us, 0.7/0.6us at 10MHz, MSB first)
+static void reference_byte(uint8_t value, uint32_t out[8])
+{
+    for (int bit = 0; bit < 8; ++bit) {
+        bool one = (value >> (7 - bit)) & 1;
+        uint32_t duration0 = one ? 7 : 4;
+        uint32_t duration1 = 6;
+        out[bit] = duration0 | (1u << 15) | (duration1 << 16) | (0u << 31);
+    }
+}
+
+static ws2812_symbol_table_t *table_new(void)
+{
+    const ws2812_timing_t timing = WS2812_TIMING_10MHZ;
+    ws2812_symbol_table_t *table = (ws2812_symbol_table_t *)malloc(sizeof(*table));
+    TEST_ASSERT_NOT_NULL(table);
+    ws2812_symbol_table_build(table, &timing);
+    return table;
+}
+
+TEST_CASE("ws2812 symbol table matches reference timing for every byte", "[ws2812]")
+{
+    ws2812_symbol_table_t *table = table_new();
+    for (int value = 0; value < 256; ++value) {
+        uint32_t expect[8];
+        reference_byte((uint8_t)value, expect);
+        TEST_ASSERT_EQUAL_HEX32_ARRAY(expect, table->symbols[value], 8);
+    }
+
+    const ws2812_timing_t timing = WS2812_TIMING_10MHZ;
+    uint32_t reset = ws2812_reset_symbol(&timing);
+    TEST_ASSERT_EQUAL_UINT32(250, reset & 0x7FFF);
+    TEST_ASSERT_EQUAL_UINT32(0, (reset >> 15) & 1);
+    TEST_ASSERT_EQUAL_UINT32(250, (reset >> 16) & 0x7FFF);
+    TEST_ASSERT_EQUAL_UINT32(0, reset >> 31);
+    free(table);
+}
+
+TEST_CASE("ws2812 chunked encode refills whole bytes only", "[ws2812]")
+{
+    enum { BYTES = 480 };
+    static uint8_t grb[BYTES];
+    static uint32_t stream[BYTES * 8];
+    for (int i = 0; i < BYTES; ++i) {
+        grb[i] = (uint8_t)(i * 37 + 11);
+    }
+    ws2812_symbol_table_t *table = table_new();
+
+    // Free space as the RMT ISR would see it: odd sizes that are not
+    // multiples of 8 must leave the remainder for the next refill
+    static const size_t free_sizes[] = {48, 13, 64, 7, 96, 8};
+    size_t written = 0;
+    size_t pos = 0;
+    for (int call = 0; pos < BYTES; ++call) {
+        size_t room = free_sizes[call % 6];
+        size_t bytes = ws2812_encode_bytes(table, NULL, grb, pos, BYTES, &stream[written], room);
+        TEST_ASSERT_EQUAL(room / 8 < BYTES - pos ? room / 8 : BYTES - pos, bytes);
+        pos += bytes;
+        written += bytes * 8;
+    }
+    TEST_ASSERT_EQUAL(BYTES * 8, written);
+
+    for (int i = 0; i < BYTES; ++i) {
+        uint32_t expect[8];
+        reference_byte(grb[i], expect);
+        TEST_ASSERT_EQUAL_HEX32_ARRAY(expect, &stream[i * 8], 8);
+    }
+    free(table);
+}
+
+TEST_CASE("ws2812 encode-time LUT matches the two-pass effect chain", "[ws2812]")
+{
+    enum { BYTES = 480 };
+    static uint8_t grb[BYTES];
+    static uint8_t two_pass[BYTES];
+    static uint32_t expect[BYTES * 8];
+    static uint32_t stream[BYTES * 8];
+    for (int i = 0; i < BYTES; ++i) {
+        grb[i] = (uint8_t)(i * 53 + 7);
+    }
+    ws2812_symbol_table_t *table = table_new();
+
+    effect_chain_clear();
+    effect_add_gamma(220);
+    effect_add_brightness(180);
+    effect_set_white_balance(200, 255, 150);
+
+    // Before: the chain runs over the frame, then the bytes are encoded
+    memcpy(two_pass, grb, BYTES);
+    effect_chain_apply(two_pass, BYTES / 3);
+    TEST_ASSERT_EQUAL(BYTES, ws2812_encode_bytes(table, NULL, two_pass, 0, BYTES, expect, BYTES * 8));
+
+    // After: raw bytes, the chain applied per component while encoding,
+    // refilled in odd chunks so component phase survives every boundary
+    static ws2812_output_lut_t lut;
+    TEST_ASSERT_TRUE(effect_chain_get_lut(lut.component));
+    static const size_t free_sizes[] = {48, 13, 64, 7, 96, 8};
+    size_t written = 0;
+    size_t pos = 0;
+    for (int call = 0; pos < BYTES; ++call) {
+        size_t bytes = ws2812_encode_bytes(table, &lut, grb, pos, BYTES, &stream[written], free_sizes[call % 6]);
+        pos += bytes;
+        written += bytes * 8;
+    }
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(expect, stream, BYTES * 8);
+
+    // An empty chain is the identity
+    effect_chain_clear();
+    effect_set_white_balance(255, 255, 255);
+    TEST_ASSERT_FALSE(effect_chain_get_lut(lut.component));
+    static ws2812_output_lut_t identity;
+    ws2812_output_lut_identity(&identity);
+    TEST_ASSERT_EQUAL_MEMORY(&identity, &lut, sizeof(lut));
+    free(table);
+}
+
+TEST_CASE("ws2812 table encode bench", "[ws2812][bench]")
+{
+    // One 160-LED channel frame into a 48-symbol RMT block, refill by refill
+    enum { FRAMES = 120, BYTES = 480, BLOCK = 48 };
+    static uint8_t grb[BYTES];
+    uint32_t block[BLOCK];
+    for (int i = 0; i < BYTES; ++i) {
+        grb[i] = (uint8_t)(i * 7);
+    }
+    ws2812_symbol_table_t *table = table_new();
+    const ws2812_timing_t timing = WS2812_TIMING_10MHZ;
+    const uint32_t bit0 = ws2812_bit_symbol(&timing, false);
+    const uint32_t bit1 = ws2812_bit_symbol(&timing, true);
+
+    // Before: per-bit symbol selection, as the bytes encoder does
+    uint32_t before_max = 0;
+    uint64_t before_sum = 0;
+    volatile uint32_t sink = 0;
+    for (int f = 0; f < FRAMES; ++f) {
+        int64_t t0 = esp_timer_get_time();
+        size_t n = 0;
+        for (int i = 0; i < BYTES; ++i) {
+            for (int bit = 7; bit >= 0; --bit) {
+                block[n++] = ((grb[i] >> bit) & 1) ? bit1 : bit0;
+            }
+            if (n == BLOCK) {
+                sink += block[0];
+                n = 0;
+            }
+        }
+        uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+        before_sum += dt;
+        if (dt > before_max) before_max = dt;
+    }
+
+    // After: 8 symbols per byte from the table
+    uint32_t after_max = 0;
+    uint64_t after_sum = 0;
+    for (int f = 0; f < FRAMES; ++f) {
+        int64_t t0 = esp_timer_get_time();
+        size_t pos = 0;
+        while (pos < BYTES) {
+            pos += ws2812_encode_bytes(table, NULL, grb, pos, BYTES, block, BLOCK);
+            sink += block[0];
+        }
+        uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+        after_sum += dt;
+        if (dt > after_max) after_max = dt;
+    }
+    (void)sink;
+    free(table);
+
+    ESP_LOGI(TAG, "{\"bench\":\"ws2812_encode\",\"frames\":%d,\"bytes\":%d,\"before_max_us\":%u,"
+             "\"before_avg_us\":%u,\"after_max_us\":%u,\"after_avg_us\":%u}",
+             FRAMES, BYTES, (unsigned)before_max, (unsigned)(before_sum / FRAMES),
+             (unsigned)after_max, (unsigned)(after_sum / FRAMES));
+    TEST_ASSERT_TRUE(after_sum <= before_sum);
+}
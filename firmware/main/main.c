@@ -35,12 +35,14 @@ static const char *TAG = "PRISM-K1";
 #define PRIORITY_PLAYBACK   10  /* HIGHEST - Real-time LED output */
 #define PRIORITY_NETWORK    5   /* Medium - WiFi & WebSocket */
 #define PRIORITY_STORAGE    4   /* Medium-low - File operations */
+#define PRIORITY_LOADER     4   /* Medium-low - Pattern load/decode prep */
 #define PRIORITY_TEMPLATES  3   /* Low - Template generation */
 
 /* Task stack sizes (KB) */
 #define STACK_PLAYBACK      (8 * 1024)  /* 8KB - Frame generation */
 #define STACK_NETWORK       (8 * 1024)  /* 8KB - Network stack */
 #define STACK_STORAGE       (6 * 1024)  /* 6KB - File operations */
+#define STACK_LOADER        (6 * 1024)  /* 6KB - Pattern load/decode prep */
 #define STACK_TEMPLATES     (6 * 1024)  /* 6KB - Template work */
 
 /**
@@ -182,6 +184,10 @@ void app_main(void)
     xTaskCreatePinnedToCore(playback_task, "playback", STACK_PLAYBACK,
                             NULL, PRIORITY_PLAYBACK, NULL, 0);
 
+    /* Pattern loader - Medium-low priority (Core 1, Priority 4) */
+    xTaskCreatePinnedToCore(playback_loader_task, "pb_loader", STACK_LOADER,
+                            NULL, PRIORITY_LOADER, NULL, 1);
+
     /* Network task - Medium priority (Core 1, Priority 5) */
     xTaskCreatePinnedToCore(network_task, "network", STACK_NETWORK,
                             NULL, PRIORITY_NETWORK, NULL, 1);
@@ -0,0 +1,4 @@
+// Host stand-in for the ESP-IDF header: no memory placement on the host
+#pragma once
+#define IRAM_ATTR
+#define DRAM_ATTR
@@ -0,0 +1,11 @@
+// Host stand-in for the ESP-IDF header
+#pragma once
+#include "esp_err.h"
+#include "esp_log.h"
+
+#define ESP_RETURN_ON_FALSE(a, err_code, log_tag, fmt, ...) do { \
+        if (!(a)) {                                               \
+            ESP_LOGE(log_tag, fmt, ##__VA_ARGS__);                \
+            return err_code;                                      \
+        }                                                         \
+    } while (0)
@@ -0,0 +1,21 @@
+// Host stand-in for the ESP-IDF header. Counts TSC ticks on x86 and
+// nanoseconds elsewhere: compare host runs with each other, not with the
+// ESP32-S3 budgets.
+#pragma once
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint32_t esp_cpu_get_cycle_count(void)
+{
+    return (uint32_t)__rdtsc();
+}
+#else
+#include <time.h>
+static inline uint32_t esp_cpu_get_cycle_count(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+}
+#endif
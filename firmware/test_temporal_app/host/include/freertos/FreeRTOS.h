@@ -0,0 +1,2 @@
+// Host stand-in: led_driver.h only needs the task handle type
+#pragma once
@@ -0,0 +1,3 @@
+// Host stand-in: led_driver.h only needs the task handle type
+#pragma once
+typedef void *TaskHandle_t;
@@ -0,0 +1,2 @@
+// Host stand-in for the generated header: Kconfig defaults
+#pragma once
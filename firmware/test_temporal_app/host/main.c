@@ -0,0 +1,12 @@
+// Host runner for bench_temporal: JSON lines on stdout, exit 1 if any
+// combination's p99 is over budget (pass --report to only report)
+#include "bench_temporal.h"
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char **argv)
+{
+    const bool report_only = (argc > 1 && strcmp(argv[1], "--report") == 0);
+    const uint32_t failures = bench_temporal_run_all();
+    return (failures && !report_only) ? 1 : 0;
+}
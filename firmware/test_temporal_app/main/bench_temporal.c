@@ -0,0 +1,118 @@
+/**
+ * @file bench_temporal.c
+ * @brief Cycle benchmark for calculate_ch2_frame() across sync modes and motions
+ */
+
+#include "bench_temporal.h"
+#include "bench_temporal_budgets.h"
+#include "prism_temporal_api.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "bench_temporal";
+
+static prism_temporal_ctx_t s_ctx;
+static uint16_t s_ch1[BENCH_TEMPORAL_LED_COUNT];
+static uint16_t s_ch2[BENCH_TEMPORAL_LED_COUNT];
+static uint16_t s_custom_table[BENCH_TEMPORAL_LED_COUNT];
+static uint32_t s_cycles[BENCH_TEMPORAL_FRAMES];
+
+static const char *const s_mode_names[PRISM_SYNC_COUNT] = {
+    "sync", "offset", "progressive", "wave", "custom",
+};
+static const char *const s_motion_names[PRISM_MOTION_COUNT] = {
+    "left", "right", "center", "edge", "static",
+};
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t ua = *(const uint32_t *)a;
+    uint32_t ub = *(const uint32_t *)b;
+    if (ua < ub) {
+        return -1;
+    }
+    if (ua > ub) {
+        return 1;
+    }
+    return 0;
+}
+
+// Parameters chosen so every LED crosses its delay during the run
+static void bench_setup(prism_sync_mode_t mode, prism_motion_t motion)
+{
+    prism_motion_init(&s_ctx, s_ch1, s_ch2, BENCH_TEMPORAL_LED_COUNT);
+    s_ctx.sync_mode = mode;
+    s_ctx.motion_direction = motion;
+    s_ctx.params.delay_ms = 300;
+    s_ctx.params.progressive_start_ms = 0;
+    s_ctx.params.progressive_end_ms = 1500;
+    s_ctx.params.wave_amplitude_ms = 200;
+    s_ctx.params.wave_frequency_hz = 2;     // Animated: the costlier WAVE path
+    s_ctx.params.wave_phase_deg = 90;
+    for (uint32_t i = 0; i < BENCH_TEMPORAL_LED_COUNT; ++i) {
+        s_ch1[i] = (uint16_t)(i * 409u);
+        s_custom_table[i] = (uint16_t)((i * 37u) % 2000u);
+    }
+    s_ctx.delay_table = (mode == PRISM_SYNC_CUSTOM) ? s_custom_table : NULL;
+    prism_temporal_compile(&s_ctx, BENCH_TEMPORAL_LED_COUNT);
+}
+
+bool bench_temporal_run_one(prism_sync_mode_t mode, prism_motion_t motion,
+                            bench_temporal_result_t *result)
+{
+    bench_setup(mode, motion);
+
+    uint64_t sum_cycles = 0;
+    for (uint32_t f = 0; f < BENCH_TEMPORAL_FRAMES; ++f) {
+        s_ctx.frame_index = f;
+        s_ctx.frame_time_ms = (f * 1000u) / 120u;   // CUSTOM runs on wall time
+        uint32_t start = esp_cpu_get_cycle_count();
+        calculate_ch2_frame(&s_ctx, s_ch1, s_ch2, BENCH_TEMPORAL_LED_COUNT);
+        s_cycles[f] = esp_cpu_get_cycle_count() - start;
+        sum_cycles += s_cycles[f];
+    }
+    qsort(s_cycles, BENCH_TEMPORAL_FRAMES, sizeof(uint32_t), cmp_u32);
+
+    const uint32_t n = BENCH_TEMPORAL_FRAMES;
+    bench_temporal_result_t r = {
+        .mode = mode,
+        .motion = motion,
+        .avg_cycles = (uint32_t)(sum_cycles / n),
+        .p99_cycles = s_cycles[n * 99 / 100],
+        .max_cycles = s_cycles[n - 1],
+        .budget_p99_cycles = bench_temporal_budget_p99_cycles[mode],
+    };
+    const bool pass = r.p99_cycles <= r.budget_p99_cycles;
+
+    // JSON to UART (line-delimited)
+    ESP_LOGI(TAG,
+             "{\"bench\":\"temporal\",\"mode\":\"%s\",\"motion\":\"%s\",\"frames\":%u,\"leds\":%u,"
+             "\"avg_cycles\":%u,\"p99_cycles\":%u,\"max_cycles\":%u,\"budget_p99_cycles\":%u,\"pass\":%s}",
+             s_mode_names[mode], s_motion_names[motion], (unsigned)n,
+             (unsigned)BENCH_TEMPORAL_LED_COUNT, (unsigned)r.avg_cycles, (unsigned)r.p99_cycles,
+             (unsigned)r.max_cycles, (unsigned)r.budget_p99_cycles, pass ? "true" : "false");
+
+    if (result) {
+        *result = r;
+    }
+    return pass;
+}
+
+uint32_t bench_temporal_run_all(void)
+{
+    uint32_t failures = 0;
+    for (int mode = 0; mode < PRISM_SYNC_COUNT; ++mode) {
+        for (int motion = 0; motion < PRISM_MOTION_COUNT; ++motion) {
+            if (!bench_temporal_run_one((prism_sync_mode_t)mode, (prism_motion_t)motion, NULL)) {
+                failures++;
+            }
+        }
+    }
+    if (failures) {
+        ESP_LOGW(TAG, "%u of %u combinations over their p99 budget", (unsigned)failures,
+                 (unsigned)(PRISM_SYNC_COUNT * PRISM_MOTION_COUNT));
+    }
+    return failures;
+}
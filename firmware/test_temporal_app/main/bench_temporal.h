@@ -0,0 +1,51 @@
+/**
+ * @file bench_temporal.h
+ * @brief Cycle benchmark for calculate_ch2_frame() across sync modes and motions
+ *
+ * Builds into test_temporal_app on the ESP32-S3 and into a host binary
+ * (see ../host/Makefile) for quick before/after comparisons.
+ */
+
+#ifndef PRISM_BENCH_TEMPORAL_H
+#define PRISM_BENCH_TEMPORAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "prism_motion.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BENCH_TEMPORAL_FRAMES     480   // 4 s at 120 FPS: every delay ramps in
+#define BENCH_TEMPORAL_LED_COUNT  160
+
+typedef struct {
+    prism_sync_mode_t mode;
+    prism_motion_t motion;
+    uint32_t avg_cycles;
+    uint32_t p99_cycles;
+    uint32_t max_cycles;
+    uint32_t budget_p99_cycles;
+} bench_temporal_result_t;
+
+/**
+ * @brief Time one sync mode x motion combination
+ *
+ * Emits one JSON line (same shape as bench_decode) and fills result.
+ * @return true if p99 is within the mode's budget
+ */
+bool bench_temporal_run_one(prism_sync_mode_t mode, prism_motion_t motion,
+                            bench_temporal_result_t *result);
+
+/**
+ * @brief Time every sync mode x motion combination
+ * @return Number of combinations over budget (0 = pass)
+ */
+uint32_t bench_temporal_run_all(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PRISM_BENCH_TEMPORAL_H
@@ -0,0 +1,24 @@
+/**
+ * @file bench_temporal_budgets.h
+ * @brief Checked-in p99 budgets for bench_temporal (ESP32-S3 cycles per frame)
+ *
+ * One budget per sync mode, shared by every motion direction. Sized for
+ * 160 LEDs at 240MHz with roughly 2x headroom; adjust a budget only with the
+ * JSON lines from a run that justifies it.
+ */
+
+#ifndef PRISM_BENCH_TEMPORAL_BUDGETS_H
+#define PRISM_BENCH_TEMPORAL_BUDGETS_H
+
+#include <stdint.h>
+#include "prism_motion.h"
+
+static const uint32_t bench_temporal_budget_p99_cycles[PRISM_SYNC_COUNT] = {
+    [PRISM_SYNC_SYNC]        = 2000,    // Whole-strip memcpy
+    [PRISM_SYNC_OFFSET]      = 3000,    // memcpy or memset once the map is uniform
+    [PRISM_SYNC_PROGRESSIVE] = 4000,    // Branch-free select per LED
+    [PRISM_SYNC_WAVE]        = 8000,    // Animated: sin8_table per LED, then select
+    [PRISM_SYNC_CUSTOM]      = 4000,
+};
+
+#endif // PRISM_BENCH_TEMPORAL_BUDGETS_H
@@ -1,7 +1,10 @@
 #include "unity.h"
 #include "prism_temporal_api.h"
+#include "bench_temporal.h"
 #include <string.h>
 #include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
 
 #define LED_COUNT 160
 
@@ -73,3 +76,38 @@ TEST_CASE("CUSTOM per-LED delay applies", "[temporal][custom]") {
     }
 }
 
+
+// Average cycles per frame for calculate_ch2_frame over one second of frames
+static uint32_t wave_cycles_per_frame(uint16_t frequency_hz)
+{
+    const uint32_t frames = 120;
+    prism_motion_init(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    ctx.sync_mode = PRISM_SYNC_WAVE;
+    ctx.motion_direction = PRISM_MOTION_CENTER;
+    ctx.params.delay_ms = 300;
+    ctx.params.wave_amplitude_ms = 200;
+    ctx.params.wave_frequency_hz = frequency_hz;
+    ctx.params.wave_phase_deg = 90;
+    TEST_ASSERT_EQUAL(ESP_OK, prism_temporal_compile(&ctx, LED_COUNT));
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (uint32_t f = 1; f <= frames; f++) {
+        ctx.frame_index = f;
+        calculate_ch2_frame(&ctx, ch1_frame, ch2_frame, LED_COUNT);
+    }
+    return (esp_cpu_get_cycle_count() - start) / frames;
+}
+
+TEST_CASE("WAVE animation cost per frame", "[temporal][wave][bench]") {
+    const uint32_t static_cycles = wave_cycles_per_frame(0);
+    const uint32_t animated_cycles = wave_cycles_per_frame(2);
+    ESP_LOGI("bench", "{\"bench\":\"wave\",\"leds\":%d,\"static_cycles\":%lu,\"animated_cycles\":%lu}",
+             LED_COUNT, (unsigned long)static_cycles, (unsigned long)animated_cycles);
+    // Animation is one sin8_table lookup per LED on top of the gather
+    TEST_ASSERT_LESS_THAN(static_cycles * 2 + 4000, animated_cycles);
+    TEST_ASSERT_LESS_THAN(24000, animated_cycles);  // 100us at 240MHz: 1.2% of a frame
+}
+
+TEST_CASE("Every sync mode and motion stays within its p99 cycle budget", "[temporal][bench]") {
+    TEST_ASSERT_EQUAL_UINT32(0, bench_temporal_run_all());
+}
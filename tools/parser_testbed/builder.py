@@ -22,7 +22,7 @@ META_SIZE = META_STRUCT.size  # 16 bytes
 CRC_PREFIX_SIZE = struct.calcsize("<4sHHIIBBH")  # bytes prior to crc32 field
 META_CRC_PREFIX = 6  # first 6 bytes of metadata are covered by CRC
 
-OPTIONAL_METADATA_FIELDS = frozenset({"palette_id", "ramp_space", "show_params"})
+OPTIONAL_METADATA_FIELDS = frozenset({"palette_id", "ramp_space", "seek_index", "show_params"})
 VALID_RAMP_SPACES = frozenset({"hsv", "hsl", "hsluv", "oklab", "oklch"})
 
 
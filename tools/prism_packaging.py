@@ -34,6 +34,10 @@ FLAG_RLE = 0x02
 RLE_MARK = 0x80  # top bit indicates run-length entry
 MAX_RLE_LEN = 0x7F
 
+# Every Nth frame is written without XOR delta and its payload offset is
+# recorded in the header "seek_index" so firmware can seek in bounded time.
+DEFAULT_KEYFRAME_INTERVAL = 120
+
 
 @dataclass
 class PrismMeta:
@@ -223,10 +227,14 @@ def rle_decode(data: Sequence[int]) -> List[int]:
     return decoded
 
 
-def encode_frame(indices: List[int], prev_indices: Optional[List[int]]) -> Tuple[bytes, bool, bool, List[int]]:
+def encode_frame(
+    indices: List[int],
+    prev_indices: Optional[List[int]],
+    keyframe: bool = False,
+) -> Tuple[bytes, bool, bool, List[int]]:
     use_delta = False
     baseline = indices
-    if prev_indices is not None:
+    if prev_indices is not None and not keyframe:
         delta = xor_delta(indices, prev_indices)
         zero_ratio = delta.count(0) / len(delta)
         if zero_ratio >= 0.4:
@@ -247,7 +255,13 @@ def encode_frame(indices: List[int], prev_indices: Optional[List[int]]) -> Tuple
     return header + bytes(payload), use_delta, use_rle, baseline
 
 
-def encode_frameset(frames: Sequence[Sequence[Sequence[int]]], palette: Sequence[Tuple[int, int, int]]) -> Tuple[bytes, Dict[str, object]]:
+def encode_frameset(
+    frames: Sequence[Sequence[Sequence[int]]],
+    palette: Sequence[Tuple[int, int, int]],
+    keyframe_interval: int = DEFAULT_KEYFRAME_INTERVAL,
+) -> Tuple[bytes, Dict[str, object]]:
+    if keyframe_interval < 0:
+        raise ValueError("keyframe_interval must be >= 0")
     palette_map = {colour: idx for idx, colour in enumerate(palette)}
     stats: Dict[str, object] = {
         "raw_bytes": len(frames) * len(frames[0]) * 3,
@@ -259,7 +273,8 @@ def encode_frameset(frames: Sequence[Sequence[Sequence[int]]], palette: Sequence
     encoded_frames: List[bytes] = []
     for frame_index, frame in enumerate(frames):
         indices = indices_for_frame(frame, palette_map)
-        blob, used_delta, used_rle, baseline = encode_frame(indices, prev_indices)
+        keyframe = keyframe_interval > 0 and frame_index % keyframe_interval == 0
+        blob, used_delta, used_rle, baseline = encode_frame(indices, prev_indices, keyframe)
         encoded_frames.append(blob)
         stats["frames"].append(
             {
@@ -278,10 +293,15 @@ def encode_frameset(frames: Sequence[Sequence[Sequence[int]]], palette: Sequence
     for colour in palette:
         payload.extend(colour)
     total_bytes = 2 + len(palette) * 3
-    for blob in encoded_frames:
+    keyframe_offsets: List[int] = []
+    for frame_index, blob in enumerate(encoded_frames):
+        if keyframe_interval > 0 and frame_index % keyframe_interval == 0:
+            keyframe_offsets.append(len(payload))
         payload.extend(blob)
         total_bytes += len(blob)
 
+    if keyframe_interval > 0:
+        stats["seek_index"] = {"interval": keyframe_interval, "offsets": keyframe_offsets}
     stats["payload_bytes"] = total_bytes
     stats["encode_ms"] = encode_duration * 1000.0
     stats["compression_ratio"] = stats["raw_bytes"] / total_bytes if total_bytes else float("inf")
@@ -321,7 +341,39 @@ def decode_payload(payload: bytes, led_count: int) -> List[List[Tuple[int, int,
     return frames
 
 
-def build_header(meta: PrismMeta, palette_size: int) -> Tuple[bytes, Dict[str, object]]:
+def decode_frame_at(
+    payload: bytes,
+    led_count: int,
+    seek_index: Dict[str, object],
+    frame_index: int,
+) -> List[int]:
+    """Decode one frame's palette indices starting from its nearest keyframe."""
+    interval = int(seek_index["interval"])  # type: ignore[arg-type]
+    offsets = seek_index["offsets"]  # type: ignore[assignment]
+    offset = offsets[frame_index // interval]  # type: ignore[index]
+    indices: Optional[List[int]] = None
+    for _ in range(frame_index % interval + 1):
+        flags, length = FRAME_HEADER_STRUCT.unpack_from(payload, offset)
+        offset += FRAME_HEADER_STRUCT.size
+        segment = list(payload[offset : offset + length])
+        offset += length
+        if flags & FLAG_RLE:
+            segment = rle_decode(segment)
+        if flags & FLAG_DELTA:
+            if indices is None:
+                raise ValueError("Seek index points at a delta frame")
+            segment = [value ^ prev for value, prev in zip(segment, indices)]
+        indices = segment
+    if indices is None or len(indices) != led_count:
+        raise ValueError("Decoded length mismatch")
+    return indices
+
+
+def build_header(
+    meta: PrismMeta,
+    palette_size: int,
+    seek_index: Optional[Dict[str, object]] = None,
+) -> Tuple[bytes, Dict[str, object]]:
     header = PrismHeaderV10(
         version=VERSION,
         led_count=meta.led_count,
@@ -337,15 +389,21 @@ def build_header(meta: PrismMeta, palette_size: int) -> Tuple[bytes, Dict[str, o
         "ramp_space": meta.ramp_space,
         "palette_id": palette_id,
     }
+    if seek_index is not None:
+        extra_fields["seek_index"] = seek_index
     blob, manifest = build_header_blob(header, pattern_meta, extra_fields=extra_fields)
     return blob, manifest
 
 
-def package(meta: PrismMeta, frames: List[List[List[int]]]) -> Tuple[bytes, Dict[str, object]]:
+def package(
+    meta: PrismMeta,
+    frames: List[List[List[int]]],
+    keyframe_interval: int = DEFAULT_KEYFRAME_INTERVAL,
+) -> Tuple[bytes, Dict[str, object]]:
     palette, frames_quantised, quant_stats = build_palette_and_remap(frames)
-    payload, stats = encode_frameset(frames_quantised, palette)
+    payload, stats = encode_frameset(frames_quantised, palette, keyframe_interval)
 
-    header_blob, header_manifest = build_header(meta, len(palette))
+    header_blob, header_manifest = build_header(meta, len(palette), stats.get("seek_index"))  # type: ignore[arg-type]
     payload_crc = zlib.crc32(payload) & 0xFFFFFFFF
     file_blob = header_blob + payload + struct.pack("<I", payload_crc)
 
@@ -381,9 +439,14 @@ def package(meta: PrismMeta, frames: List[List[List[int]]]) -> Tuple[bytes, Dict
     return file_blob, stats
 
 
-def write_package(input_path: Path, output_path: Path, report_path: Optional[Path]) -> Dict[str, object]:
+def write_package(
+    input_path: Path,
+    output_path: Path,
+    report_path: Optional[Path],
+    keyframe_interval: int = DEFAULT_KEYFRAME_INTERVAL,
+) -> Dict[str, object]:
     meta, frames = load_payload(input_path)
-    blob, stats = package(meta, frames)
+    blob, stats = package(meta, frames, keyframe_interval)
     output_path.parent.mkdir(parents=True, exist_ok=True)
     output_path.write_bytes(blob)
     if report_path:
@@ -397,12 +460,23 @@ def parse_args(argv: Sequence[str] | None = None) -> argparse.Namespace:
     parser.add_argument("--input", required=True, help="Input JSON frames file")
     parser.add_argument("--output", required=True, help="Output .prism path")
     parser.add_argument("--report", help="Optional JSON report path")
+    parser.add_argument(
+        "--keyframe-interval",
+        type=int,
+        default=DEFAULT_KEYFRAME_INTERVAL,
+        help=f"Frames between non-delta keyframes recorded in the seek index (0 disables, default {DEFAULT_KEYFRAME_INTERVAL})",
+    )
     return parser.parse_args(argv)
 
 
 def main(argv: Sequence[str] | None = None) -> None:
     args = parse_args(argv)
-    stats = write_package(Path(args.input), Path(args.output), Path(args.report) if args.report else None)
+    stats = write_package(
+        Path(args.input),
+        Path(args.output),
+        Path(args.report) if args.report else None,
+        args.keyframe_interval,
+    )
     print(json.dumps(stats, indent=2))
 
 
@@ -82,6 +82,53 @@ class PrismPackagingTests(unittest.TestCase):
         self.assertTrue(any(frame_stat["rle"] for frame_stat in stats["frames"]))
         self.assertTrue(any(frame_stat["delta"] for frame_stat in stats["frames"]))
 
+    def test_keyframe_seek_index(self) -> None:
+        with tempfile.TemporaryDirectory() as tmpdir:
+            tmp = Path(tmpdir)
+            # Mostly static frames so every non-keyframe picks XOR delta
+            frames = [
+                [[0, 0, 0]] * 12 + [[255, 255, 255]] * (f % 4)
+                + [[0, 0, 0]] * (4 - f % 4)
+                for f in range(10)
+            ]
+            payload = {"meta": {"fps": 24}, "data": {"frames": frames}}
+            json_path = tmp / "frames.json"
+            json_path.write_text(json.dumps(payload), encoding="utf-8")
+            out_path = tmp / "seek.prism"
+            stats = prism_packaging.write_package(json_path, out_path, None, keyframe_interval=4)
+            content = out_path.read_bytes()
+
+        seek_index = stats["seek_index"]
+        self.assertEqual(seek_index["interval"], 4)
+        self.assertEqual(len(seek_index["offsets"]), 3)
+        self.assertTrue(any(frame_stat["delta"] for frame_stat in stats["frames"]))
+        for frame_stat in stats["frames"]:
+            if frame_stat["index"] % 4 == 0:
+                self.assertFalse(frame_stat["delta"])
+
+        header_blob = self._slice_header(content)
+        parsed = builder.parse_header_blob(header_blob)
+        self.assertEqual(parsed.extra_fields.get("seek_index"), seek_index)
+
+        payload_bytes = content[len(header_blob) : -4]
+        full = prism_packaging.decode_payload(payload_bytes, 16)
+        palette = [tuple(payload_bytes[2 + i * 3 : 5 + i * 3]) for i in range(payload_bytes[0])]
+        for frame_index in range(10):
+            indices = prism_packaging.decode_frame_at(payload_bytes, 16, seek_index, frame_index)
+            self.assertEqual([palette[i] for i in indices], full[frame_index])
+
+    def test_keyframe_interval_zero_omits_index(self) -> None:
+        with tempfile.TemporaryDirectory() as tmpdir:
+            tmp = Path(tmpdir)
+            json_path = self.create_payload(tmp, led_count=4, frames=3)
+            out_path = tmp / "noindex.prism"
+            stats = prism_packaging.write_package(json_path, out_path, None, keyframe_interval=0)
+            content = out_path.read_bytes()
+
+        self.assertNotIn("seek_index", stats)
+        parsed = builder.parse_header_blob(self._slice_header(content))
+        self.assertNotIn("seek_index", parsed.extra_fields)
+
     def test_validation_rejects_large_palette(self) -> None:
         with tempfile.TemporaryDirectory() as tmpdir:
             tmp = Path(tmpdir)